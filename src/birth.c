@@ -22,6 +22,7 @@
 #include "game-event.h"
 #include "game-cmd.h"
 #include "history.h"
+#include "monster/mon-make.h"
 #include "object/inventory.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
@@ -459,6 +460,9 @@ void player_init(struct player *p)
 	if (z_info)
 		r_info[z_info->r_max-1].max_num = 0;
 
+	/* Every unique is available again */
+	get_mon_num_invalidate();
+
 
 	/* Always start with a well fed player (this is surely in the wrong fn) */
 	p->food = PY_FOOD_FULL - 1;
@@ -4908,9 +4908,9 @@ void borg_write_map(bool ask)
    file_putf(borg_map_file, "Killed on level: %d (max. %d) by %s\n\n", p_ptr->depth, p_ptr->max_depth, p_ptr->died_from);
    file_putf(borg_map_file, "Borg Compile Date: %s\n", borg_engine_date);
 
-    for (i = 0; i < DUNGEON_HGT; i++)
+    for (i = 0; i < cave->height; i++)
     {
-        for (j = 0; j < DUNGEON_WID; j++)
+        for (j = 0; j < cave->width; j++)
         {
             char ch;
 
@@ -5236,9 +5236,9 @@ void borg_write_map(bool ask)
     }
 
     /* Check the dungeon */
-    for (y = 0; y < DUNGEON_HGT; y++)
+    for (y = 0; y < cave->height; y++)
     {
-        for (x = 0; x < DUNGEON_WID; x++)
+        for (x = 0; x < cave->width; x++)
         {
             s16b this_o_idx, next_o_idx = 0;
 
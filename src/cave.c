@@ -20,14 +20,13 @@
 #include "cave.h"
 #include "game-event.h"
 #include "game-cmd.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-spatial.h"
 #include "monster/mon-util.h"
 #include "object/tvalsval.h"
 #include "squelch.h"
 #include "cmds.h"
 
-static int view_n;
-static u16b view_g[VIEW_MAX];
-
 /*
  * Approximate distance between two points.
  *
@@ -605,8 +604,8 @@ void grid_data_as_text(grid_data *g, byte *ap, wchar_t *cp, byte *tap, wchar_t *
 			}
 			
 			/* Normal monster (not "clear" in any way) */
-			else if (!flags_test(r_ptr->flags, RF_SIZE,
-				RF_ATTR_CLEAR, RF_CHAR_CLEAR, FLAG_END))
+			else if (!rf_has(r_ptr->flags, RF_ATTR_CLEAR) &&
+				!rf_has(r_ptr->flags, RF_CHAR_CLEAR))
 			{
 				/* Use attr */
 				a = da;
@@ -767,8 +766,8 @@ void map_info(unsigned y, unsigned x, grid_data *g)
 	object_type *o_ptr;
 	byte info;
 
-	assert(x < DUNGEON_WID);
-	assert(y < DUNGEON_HGT);
+	assert(x < (unsigned)cave->width);
+	assert(y < (unsigned)cave->height);
 
 	info = cave->info[y][x];
 	
@@ -1259,8 +1258,8 @@ void display_map(int *cy, int *cx)
 	map_hgt = Term->hgt - 2;
 	map_wid = Term->wid - 2;
 
-	dungeon_hgt = (p_ptr->depth == 0) ? TOWN_HGT : DUNGEON_HGT;
-	dungeon_wid = (p_ptr->depth == 0) ? TOWN_WID : DUNGEON_WID;
+	dungeon_hgt = cave->height;
+	dungeon_wid = cave->width;
 
 	/* Prevent accidents */
 	if (map_hgt > dungeon_hgt) map_hgt = dungeon_hgt;
@@ -1586,21 +1585,22 @@ void do_cmd_view_map(void)
  * farming, etc), there is no need to call the "update_view()" function, so
  * even if it was not very efficient, this would really only matter when the
  * player was "running" through the dungeon.  It sets the "CAVE_VIEW" flag
- * on every cave grid in the player's field of view, and maintains an array
- * of all such grids in the global "view_g" array.  It also checks the torch
+ * on every cave grid in the player's field of view, and remembers all such
+ * grids in the per-octant "view_oct_g" arrays.  It also checks the torch
  * radius of the player, and sets the "CAVE_SEEN" flag for every grid which
  * is in the "field of view" of the player and which is also "illuminated",
  * either by the players torch (if any) or by any permanent light source.
  * It could use and help maintain information about multiple light sources,
  * which would be helpful in a multi-player version of Angband.
  *
- * The "update_view()" function maintains the special "view_g" array, which
- * contains exactly those grids which have the "CAVE_VIEW" flag set.  This
- * array is used by "update_view()" to (only) memorize grids which become
- * newly "seen", and to (only) redraw grids whose "seen" value changes, which
- * allows the use of some interesting (and very efficient) "special lighting
- * effects".  In addition, this array could be used elsewhere to quickly scan
- * through all the grids which are in the player's field of view.
+ * The "update_view()" function maintains the special "view_oct_g" arrays,
+ * which together contain exactly those grids which have the "CAVE_VIEW" flag
+ * set (along with the player grid and any grids lit by monsters).  These
+ * arrays are used by "update_view()" to find the grids whose flags may have
+ * changed, so that it can (only) memorize grids which become newly "seen",
+ * and (only) redraw grids whose "seen" value changes, which allows the use
+ * of some interesting (and very efficient) "special lighting effects".  The
+ * grids which changed are left in a list, available from "view_delta()".
  *
  * Note that the "update_view()" function allows, among other things, a room
  * to be "partially" seen as the player approaches it, with a growing cone
@@ -2236,206 +2236,249 @@ errr vinfo_init(void)
 
 
 
+/*
+ * Which parts of the field of view currently mark each grid as viewable.
+ *
+ * Bits 0-7 are set by the eight octants scanned in "update_view()", the
+ * next two by monster light and by the player grid itself.  A grid has the
+ * "CAVE_VIEW" flag exactly when one of these bits is set, which is what
+ * lets "update_view()" rescan a single octant without losing the grids it
+ * shares with its neighbours.  The "queued" bit is temporary, and marks
+ * grids already waiting in "view_dirty_g" for their flags to be rebuilt.
+ */
+#define VIEW_SRC_OCTANTS	0x00FF
+#define VIEW_SRC_MONSTER	0x0100
+#define VIEW_SRC_PLAYER		0x0200
+#define VIEW_SRC_ALL		0x03FF
+#define VIEW_SRC_QUEUED		0x0400
+
+static u16b view_src[DUNGEON_HGT * 256];
+
+/*
+ * The grids each octant found viewable during its last scan
+ */
+static u16b view_oct_g[8][VINFO_MAX_GRIDS];
+static int view_oct_n[8];
+
+/*
+ * The grids lit by monster light during the last update
+ */
+static u16b view_mon_g[VIEW_MAX];
+static int view_mon_n;
+
+/*
+ * Grids whose flags must be rebuilt during the current update
+ */
+static u16b view_dirty_g[VIEW_MAX * 2];
+static int view_dirty_n;
+
+/*
+ * Grids whose "CAVE_VIEW" or "CAVE_SEEN" flags changed during the last
+ * call to "update_view()" or "forget_view()"
+ */
+static u16b view_delta_g[VIEW_MAX * 2];
+static int view_delta_n;
+
+/*
+ * Grids whose terrain or light changed since the last update
+ */
+#define VIEW_NOTE_MAX 64
+
+static u16b view_note_g[VIEW_NOTE_MAX];
+static int view_note_n;
+
+/*
+ * What the current field of view was computed from.  The incremental
+ * update is only used while "view_valid" is set, and the player grid,
+ * light radius and blindness have not changed since.
+ */
+static bool view_valid;
+static s32b view_created_at;
+static int view_pg;
+static int view_radius;
+static bool view_blind;
+
+/*
+ * How "update_view()" recomputes the field of view (see cave.h)
+ */
+int view_mode = VIEW_INCREMENTAL;
+
+
+/*
+ * Queue a grid to have its "CAVE_VIEW" and "CAVE_SEEN" flags rebuilt
+ */
+static void view_touch(int g)
+{
+	if (view_src[g] & (VIEW_SRC_QUEUED)) return;
+
+	view_src[g] |= (VIEW_SRC_QUEUED);
+	view_dirty_g[view_dirty_n++] = g;
+}
+
+
 /*
  * Forget the "CAVE_VIEW" grids, redrawing as needed
  */
 void forget_view(void)
 {
-	int i, g;
+	int i, o2;
 
-	int fast_view_n = view_n;
-	u16b *fast_view_g = view_g;
-
-	/* XXX: this is moronic. It's not 'fast'. */
 	byte *fast_cave_info = &cave->info[0][0];
 
+	view_delta_n = 0;
+	view_note_n = 0;
+	view_valid = FALSE;
+
+	/* Gather every grid any part of the view still marks */
+	for (o2 = 0; o2 < 8; o2++)
+	{
+		for (i = 0; i < view_oct_n[o2]; i++)
+			view_touch(view_oct_g[o2][i]);
+
+		view_oct_n[o2] = 0;
+	}
+
+	for (i = 0; i < view_mon_n; i++)
+		view_touch(view_mon_g[i]);
+
+	view_mon_n = 0;
 
-	/* None to forget */
-	if (!fast_view_n) return;
+	view_touch(view_pg);
 
 	/* Clear them all */
-	for (i = 0; i < fast_view_n; i++)
+	for (i = 0; i < view_dirty_n; i++)
 	{
-		int y, x;
+		int g = view_dirty_g[i];
 
-		/* Grid */
-		g = fast_view_g[i];
+		view_src[g] = 0;
 
-		/* Location */
-		y = GRID_Y(g);
-		x = GRID_X(g);
+		/* Only grids which were in view need to be redrawn */
+		if (!(fast_cave_info[g] & (CAVE_VIEW | CAVE_SEEN))) continue;
 
 		/* Clear "CAVE_VIEW" and "CAVE_SEEN" flags */
 		fast_cave_info[g] &= ~(CAVE_VIEW | CAVE_SEEN);
 
-		/* Clear "CAVE_LIGHT" flag */
-		/* fast_cave->info[g] &= ~(CAVE_LIGHT); */
+		/* Remember the change */
+		view_delta_g[view_delta_n++] = g;
 
 		/* Redraw */
-		cave_light_spot(cave, y, x);
+		cave_light_spot(cave, GRID_Y(g), GRID_X(g));
 	}
 
-	/* None left */
-	fast_view_n = 0;
-
-
-	/* Save 'view_n' */
-	view_n = fast_view_n;
+	view_dirty_n = 0;
 }
 
 
-
 /*
- * Calculate the complete field of view using a new algorithm
- *
- * If "view_g" and "temp_g" were global pointers to arrays of grids, as
- * opposed to actual arrays of grids, then we could be more efficient by
- * using "pointer swapping".
- *
- * Note the following idiom, which is used in the function below.
- * This idiom processes each "octant" of the field of view, in a
- * clockwise manner, starting with the east strip, south side,
- * and for each octant, allows a simple calculation to set "g"
- * equal to the proper grids, relative to "pg", in the octant.
- *
- *   for (o2 = 0; o2 < 8; o2++)
- *   ...
- *         g = pg + p->grid[o2];
- *   ...
- *
- *
- * Normally, vision along the major axes is more likely than vision
- * along the diagonal axes, so we check the bits corresponding to
- * the lines of sight near the major axes first.
- *
- * We use the "temp_g" array (and the "CAVE_TEMP" flag) to keep track of
- * which grids were previously marked "CAVE_SEEN", since only those grids
- * whose "CAVE_SEEN" value changes during this routine must be redrawn.
- *
- * This function is now responsible for maintaining the "CAVE_SEEN"
- * flags as well as the "CAVE_VIEW" flags, which is good, because
- * the only grids which normally need to be memorized and/or redrawn
- * are the ones whose "CAVE_SEEN" flag changes during this routine.
- *
- * Basically, this function divides the "octagon of view" into octants of
- * grids (where grids on the main axes and diagonal axes are "shared" by
- * two octants), and processes each octant one at a time, processing each
- * octant one grid at a time, processing only those grids which "might" be
- * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
- * is an (unobstructed) line of sight from the center of the player grid to
- * any internal point in the grid (and collecting these "CAVE_VIEW" grids
- * into the "view_g" array), and setting the "CAVE_SEEN" flag for the grid
- * if, in addition, the grid is "illuminated" in some way.
- *
- * This function relies on a theorem (suggested and proven by Mat Hostetter)
- * which states that in each octant of a field of view, a given grid will
- * be "intersected" by one or more unobstructed "lines of sight" from the
- * center of the player grid if and only if it is "intersected" by at least
- * one such unobstructed "line of sight" which passes directly through some
- * corner of some grid in the octant which is not shared by any other octant.
- * The proof is based on the fact that there are at least three significant
- * lines of sight involving any non-shared grid in any octant, one which
- * intersects the grid and passes though the corner of the grid closest to
- * the player, and two which "brush" the grid, passing through the "outer"
- * corners of the grid, and that any line of sight which intersects a grid
- * without passing through the corner of a grid in the octant can be "slid"
- * slowly towards the corner of the grid closest to the player, until it
- * either reaches it or until it brushes the corner of another grid which
- * is closer to the player, and in either case, the existanc of a suitable
- * line of sight is thus demonstrated.
- *
- * It turns out that in each octant of the radius 20 "octagon of view",
- * there are 161 grids (with 128 not shared by any other octant), and there
- * are exactly 126 distinct "lines of sight" passing from the center of the
- * player grid through any corner of any non-shared grid in the octant.  To
- * determine if a grid is "viewable" by the player, therefore, you need to
- * simply show that one of these 126 lines of sight intersects the grid but
- * does not intersect any wall grid closer to the player.  So we simply use
- * a bit vector with 126 bits to represent the set of interesting lines of
- * sight which have not yet been obstructed by wall grids, and then we scan
- * all the grids in the octant, moving outwards from the player grid.  For
- * each grid, if any of the lines of sight which intersect that grid have not
- * yet been obstructed, then the grid is viewable.  Furthermore, if the grid
- * is a wall grid, then all of the lines of sight which intersect the grid
- * should be marked as obstructed for future reference.  Also, we only need
- * to check those grids for whom at least one of the "parents" was a viewable
- * non-wall grid, where the parents include the two grids touching the grid
- * but closer to the player grid (one adjacent, and one diagonal).  For the
- * bit vector, we simply use 4 32-bit integers.  All of the static values
- * which are needed by this function are stored in the large "vinfo" array
- * (above), which is machine generated by another program.  XXX XXX XXX
- *
- * Hack -- The queue must be able to hold more than VINFO_MAX_GRIDS grids
- * because the grids at the edge of the field of view use "grid zero" as
- * their children, and the queue must be able to hold several of these
- * special grids.  Because the actual number of required grids is bizarre,
- * we simply allocate twice as many as we would normally need.  XXX XXX XXX
+ * Note that the terrain or permanent light of a grid has changed, so that
+ * the next call to "update_view()" knows which octants to rescan.
  */
-void update_view(void)
+void cave_note_view_change(struct cave *c, int y, int x)
 {
-	int py = p_ptr->py;
-	int px = p_ptr->px;
+	/* Nothing to update */
+	if (c != cave || !view_valid) return;
 
-	int pg = GRID(py,px);
+	/* Too many changes, so just rescan everything */
+	if (view_note_n == VIEW_NOTE_MAX)
+	{
+		view_valid = FALSE;
+		return;
+	}
 
-	int i, j, k, g, o2;
+	view_note_g[view_note_n++] = GRID(y, x);
+}
 
-	int radius;
 
-	int fast_view_n = view_n;
-	u16b *fast_view_g = view_g;
+/*
+ * Access the grids whose "CAVE_VIEW" or "CAVE_SEEN" flags changed in the
+ * last call to "update_view()" or "forget_view()", returning their number.
+ */
+int view_delta(const u16b **grids)
+{
+	*grids = view_delta_g;
+	return view_delta_n;
+}
 
-	int fast_temp_n = 0;
-	u16b *fast_temp_g = temp_g;
 
-	/* XXX: also moronic. Optimizers exist. */
+/*
+ * Calculate the "CAVE_VIEW" and "CAVE_SEEN" flags a grid should have, given
+ * which parts of the view mark it.  This is exactly the lighting test the
+ * octant scan of the original "update_view()" used, which only depends on
+ * the grid itself and (for perma-lit walls) its neighbour towards the player.
+ */
+static byte view_grid_flags(int g, int py, int px, int radius, bool blind)
+{
 	byte *fast_cave_info = &cave->info[0][0];
 
-	byte info;
+	u16b src = view_src[g];
+	byte info = fast_cave_info[g];
+	int y, x;
 
+	/* Not viewable */
+	if (!(src & (VIEW_SRC_ALL))) return (0);
 
-	/*** Step 0 -- Begin ***/
+	/* Viewable, but blind */
+	if (blind) return (CAVE_VIEW);
+
+	/* Lit by a monster */
+	if (src & (VIEW_SRC_MONSTER)) return (CAVE_VIEW | CAVE_SEEN);
 
-	/* Save the old "view" grids for later */
-	for (i = 0; i < fast_view_n; i++)
+	/* Player grid, torch-lit or perma-lit */
+	if (src & (VIEW_SRC_PLAYER))
 	{
-		/* Grid */
-		g = fast_view_g[i];
+		if ((radius > 0) || (info & (CAVE_GLOW)))
+			return (CAVE_VIEW | CAVE_SEEN);
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+		return (CAVE_VIEW);
+	}
 
-		/* Save "CAVE_SEEN" grids */
-		if (info & (CAVE_SEEN))
-		{
-			/* Set "CAVE_TEMP" flag */
-			info |= (CAVE_TEMP);
+	y = GRID_Y(g);
+	x = GRID_X(g);
 
-			/* Save grid for later */
-			fast_temp_g[fast_temp_n++] = g;
-		}
+	/* Torch-lit grids */
+	if (distance(py, px, y, x) < radius) return (CAVE_VIEW | CAVE_SEEN);
 
-		/* Clear "CAVE_VIEW" and "CAVE_SEEN" flags */
-		info &= ~(CAVE_VIEW | CAVE_SEEN);
+	/* Dark grids */
+	if (!(info & (CAVE_GLOW))) return (CAVE_VIEW);
 
-		/* Clear "CAVE_LIGHT" flag */
-		/* info &= ~(CAVE_LIGHT); */
+	/* Perma-lit non-walls */
+	if (!(info & (CAVE_WALL))) return (CAVE_VIEW | CAVE_SEEN);
 
-		/* Save cave info */
-		fast_cave_info[g] = info;
+	/* Perma-lit walls need a perma-lit grid between them and the player */
+	else
+	{
+		/* Hack -- move towards player */
+		int yy = (y < py) ? (y + 1) : (y > py) ? (y - 1) : y;
+		int xx = (x < px) ? (x + 1) : (x > px) ? (x - 1) : x;
+
+		/* Check for "simple" illumination */
+		if (cave->info[yy][xx] & (CAVE_GLOW))
+			return (CAVE_VIEW | CAVE_SEEN);
 	}
 
-	/* Reset the "view" array */
-	fast_view_n = 0;
+	return (CAVE_VIEW);
+}
 
-	/* Extract "radius" value */
-	radius = p_ptr->cur_light;
 
-	/* Handle real light */
-	if (radius > 0) ++radius;
+/*
+ * Recompute which grids are lit by monsters carrying light
+ */
+static void view_scan_monsters(int py, int px)
+{
+	int i, j, k, g;
+
+	/* Forget the old monster light */
+	for (i = 0; i < view_mon_n; i++)
+	{
+		g = view_mon_g[i];
+		view_src[g] &= ~(VIEW_SRC_MONSTER);
+		view_touch(g);
+	}
+
+	view_mon_n = 0;
 
 	/* Scan monster list and add monster lights */
-	for (k = 1; k < z_info->m_max; k++)
+	for (k = 1; k < cave_monster_max(cave); k++)
 	{
 		/* Check the k'th monster */
 		monster_type *m_ptr = cave_monster(cave, k);
@@ -2445,7 +2488,7 @@ void update_view(void)
 		int fx = m_ptr->fx;
 		int fy = m_ptr->fy;
 
-		bool in_los = los(p_ptr->py, p_ptr->px, fy, fx);
+		bool in_los;
 
 		/* Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -2453,6 +2496,8 @@ void update_view(void)
 		/* Skip monsters not carrying light */
 		if (!rf_has(r_ptr->flags, RF_HAS_LIGHT)) continue;
 
+		in_los = los(py, px, fy, fx);
+
 		/* Light a 3x3 box centered on the monster */
 		for (i = -1; i <= 1; i++)
 		{
@@ -2460,475 +2505,587 @@ void update_view(void)
 			{
 				int sy = fy + i;
 				int sx = fx + j;
-				
+
 				/* If the monster isn't visible we can only light open tiles */
 				if (!in_los && !cave_floor_bold(sy, sx))
 					continue;
 
 				/* If the tile is too far away we won't light it */
-				if (distance(p_ptr->py, p_ptr->px, sy, sx) > MAX_SIGHT)
+				if (distance(py, px, sy, sx) > MAX_SIGHT)
 					continue;
-				
+
 				/* If the tile itself isn't in LOS, don't light it */
-				if (!los(p_ptr->py, p_ptr->px, sy, sx))
+				if (!los(py, px, sy, sx))
 					continue;
-				
+
 				g = GRID(sy, sx);
 
-				/* Mark the square lit and seen */
-				fast_cave_info[g] |= (CAVE_VIEW | CAVE_SEEN);
-				
-				/* Save in array */
-				fast_view_g[fast_view_n++] = g;
+				/* Already lit by another monster */
+				if (view_src[g] & (VIEW_SRC_MONSTER)) continue;
+
+				/* Mark the square lit */
+				view_src[g] |= (VIEW_SRC_MONSTER);
+				view_mon_g[view_mon_n++] = g;
+				view_touch(g);
 			}
 		}
 	}
+}
 
 
-	/*** Step 1 -- player grid ***/
-
-	/* Player grid */
-	g = pg;
-
-	/* Get grid info */
-	info = fast_cave_info[g];
-
-	/* Assume viewable */
-	info |= (CAVE_VIEW);
+/*
+ * Rescan a single octant of the field of view (see "update_view()")
+ */
+static void view_scan_octant(int o2, int pg)
+{
+	u16b bit = (1 << o2);
 
-	/* Torch-lit grid */
-	if (0 < radius)
-	{
-		/* Mark as "CAVE_SEEN" */
-		info |= (CAVE_SEEN);
+	u16b *oct_g = view_oct_g[o2];
+	int oct_n = 0;
 
-		/* Mark as "CAVE_LIGHT" */
-		/* info |= (CAVE_LIGHT); */
-	}
+	byte *fast_cave_info = &cave->info[0][0];
 
-	/* Perma-lit grid */
-	else if (info & (CAVE_GLOW))
-	{
-		/* Mark as "CAVE_SEEN" */
-		info |= (CAVE_SEEN);
-	}
+	vinfo_type *p;
 
-	/* Save cave info */
-	fast_cave_info[g] = info;
+	/* Last added */
+	vinfo_type *last = &vinfo[0];
 
-	/* Save in array */
-	fast_view_g[fast_view_n++] = g;
+	/* Grid queue */
+	int queue_head = 0;
+	int queue_tail = 0;
+	vinfo_type *queue[VINFO_MAX_GRIDS*2];
 
+	/* Slope bit vector */
+	u32b bits0 = VINFO_BITS_0;
+	u32b bits1 = VINFO_BITS_1;
+	u32b bits2 = VINFO_BITS_2;
+	u32b bits3 = VINFO_BITS_3;
 
-	/*** Step 2 -- octants ***/
+	int i, g;
 
-	/* Scan each octant */
-	for (o2 = 0; o2 < 8; o2++)
+	/* Forget what this octant saw last time */
+	for (i = 0; i < view_oct_n[o2]; i++)
 	{
-		vinfo_type *p;
+		g = oct_g[i];
+		view_src[g] &= ~bit;
+		view_touch(g);
+	}
 
-		/* Last added */
-		vinfo_type *last = &vinfo[0];
+	/* Initial grids */
+	queue[queue_tail++] = &vinfo[1];
+	queue[queue_tail++] = &vinfo[2];
 
-		/* Grid queue */
-		int queue_head = 0;
-		int queue_tail = 0;
-		vinfo_type *queue[VINFO_MAX_GRIDS*2];
+	/* Process queue */
+	while (queue_head < queue_tail)
+	{
+		/* Dequeue next grid */
+		p = queue[queue_head++];
 
-		/* Slope bit vector */
-		u32b bits0 = VINFO_BITS_0;
-		u32b bits1 = VINFO_BITS_1;
-		u32b bits2 = VINFO_BITS_2;
-		u32b bits3 = VINFO_BITS_3;
+		/* Check bits */
+		if (!((bits0 & (p->bits_0)) ||
+		      (bits1 & (p->bits_1)) ||
+		      (bits2 & (p->bits_2)) ||
+		      (bits3 & (p->bits_3))))
+			continue;
 
-		/* Reset queue */
-		queue_head = queue_tail = 0;
+		/* Extract grid value XXX XXX XXX */
+		g = pg + p->grid[o2];
 
-		/* Initial grids */
-		queue[queue_tail++] = &vinfo[1];
-		queue[queue_tail++] = &vinfo[2];
+		/* Newly viewable from this octant */
+		if (!(view_src[g] & bit))
+		{
+			view_src[g] |= bit;
+			oct_g[oct_n++] = g;
+			view_touch(g);
+		}
 
-		/* Process queue */
-		while (queue_head < queue_tail)
+		/* Handle wall */
+		if (fast_cave_info[g] & (CAVE_WALL))
 		{
-			/* Dequeue next grid */
-			p = queue[queue_head++];
+			/* Clear bits */
+			bits0 &= ~(p->bits_0);
+			bits1 &= ~(p->bits_1);
+			bits2 &= ~(p->bits_2);
+			bits3 &= ~(p->bits_3);
+		}
 
-			/* Check bits */
-			if ((bits0 & (p->bits_0)) ||
-			    (bits1 & (p->bits_1)) ||
-			    (bits2 & (p->bits_2)) ||
-			    (bits3 & (p->bits_3)))
+		/* Handle non-wall */
+		else
+		{
+			/* Enqueue child */
+			if (last != p->next_0)
 			{
-				/* Extract grid value XXX XXX XXX */
-				g = pg + p->grid[o2];
-
-				/* Get grid info */
-				info = fast_cave_info[g];
-
-				/* Handle wall */
-				if (info & (CAVE_WALL))
-				{
-					/* Clear bits */
-					bits0 &= ~(p->bits_0);
-					bits1 &= ~(p->bits_1);
-					bits2 &= ~(p->bits_2);
-					bits3 &= ~(p->bits_3);
-
-					/* Newly viewable wall */
-					if (!(info & (CAVE_VIEW)))
-					{
-						/* Mark as viewable */
-						info |= (CAVE_VIEW);
-
-						/* Torch-lit grids */
-						if (p->d < radius)
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-
-							/* Mark as "CAVE_LIGHT" */
-							/* info |= (CAVE_LIGHT); */
-						}
-
-						/* Perma-lit grids */
-						else if (info & (CAVE_GLOW))
-						{
-							int y = GRID_Y(g);
-							int x = GRID_X(g);
-
-							/* Hack -- move towards player */
-							int yy = (y < py) ? (y + 1) : (y > py) ? (y - 1) : y;
-							int xx = (x < px) ? (x + 1) : (x > px) ? (x - 1) : x;
-
-							/* Check for "simple" illumination */
-							if (cave->info[yy][xx] & (CAVE_GLOW))
-							{
-								/* Mark as seen */
-								info |= (CAVE_SEEN);
-							}
-						}
-
-						/* Save cave info */
-						fast_cave_info[g] = info;
-
-						/* Save in array */
-						fast_view_g[fast_view_n++] = g;
-					}
-				}
+				queue[queue_tail++] = last = p->next_0;
+			}
 
-				/* Handle non-wall */
-				else
-				{
-					/* Enqueue child */
-					if (last != p->next_0)
-					{
-						queue[queue_tail++] = last = p->next_0;
-					}
-
-					/* Enqueue child */
-					if (last != p->next_1)
-					{
-						queue[queue_tail++] = last = p->next_1;
-					}
-
-					/* Newly viewable non-wall */
-					if (!(info & (CAVE_VIEW)))
-					{
-						/* Mark as "viewable" */
-						info |= (CAVE_VIEW);
-
-						/* Torch-lit grids */
-						if (p->d < radius)
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-
-							/* Mark as "CAVE_LIGHT" */
-							/* info |= (CAVE_LIGHT); */
-						}
-
-						/* Perma-lit grids */
-						else if (info & (CAVE_GLOW))
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-						}
-
-						/* Save cave info */
-						fast_cave_info[g] = info;
-
-						/* Save in array */
-						fast_view_g[fast_view_n++] = g;
-					}
-				}
+			/* Enqueue child */
+			if (last != p->next_1)
+			{
+				queue[queue_tail++] = last = p->next_1;
 			}
 		}
 	}
 
+	view_oct_n[o2] = oct_n;
+}
 
-	/*** Step 3 -- Complete the algorithm ***/
 
-	/* Handle blindness */
-	if (p_ptr->timed[TMD_BLIND])
-	{
-		/* Process "new" grids */
-		for (i = 0; i < fast_view_n; i++)
-		{
-			/* Grid */
-			g = fast_view_g[i];
+/*
+ * Calculate the complete field of view from scratch, exactly as the
+ * original single-pass "update_view()" did, but into "out" rather than
+ * the cave.  Used to check the incremental code (see "view_verify()").
+ */
+static void view_reference(byte *out)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 
-			/* Grid cannot be "CAVE_SEEN" */
-			fast_cave_info[g] &= ~(CAVE_SEEN);
-		}
-	}
+	int pg = GRID(py,px);
 
-	/* Process "new" grids */
-	for (i = 0; i < fast_view_n; i++)
-	{
-		/* Grid */
-		g = fast_view_g[i];
+	int i, j, k, g, o2;
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+	int radius;
 
-		/* Was not "CAVE_SEEN", is now "CAVE_SEEN" */
-		if ((info & (CAVE_SEEN)) && !(info & (CAVE_TEMP)))
-		{
-			int y, x;
+	byte *fast_cave_info = &cave->info[0][0];
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
-			
-			/* Handle feeling squares */
-			if (cave->info2[y][x] & CAVE2_FEEL)
+	/* Start from nothing */
+	for (i = 0; i < DUNGEON_HGT * 256; i++) out[i] = 0;
+
+	/* Extract "radius" value */
+	radius = p_ptr->cur_light;
+
+	/* Handle real light */
+	if (radius > 0) ++radius;
+
+	/* Scan monster list and add monster lights */
+	for (k = 1; k < z_info->m_max; k++)
+	{
+		monster_type *m_ptr = cave_monster(cave, k);
+		monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+		int fx = m_ptr->fx;
+		int fy = m_ptr->fy;
+
+		bool in_los = los(py, px, fy, fx);
+
+		if (!m_ptr->r_idx) continue;
+		if (!rf_has(r_ptr->flags, RF_HAS_LIGHT)) continue;
+
+		for (i = -1; i <= 1; i++)
+		{
+			for (j = -1; j <= 1; j++)
 			{
-				cave->feeling_squares++;
-				
-				/* Erase the square so you can't 'resee' it */
-				cave->info2[y][x] &= ~(CAVE2_FEEL);
-			
-				/* Display feeling if necessary */
-				if (cave->feeling_squares == FEELING1)
-					display_feeling(TRUE);
-		
+				int sy = fy + i;
+				int sx = fx + j;
+
+				if (!in_los && !cave_floor_bold(sy, sx)) continue;
+				if (distance(py, px, sy, sx) > MAX_SIGHT) continue;
+				if (!los(py, px, sy, sx)) continue;
+
+				out[GRID(sy, sx)] |= (CAVE_VIEW | CAVE_SEEN);
 			}
-			
-			cave_note_spot(cave, y, x);
-			cave_light_spot(cave, y, x);
 		}
 	}
 
-	/* Process "old" grids */
-	for (i = 0; i < fast_temp_n; i++)
+	/* Player grid */
+	out[pg] |= (CAVE_VIEW);
+	if ((0 < radius) || (fast_cave_info[pg] & (CAVE_GLOW)))
+		out[pg] |= (CAVE_SEEN);
+
+	/* Scan each octant */
+	for (o2 = 0; o2 < 8; o2++)
 	{
-		/* Grid */
-		g = fast_temp_g[i];
+		vinfo_type *p;
+		vinfo_type *last = &vinfo[0];
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+		int queue_head = 0;
+		int queue_tail = 0;
+		vinfo_type *queue[VINFO_MAX_GRIDS*2];
 
-		/* Clear "CAVE_TEMP" flag */
-		info &= ~(CAVE_TEMP);
+		u32b bits0 = VINFO_BITS_0;
+		u32b bits1 = VINFO_BITS_1;
+		u32b bits2 = VINFO_BITS_2;
+		u32b bits3 = VINFO_BITS_3;
 
-		/* Save cave info */
-		fast_cave_info[g] = info;
+		queue[queue_tail++] = &vinfo[1];
+		queue[queue_tail++] = &vinfo[2];
 
-		/* Was "CAVE_SEEN", is now not "CAVE_SEEN" */
-		if (!(info & (CAVE_SEEN)))
+		while (queue_head < queue_tail)
 		{
-			int y, x;
+			byte info;
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
+			p = queue[queue_head++];
 
-			/* Redraw */
-			cave_light_spot(cave, y, x);
-		}
-	}
+			if (!((bits0 & (p->bits_0)) ||
+			      (bits1 & (p->bits_1)) ||
+			      (bits2 & (p->bits_2)) ||
+			      (bits3 & (p->bits_3))))
+				continue;
 
+			g = pg + p->grid[o2];
+			info = fast_cave_info[g];
 
-	/* Save 'view_n' */
-	view_n = fast_view_n;
-}
+			if (info & (CAVE_WALL))
+			{
+				bits0 &= ~(p->bits_0);
+				bits1 &= ~(p->bits_1);
+				bits2 &= ~(p->bits_2);
+				bits3 &= ~(p->bits_3);
 
+				if (out[g] & (CAVE_VIEW)) continue;
 
+				out[g] |= (CAVE_VIEW);
 
+				if (p->d < radius)
+				{
+					out[g] |= (CAVE_SEEN);
+				}
+				else if (info & (CAVE_GLOW))
+				{
+					int y = GRID_Y(g);
+					int x = GRID_X(g);
+					int yy = (y < py) ? (y + 1) : (y > py) ? (y - 1) : y;
+					int xx = (x < px) ? (x + 1) : (x > px) ? (x - 1) : x;
 
-/*
- * Size of the circular queue used by "update_flow()"
- */
-#define FLOW_MAX 2048
+					if (cave->info[yy][xx] & (CAVE_GLOW))
+						out[g] |= (CAVE_SEEN);
+				}
+			}
+			else
+			{
+				if (last != p->next_0)
+					queue[queue_tail++] = last = p->next_0;
+				if (last != p->next_1)
+					queue[queue_tail++] = last = p->next_1;
 
-/*
- * Hack -- provide some "speed" for the "flow" code
- * This entry is the "current index" for the "when" field
- * Note that a "when" value of "zero" means "not used".
- *
- * Note that the "cost" indexes from 1 to 127 are for
- * "old" data, and from 128 to 255 are for "new" data.
- *
- * This means that as long as the player does not "teleport",
- * then any monster up to 128 + MONSTER_FLOW_DEPTH will be
- * able to track down the player, and in general, will be
- * able to track down either the player or a position recently
- * occupied by the player.
- */
-static int flow_save = 0;
+				if (out[g] & (CAVE_VIEW)) continue;
+
+				out[g] |= (CAVE_VIEW);
 
+				if ((p->d < radius) || (info & (CAVE_GLOW)))
+					out[g] |= (CAVE_SEEN);
+			}
+		}
+	}
+
+	/* Handle blindness */
+	if (p_ptr->timed[TMD_BLIND])
+	{
+		for (i = 0; i < DUNGEON_HGT * 256; i++)
+			out[i] &= ~(CAVE_SEEN);
+	}
+}
 
 
 /*
- * Hack -- forget the "flow" information
+ * Compare the current "CAVE_VIEW" and "CAVE_SEEN" flags against a complete
+ * recalculation of the field of view, returning the number of grids which
+ * differ.
  */
-void cave_forget_flow(struct cave *c)
+int view_verify(void)
 {
-	int x, y;
+	static byte out[DUNGEON_HGT * 256];
 
-	/* Nothing to forget */
-	if (!flow_save) return;
+	byte *fast_cave_info = &cave->info[0][0];
 
-	/* Check the entire dungeon */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	int g, bad = 0;
+
+	view_reference(out);
+
+	for (g = 0; g < cave->height * 256; g++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Forget the old data */
-			c->cost[y][x] = 0;
-			c->when[y][x] = 0;
-		}
+		if ((fast_cave_info[g] & (CAVE_VIEW | CAVE_SEEN)) != out[g])
+			bad++;
 	}
 
-	/* Start over */
-	flow_save = 0;
+	return (bad);
 }
 
 
+
 /*
- * Hack -- fill in the "cost" field of every grid that the player can
- * "reach" with the number of steps needed to reach that grid.  This
- * also yields the "distance" of the player from every grid.
+ * Calculate the complete field of view using a new algorithm
  *
- * In addition, mark the "when" of the grids that can reach the player
- * with the incremented value of "flow_save".
+ * Note the following idiom, which is used in the function below.
+ * This idiom processes each "octant" of the field of view, in a
+ * clockwise manner, starting with the east strip, south side,
+ * and for each octant, allows a simple calculation to set "g"
+ * equal to the proper grids, relative to "pg", in the octant.
  *
- * Hack -- use the local "flow_y" and "flow_x" arrays as a "circular
- * queue" of cave grids.
+ *   for (o2 = 0; o2 < 8; o2++)
+ *   ...
+ *         g = pg + p->grid[o2];
+ *   ...
+ *
+ *
+ * Normally, vision along the major axes is more likely than vision
+ * along the diagonal axes, so we check the bits corresponding to
+ * the lines of sight near the major axes first.
+ *
+ * We use the "CAVE_TEMP" flag to keep track of which changed grids were
+ * previously marked "CAVE_SEEN", since only those grids whose "CAVE_SEEN"
+ * value changes during this routine must be redrawn.
  *
- * We do not need a priority queue because the cost from grid to grid
- * is always "one" (even along diagonals) and we process them in order.
+ * This function is now responsible for maintaining the "CAVE_SEEN"
+ * flags as well as the "CAVE_VIEW" flags, which is good, because
+ * the only grids which normally need to be memorized and/or redrawn
+ * are the ones whose "CAVE_SEEN" flag changes during this routine.
+ *
+ * Basically, this function divides the "octagon of view" into octants of
+ * grids (where grids on the main axes and diagonal axes are "shared" by
+ * two octants), and processes each octant one at a time, processing each
+ * octant one grid at a time, processing only those grids which "might" be
+ * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
+ * is an (unobstructed) line of sight from the center of the player grid to
+ * any internal point in the grid (and collecting these "CAVE_VIEW" grids
+ * into the "view_oct_g" arrays), and setting the "CAVE_SEEN" flag for the grid
+ * if, in addition, the grid is "illuminated" in some way.
+ *
+ * This function relies on a theorem (suggested and proven by Mat Hostetter)
+ * which states that in each octant of a field of view, a given grid will
+ * be "intersected" by one or more unobstructed "lines of sight" from the
+ * center of the player grid if and only if it is "intersected" by at least
+ * one such unobstructed "line of sight" which passes directly through some
+ * corner of some grid in the octant which is not shared by any other octant.
+ * The proof is based on the fact that there are at least three significant
+ * lines of sight involving any non-shared grid in any octant, one which
+ * intersects the grid and passes though the corner of the grid closest to
+ * the player, and two which "brush" the grid, passing through the "outer"
+ * corners of the grid, and that any line of sight which intersects a grid
+ * without passing through the corner of a grid in the octant can be "slid"
+ * slowly towards the corner of the grid closest to the player, until it
+ * either reaches it or until it brushes the corner of another grid which
+ * is closer to the player, and in either case, the existanc of a suitable
+ * line of sight is thus demonstrated.
+ *
+ * It turns out that in each octant of the radius 20 "octagon of view",
+ * there are 161 grids (with 128 not shared by any other octant), and there
+ * are exactly 126 distinct "lines of sight" passing from the center of the
+ * player grid through any corner of any non-shared grid in the octant.  To
+ * determine if a grid is "viewable" by the player, therefore, you need to
+ * simply show that one of these 126 lines of sight intersects the grid but
+ * does not intersect any wall grid closer to the player.  So we simply use
+ * a bit vector with 126 bits to represent the set of interesting lines of
+ * sight which have not yet been obstructed by wall grids, and then we scan
+ * all the grids in the octant, moving outwards from the player grid.  For
+ * each grid, if any of the lines of sight which intersect that grid have not
+ * yet been obstructed, then the grid is viewable.  Furthermore, if the grid
+ * is a wall grid, then all of the lines of sight which intersect the grid
+ * should be marked as obstructed for future reference.  Also, we only need
+ * to check those grids for whom at least one of the "parents" was a viewable
+ * non-wall grid, where the parents include the two grids touching the grid
+ * but closer to the player grid (one adjacent, and one diagonal).  For the
+ * bit vector, we simply use 4 32-bit integers.  All of the static values
+ * which are needed by this function are stored in the large "vinfo" array
+ * (above), which is machine generated by another program.  XXX XXX XXX
+ *
+ * Hack -- The queue must be able to hold more than VINFO_MAX_GRIDS grids
+ * because the grids at the edge of the field of view use "grid zero" as
+ * their children, and the queue must be able to hold several of these
+ * special grids.  Because the actual number of required grids is bizarre,
+ * we simply allocate twice as many as we would normally need.  XXX XXX XXX
+ *
+ * The field of view is now maintained incrementally.  Each octant remembers
+ * the grids it found viewable (in "view_oct_g" and the "view_src" bits), so
+ * the flags of a grid can be rebuilt from the parts of the view that mark
+ * it.  A grid which is not viewable from an octant cannot affect that
+ * octant, since every line of sight through it is already obstructed, so
+ * when a door opens or closes (see "cave_note_view_change()") only the
+ * octants which can see that grid are rescanned.  When the player moves,
+ * or the light radius or blindness changes, every octant is rescanned, but
+ * only grids whose flags actually change are written, memorized, redrawn
+ * and collected in the delta list (see "view_delta()").  Monster light is
+ * always recalculated, since monsters may have moved.  In "VIEW_VERIFY"
+ * mode the result is checked against the original single-pass algorithm.
  */
-void cave_update_flow(struct cave *c)
+void update_view(void)
 {
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	int ty, tx;
+	int pg = GRID(py,px);
 
-	int y, x;
+	int i, g, o2;
+
+	int radius;
+
+	bool blind = (p_ptr->timed[TMD_BLIND] ? TRUE : FALSE);
 
-	int n, d;
+	int octants = 0;
 
-	int flow_n;
+	byte *fast_cave_info = &cave->info[0][0];
 
-	int flow_tail = 0;
-	int flow_head = 0;
 
-	byte flow_y[FLOW_MAX];
-	byte flow_x[FLOW_MAX];
+	/*** Step 0 -- Begin ***/
+
+	view_delta_n = 0;
+	view_dirty_n = 0;
+
+	/* Extract "radius" value */
+	radius = p_ptr->cur_light;
 
+	/* Handle real light */
+	if (radius > 0) ++radius;
 
-	/*** Cycle the flow ***/
+	/* Something changed which affects the whole view */
+	if (!view_valid || (view_mode == VIEW_FULL) ||
+	    (view_created_at != cave->created_at) || (view_pg != pg) ||
+	    (view_radius != radius) || (view_blind != blind))
+	{
+		octants = VIEW_SRC_OCTANTS;
+	}
 
-	/* Cycle the flow */
-	if (flow_save++ == 255)
+	/* Only a few grids changed */
+	else
 	{
-		/* Cycle the flow */
-		for (y = 0; y < DUNGEON_HGT; y++)
+		for (i = 0; i < view_note_n; i++)
 		{
-			for (x = 0; x < DUNGEON_WID; x++)
+			int y, x, yy, xx;
+
+			g = view_note_g[i];
+
+			/* Rescan every octant which sees the grid */
+			octants |= (view_src[g] & (VIEW_SRC_OCTANTS));
+
+			/* Lighting of the grid and any walls it illuminates */
+			y = GRID_Y(g);
+			x = GRID_X(g);
+
+			for (yy = y - 1; yy <= y + 1; yy++)
 			{
-				int w = c->when[y][x];
-				c->when[y][x] = (w >= 128) ? (w - 128) : 0;
+				for (xx = x - 1; xx <= x + 1; xx++)
+				{
+					if (!cave_in_bounds(cave, yy, xx)) continue;
+					if (!(view_src[GRID(yy, xx)] & (VIEW_SRC_ALL))) continue;
+
+					view_touch(GRID(yy, xx));
+				}
 			}
 		}
+	}
+
+	view_note_n = 0;
+
+
+	/*** Step 1 -- player grid ***/
+
+	view_src[view_pg] &= ~(VIEW_SRC_PLAYER);
+	view_touch(view_pg);
 
-		/* Restart */
-		flow_save = 128;
+	view_src[pg] |= (VIEW_SRC_PLAYER);
+	view_touch(pg);
+
+
+	/*** Step 2 -- monster light and octants ***/
+
+	view_scan_monsters(py, px);
+
+	for (o2 = 0; o2 < 8; o2++)
+	{
+		if (octants & (1 << o2)) view_scan_octant(o2, pg);
 	}
 
-	/* Local variable */
-	flow_n = flow_save;
+	view_valid = TRUE;
+	view_created_at = cave->created_at;
+	view_pg = pg;
+	view_radius = radius;
+	view_blind = blind;
+
 
+	/*** Step 3 -- Complete the algorithm ***/
+
+	/* Rebuild the flags of every grid which may have changed */
+	for (i = 0; i < view_dirty_n; i++)
+	{
+		byte info, flags;
 
-	/*** Player Grid ***/
+		/* Grid */
+		g = view_dirty_g[i];
 
-	/* Save the time-stamp */
-	c->when[py][px] = flow_n;
+		view_src[g] &= ~(VIEW_SRC_QUEUED);
+
+		/* Get grid info */
+		info = fast_cave_info[g];
+		flags = view_grid_flags(g, py, px, radius, blind);
 
-	/* Save the flow cost */
-	c->cost[py][px] = 0;
+		/* No change */
+		if ((info & (CAVE_VIEW | CAVE_SEEN)) == flags) continue;
 
-	/* Enqueue that entry */
-	flow_y[flow_head] = py;
-	flow_x[flow_head] = px;
+		/* Use "CAVE_TEMP" to remember if the grid was "CAVE_SEEN" */
+		if (info & (CAVE_SEEN)) flags |= (CAVE_TEMP);
 
-	/* Advance the queue */
-	++flow_tail;
+		/* Save cave info */
+		fast_cave_info[g] = (info & ~(CAVE_VIEW | CAVE_SEEN)) | flags;
 
+		/* Remember the change */
+		view_delta_g[view_delta_n++] = g;
+	}
 
-	/*** Process Queue ***/
+	view_dirty_n = 0;
 
-	/* Now process the queue */
-	while (flow_head != flow_tail)
+	/* Process changed grids */
+	for (i = 0; i < view_delta_n; i++)
 	{
-		/* Extract the next entry */
-		ty = flow_y[flow_head];
-		tx = flow_x[flow_head];
+		int y, x;
 
-		/* Forget that entry (with wrap) */
-		if (++flow_head == FLOW_MAX) flow_head = 0;
+		byte info;
 
-		/* Child cost */
-		n = c->cost[ty][tx] + 1;
+		/* Grid */
+		g = view_delta_g[i];
 
-		/* Hack -- Limit flow depth */
-		if (n == MONSTER_FLOW_DEPTH) continue;
+		/* Get grid info */
+		info = fast_cave_info[g];
 
-		/* Add the "children" */
-		for (d = 0; d < 8; d++)
-		{
-			int old_head = flow_tail;
+		/* Location */
+		y = GRID_Y(g);
+		x = GRID_X(g);
 
-			/* Child location */
-			y = ty + ddy_ddd[d];
-			x = tx + ddx_ddd[d];
+		/* Was "CAVE_SEEN", is still "CAVE_SEEN" */
+		if ((info & (CAVE_SEEN)) && (info & (CAVE_TEMP)))
+		{
+			/* Clear "CAVE_TEMP" flag */
+			fast_cave_info[g] &= ~(CAVE_TEMP);
+		}
 
-			/* Ignore "pre-stamped" entries */
-			if (c->when[y][x] == flow_n) continue;
+		/* Was not "CAVE_SEEN", is now "CAVE_SEEN" */
+		else if (info & (CAVE_SEEN))
+		{
+			/* Handle feeling squares */
+			if (cave->info2[y][x] & CAVE2_FEEL)
+			{
+				cave->feeling_squares++;
 
-			/* Ignore "walls" and "rubble" */
-			if (c->feat[y][x] >= FEAT_RUBBLE) continue;
+				/* Erase the square so you can't 'resee' it */
+				cave->info2[y][x] &= ~(CAVE2_FEEL);
 
-			/* Save the time-stamp */
-			c->when[y][x] = flow_n;
+				/* Display feeling if necessary */
+				if (cave->feeling_squares == FEELING1)
+					display_feeling(TRUE);
 
-			/* Save the flow cost */
-			c->cost[y][x] = n;
+			}
 
-			/* Enqueue that entry */
-			flow_y[flow_tail] = y;
-			flow_x[flow_tail] = x;
+			cave_note_spot(cave, y, x);
+			cave_light_spot(cave, y, x);
+		}
 
-			/* Advance the queue */
-			if (++flow_tail == FLOW_MAX) flow_tail = 0;
+		/* Was "CAVE_SEEN", is now not "CAVE_SEEN" */
+		else if (info & (CAVE_TEMP))
+		{
+			/* Clear "CAVE_TEMP" flag */
+			fast_cave_info[g] &= ~(CAVE_TEMP);
 
-			/* Hack -- Overflow by forgetting new entry */
-			if (flow_tail == flow_head) flow_tail = old_head;
+			/* Redraw */
+			cave_light_spot(cave, y, x);
 		}
 	}
+
+	/* Check the result against a full recalculation */
+	if (view_mode == VIEW_VERIFY)
+	{
+		int bad = view_verify();
+
+		if (bad) msg("Field of view differs in %d grids!", bad);
+	}
 }
 
 
@@ -2961,10 +3118,10 @@ void wiz_light(void)
 	}
 
 	/* Scan all normal grids */
-	for (y = 1; y < DUNGEON_HGT-1; y++)
+	for (y = 1; y < cave->height-1; y++)
 	{
 		/* Scan all normal grids */
-		for (x = 1; x < DUNGEON_WID-1; x++)
+		for (x = 1; x < cave->width-1; x++)
 		{
 			/* Process all non-walls */
 			if (cave->feat[y][x] < FEAT_SECRET)
@@ -3003,9 +3160,9 @@ void wiz_dark(void)
 
 
 	/* Forget every grid */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
 			/* Process the grid */
 			cave->info[y][x] &= ~(CAVE_MARK);
@@ -3118,24 +3275,194 @@ void cave_illuminate(struct cave *c, bool daytime)
 void cave_set_feat(struct cave *c, int y, int x, int feat)
 {
 	assert(c);
-	assert(y >= 0 && y < DUNGEON_HGT);
-	assert(x >= 0 && x < DUNGEON_WID);
-	/* XXX: Check against c->height and c->width instead, once everywhere
-	 * honors those... */
+	assert(cave_in_bounds(c, y, x));
 
 	c->feat[y][x] = feat;
 
+	cave_note_flow_change(c, y, x);
+
 	if (feat >= FEAT_DOOR_HEAD)
 		c->info[y][x] |= CAVE_WALL;
 	else
 		c->info[y][x] &= ~CAVE_WALL;
 
+	cave_note_wall(c, y, x);
+	cave_note_empty(c, y, x);
+
 	if (character_dungeon) {
+		cave_note_view_change(c, y, x);
 		cave_note_spot(c, y, x);
 		cave_light_spot(c, y, x);
 	}
 }
 
+
+/*
+ * Copy the CAVE_WALL flag of a square into the wall plane, which keeps the
+ * flag of every square as one bit so that whole rows can be counted a word
+ * at a time.  cave_set_feat() calls this itself.
+ */
+void cave_note_wall(struct cave *c, int y, int x)
+{
+	u32b bit = 1UL << (x % 32);
+
+	c->wall_serial++;
+
+	if (c->info[y][x] & CAVE_WALL)
+		c->wall_plane[y][x / 32] |= bit;
+	else
+		c->wall_plane[y][x / 32] &= ~bit;
+}
+
+/*
+ * Count the bits set in a word
+ */
+static int count_bits(u32b bits)
+{
+	bits = bits - ((bits >> 1) & 0x55555555UL);
+	bits = (bits & 0x33333333UL) + ((bits >> 2) & 0x33333333UL);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0FUL;
+	return ((bits * 0x01010101UL) & 0xFFFFFFFFUL) >> 24;
+}
+
+/*
+ * Count the wall squares (see cave_iswall()) in y1 <= y <= y2,
+ * x1 <= x <= x2.
+ */
+int cave_count_walls(struct cave *c, int y1, int x1, int y2, int x2)
+{
+	int y, w, n = 0;
+
+	for (y = y1; y <= y2; y++) {
+		for (w = x1 / 32; w <= x2 / 32; w++) {
+			u32b bits = c->wall_plane[y][w];
+
+			/* Trim the words at either end to the columns asked for */
+			if (w == x1 / 32)
+				bits &= (0xFFFFFFFFUL << (x1 % 32)) & 0xFFFFFFFFUL;
+			if (w == x2 / 32)
+				bits &= 0xFFFFFFFFUL >> (31 - x2 % 32);
+
+			n += count_bits(bits);
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Each cave keeps its empty squares (see cave_isempty()) as a set: an
+ * array of the squares, and the place of every square in that array.  A
+ * square is added, removed or picked at random in constant time.
+ *
+ * Anything which changes the terrain, monster or objects of a square must
+ * call cave_note_empty() on it afterwards; cave_set_feat() does so itself.
+ */
+#define EMPTY_GRID(Y, X)	((Y) * DUNGEON_WID + (X))
+
+void cave_note_empty(struct cave *c, int y, int x)
+{
+	int g = EMPTY_GRID(y, x);
+	int i = c->empty_pos[g];
+	bool empty = cave_isempty(c, y, x);
+
+	if (empty && i < 0) {
+		c->empty_pos[g] = c->empty_n;
+		c->empty[c->empty_n++] = g;
+	} else if (!empty && i >= 0) {
+		/* Fill the gap with the last square */
+		int last = c->empty[--c->empty_n];
+
+		c->empty[i] = last;
+		c->empty_pos[last] = i;
+		c->empty_pos[g] = -1;
+	}
+}
+
+/*
+ * Erase the terrain, flags, monsters and objects of every square, leaving
+ * nothing empty.
+ */
+void cave_wipe(struct cave *c)
+{
+	int h = c->height;
+	int w = c->width;
+
+	memset(c->info[0], 0, h * CAVE_INFO_WID * sizeof(**c->info));
+	memset(c->info2[0], 0, h * CAVE_INFO_WID * sizeof(**c->info2));
+	memset(c->feat[0], 0, h * w * sizeof(**c->feat));
+	memset(c->m_idx[0], 0, h * w * sizeof(**c->m_idx));
+	memset(c->o_idx[0], 0, h * w * sizeof(**c->o_idx));
+	memset(c->wall_plane[0], 0, h * ((w + 31) / 32) *
+		sizeof(**c->wall_plane));
+	c->wall_serial++;
+
+	while (c->empty_n)
+		c->empty_pos[c->empty[--c->empty_n]] = -1;
+}
+
+/*
+ * Find the empty squares again from scratch, after the level has been
+ * changed wholesale.
+ */
+void cave_reset_empty(struct cave *c)
+{
+	int y, x;
+
+	c->empty_n = 0;
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			c->empty_pos[EMPTY_GRID(y, x)] = -1;
+
+	for (y = 0; y < c->height; y++)
+		for (x = 0; x < c->width; x++)
+			cave_note_empty(c, y, x);
+}
+
+/*
+ * Pick an empty square at random, all being equally likely.  Returns
+ * FALSE if there are none.
+ */
+bool cave_pick_empty(struct cave *c, int *y, int *x)
+{
+	int g;
+
+	if (!c->empty_n) return FALSE;
+
+	g = c->empty[randint0(c->empty_n)];
+	*y = g / DUNGEON_WID;
+	*x = g % DUNGEON_WID;
+	return TRUE;
+}
+
+/*
+ * Try the empty squares in random order for one which satisfies `pred`, or
+ * any of them if `pred` is NULL.
+ *
+ * Returns the number of squares tested to find one, or 0 if none was found.
+ */
+int cave_find_empty(struct cave *c, int *y, int *x, cave_predicate pred)
+{
+	int i, n = c->empty_n;
+
+	for (i = 0; i < n; i++) {
+		int j = randint0(n - i) + i;
+		int g = c->empty[j];
+
+		/* Move the square to the front, so it isn't tried again */
+		c->empty[j] = c->empty[i];
+		c->empty_pos[c->empty[j]] = j;
+		c->empty[i] = g;
+		c->empty_pos[g] = i;
+
+		*y = g / DUNGEON_WID;
+		*x = g % DUNGEON_WID;
+		if (!pred || pred(c, *y, *x)) return i + 1;
+	}
+
+	return 0;
+}
+
 bool cave_in_bounds(struct cave *c, int y, int x)
 {
 	return x >= 0 && x < c->width && y >= 0 && y < c->height;
@@ -3416,15 +3743,9 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 
 /*
  * Determine if a bolt spell cast from (y1,x1) to (y2,x2) will arrive
- * at the final destination, assuming that no monster gets in the way,
- * using the "project_path()" function to check the projection path.
- *
- * Note that no grid is ever "projectable()" from itself.
- *
- * This function is used to determine if the player can (easily) target
- * a given grid, and if a monster can target the player.
+ * at the final destination, by following the projection path.
  */
-bool projectable(int y1, int x1, int y2, int x2, int flg)
+static bool projectable_path(int y1, int x1, int y2, int x2, int flg)
 {
 	int y, x;
 
@@ -3452,6 +3773,116 @@ bool projectable(int y1, int x1, int y2, int x2, int flg)
 }
 
 
+/*
+ * Most projectable() checks are from a monster to the player, or from the
+ * player to a monster, and without PROJECT_STOP the answer only depends on
+ * the two grids and the walls in between.  So for each grid the cache
+ * remembers both answers, along with the serial number they were found
+ * under.  The serial moves on whenever the player moves or any wall may
+ * have changed, which forgets every answer at once.
+ */
+#define PROJ_TO_PLAYER		0x01
+#define PROJ_FROM_PLAYER	0x02
+
+#define PROJ_GRID(Y,X)	((Y) * DUNGEON_WID + (X))
+
+struct proj_cache {
+	u32b serial;
+
+	/* What the current answers were found under */
+	bool valid;
+	int py, px;
+	u32b wall_serial;
+
+	/* Per grid, the serial of each answer, and the answers themselves */
+	u32b *stamp[2];
+	byte *answer;
+};
+
+static struct proj_cache *proj_cache_new(void)
+{
+	struct proj_cache *pc = mem_zalloc(sizeof(*pc));
+
+	pc->stamp[0] = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u32b);
+	pc->stamp[1] = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u32b);
+	pc->answer = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, byte);
+
+	return pc;
+}
+
+static void proj_cache_free(struct proj_cache *pc)
+{
+	mem_free(pc->stamp[0]);
+	mem_free(pc->stamp[1]);
+	mem_free(pc->answer);
+	mem_free(pc);
+}
+
+
+/*
+ * Determine if a bolt spell cast from (y1,x1) to (y2,x2) will arrive
+ * at the final destination, assuming that no monster gets in the way,
+ * using the "project_path()" function to check the projection path.
+ *
+ * Note that no grid is ever "projectable()" from itself.
+ *
+ * This function is used to determine if the player can (easily) target
+ * a given grid, and if a monster can target the player.  Those two checks
+ * are answered from the level's cache when they have been made before.
+ */
+bool projectable(int y1, int x1, int y2, int x2, int flg)
+{
+	struct proj_cache *pc;
+	int dir, grid;
+	byte mask;
+
+	/* Only checks to or from the player which ignore monsters */
+	if (flg != PROJECT_NONE || !cave)
+		return projectable_path(y1, x1, y2, x2, flg);
+
+	if (y2 == p_ptr->py && x2 == p_ptr->px && in_bounds(y1, x1))
+	{
+		dir = 0;
+		grid = PROJ_GRID(y1, x1);
+		mask = PROJ_TO_PLAYER;
+	}
+	else if (y1 == p_ptr->py && x1 == p_ptr->px && in_bounds(y2, x2))
+	{
+		dir = 1;
+		grid = PROJ_GRID(y2, x2);
+		mask = PROJ_FROM_PLAYER;
+	}
+	else
+	{
+		return projectable_path(y1, x1, y2, x2, flg);
+	}
+
+	/* Forget everything if the player or the walls have moved */
+	pc = cave->proj;
+	if (!pc->valid || pc->py != p_ptr->py || pc->px != p_ptr->px ||
+			pc->wall_serial != cave->wall_serial)
+	{
+		pc->serial++;
+		pc->valid = TRUE;
+		pc->py = p_ptr->py;
+		pc->px = p_ptr->px;
+		pc->wall_serial = cave->wall_serial;
+	}
+
+	if (pc->stamp[dir][grid] != pc->serial)
+	{
+		pc->stamp[dir][grid] = pc->serial;
+
+		if (projectable_path(y1, x1, y2, x2, flg))
+			pc->answer[grid] |= mask;
+		else
+			pc->answer[grid] &= ~mask;
+	}
+
+	return (pc->answer[grid] & mask) ? TRUE : FALSE;
+}
+
+
 
 /*
  * Standard "find me a location" function
@@ -3497,10 +3928,18 @@ void scatter(int *yp, int *xp, int y, int x, int d, int m)
 /* XXX: this does not belong here */
 void health_track(struct player *p, struct monster *m_ptr)
 {
-	p->health_who = m_ptr;
+	p->health_who = m_ptr ? cave_monster_handle(cave, m_ptr->midx) : 0;
 	p->redraw |= PR_HEALTH;
 }
 
+/*
+ * The monster being tracked, or NULL if there is none or it has gone
+ */
+struct monster *health_tracked(struct player *p)
+{
+	return p->health_who ? cave_monster_byhandle(cave, p->health_who) : NULL;
+}
+
 /*
  * Hack -- track the given monster race
  */
@@ -3595,34 +4034,202 @@ bool is_quest(int level)
 	return FALSE;
 }
 
+/*
+ * What kinds of square each feature counts as, for the predicates below
+ */
+#define FP_FLOOR	0x0001
+#define FP_ROCK		0x0002
+#define FP_PERM		0x0004
+#define FP_MAGMA	0x0008
+#define FP_QUARTZ	0x0010
+#define FP_RUBBLE	0x0020
+#define FP_SECRET	0x0040	/* Secret door */
+#define FP_OPEN		0x0080	/* Open door */
+#define FP_CLOSED	0x0100	/* Closed door */
+#define FP_LOCKED	0x0200	/* Locked (or jammed) door */
+#define FP_JAMMED	0x0400	/* Jammed door */
+#define FP_INVIS	0x0800	/* Unknown trap */
+#define FP_TRAP		0x1000	/* Known trap */
+
+#define FP_MINERAL	(FP_ROCK | FP_MAGMA | FP_QUARTZ)
+#define FP_DOOR		(FP_SECRET | FP_OPEN | FP_CLOSED)
+
+static u16b feat_props[256];
+
+#define feat_is(C, Y, X, MASK) \
+	((feat_props[(C)->feat[Y][X]] & (MASK)) != 0)
+
+static void feat_props_init(void)
+{
+	int f;
+
+	feat_props[FEAT_FLOOR] = FP_FLOOR;
+	feat_props[FEAT_INVIS] = FP_INVIS;
+	feat_props[FEAT_OPEN] = FP_OPEN;
+	feat_props[FEAT_SECRET] = FP_SECRET;
+	feat_props[FEAT_RUBBLE] = FP_RUBBLE;
+
+	for (f = FEAT_TRAP_HEAD; f <= FEAT_TRAP_TAIL; f++)
+		feat_props[f] = FP_TRAP;
+
+	for (f = FEAT_DOOR_HEAD; f <= FEAT_DOOR_TAIL; f++) {
+		feat_props[f] = FP_CLOSED;
+		if (f >= FEAT_DOOR_HEAD + 0x01) feat_props[f] |= FP_LOCKED;
+		if (f >= FEAT_DOOR_HEAD + 0x08) feat_props[f] |= FP_JAMMED;
+	}
+
+	feat_props[FEAT_MAGMA] = feat_props[FEAT_MAGMA_H] =
+		feat_props[FEAT_MAGMA_K] = FP_MAGMA;
+	feat_props[FEAT_QUARTZ] = feat_props[FEAT_QUARTZ_H] =
+		feat_props[FEAT_QUARTZ_K] = FP_QUARTZ;
+
+	for (f = FEAT_WALL_EXTRA; f <= FEAT_WALL_SOLID; f++)
+		feat_props[f] = FP_ROCK;
+	for (f = FEAT_PERM_EXTRA; f <= FEAT_PERM_SOLID; f++)
+		feat_props[f] = FP_PERM;
+}
+
+/*
+ * Allocate a cleared plane of H rows of W squares as one block, behind a
+ * table of pointers to its rows, so that P[y][x] reaches a square.
+ */
+#define PLANE_NEW(P, H, W) do { \
+	size_t row_size_ = (W) * sizeof(**(P)); \
+	char *rows_; \
+	int y_; \
+	(P) = mem_zalloc((H) * (sizeof(*(P)) + row_size_)); \
+	rows_ = (char *)((P) + (H)); \
+	for (y_ = 0; y_ < (H); y_++) \
+		(P)[y_] = (void *)(rows_ + y_ * row_size_); \
+} while (0)
+
+/*
+ * Copy the first H rows of N squares from one plane to another.
+ */
+#define PLANE_COPY(TO, FROM, H, N) do { \
+	int y_; \
+	for (y_ = 0; y_ < (H); y_++) \
+		memcpy((TO)[y_], (FROM)[y_], (N) * sizeof(**(TO))); \
+} while (0)
+
+/**
+ * Give the level a new size, reallocating its planes to fit.
+ *
+ * The squares the old and new sizes share are kept as they were; the rest
+ * of the new level is cleared, and anything outside it is dropped.  Any
+ * monsters or objects out there must have been removed beforehand.
+ */
+void cave_set_dimensions(struct cave *c, int h, int w)
+{
+	byte **info, **info2, **feat;
+	s16b **m_idx, **o_idx;
+	u32b **wall_plane;
+	int kh = MIN(h, c->height);
+	int kw = MIN(w, c->width);
+	int i, y, x;
+
+	assert(h > 0 && h <= DUNGEON_HGT);
+	assert(w > 0 && w <= DUNGEON_WID);
+
+	if (c->feat && h == c->height && w == c->width) return;
+
+	PLANE_NEW(info, h, CAVE_INFO_WID);
+	PLANE_NEW(info2, h, CAVE_INFO_WID);
+	PLANE_NEW(feat, h, w);
+	PLANE_NEW(m_idx, h, w);
+	PLANE_NEW(o_idx, h, w);
+	PLANE_NEW(wall_plane, h, (w + 31) / 32);
+
+	if (c->feat) {
+		PLANE_COPY(info, c->info, kh, kw);
+		PLANE_COPY(info2, c->info2, kh, kw);
+		PLANE_COPY(feat, c->feat, kh, kw);
+		PLANE_COPY(m_idx, c->m_idx, kh, kw);
+		PLANE_COPY(o_idx, c->o_idx, kh, kw);
+
+		for (y = 0; y < kh; y++)
+			for (x = 0; x < kw; x++)
+				if (info[y][x] & CAVE_WALL)
+					wall_plane[y][x / 32] |= 1UL << (x % 32);
+
+		mem_free(c->info);
+		mem_free(c->info2);
+		mem_free(c->feat);
+		mem_free(c->m_idx);
+		mem_free(c->o_idx);
+		mem_free(c->wall_plane);
+	}
+
+	c->info = info;
+	c->info2 = info2;
+	c->feat = feat;
+	c->m_idx = m_idx;
+	c->o_idx = o_idx;
+	c->wall_plane = wall_plane;
+	c->wall_serial++;
+
+	c->height = h;
+	c->width = w;
+
+	/* Forget the empty squares that are no longer on the level */
+	for (i = 0; i < c->empty_n; ) {
+		int g = c->empty[i];
+
+		if (g / DUNGEON_WID < h && g % DUNGEON_WID < w) {
+			i++;
+			continue;
+		}
+
+		c->empty[i] = c->empty[--c->empty_n];
+		c->empty_pos[c->empty[i]] = i;
+		c->empty_pos[g] = -1;
+	}
+}
+
 struct cave *cave = NULL;
 
 struct cave *cave_new(void) {
 	struct cave *c = mem_zalloc(sizeof *c);
-	c->info = C_ZNEW(DUNGEON_HGT, byte_256);
-	c->info2 = C_ZNEW(DUNGEON_HGT, byte_256);
-	c->feat = C_ZNEW(DUNGEON_HGT, byte_wid);
-	c->cost = C_ZNEW(DUNGEON_HGT, byte_wid);
-	c->when = C_ZNEW(DUNGEON_HGT, byte_wid);
-	c->m_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
-	c->o_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
+
+	if (!feat_props[FEAT_FLOOR]) feat_props_init();
+
+	c->empty = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u16b);
+	c->empty_pos = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, s16b);
+	cave_set_dimensions(c, DUNGEON_HGT, DUNGEON_WID);
+	cave_reset_empty(c);
 
 	c->monsters = C_ZNEW(z_info->m_max, struct monster);
 	c->mon_max = 1;
+	c->mon_slots = slots_new(z_info->m_max);
+	c->mon_sched = mon_sched_new(z_info->m_max);
+	c->mon_spatial = mon_spatial_new(z_info->m_max);
+	c->proj = proj_cache_new();
+
+	c->flow[FLOW_NOISE] = flow_new(MONSTER_FLOW_DEPTH);
+	c->flow[FLOW_STAIRS] = flow_new(DUNGEON_HGT * DUNGEON_WID);
 
 	c->created_at = 1;
 	return c;
 }
 
 void cave_free(struct cave *c) {
+	int i;
+
 	mem_free(c->info);
 	mem_free(c->info2);
 	mem_free(c->feat);
-	mem_free(c->cost);
-	mem_free(c->when);
 	mem_free(c->m_idx);
 	mem_free(c->o_idx);
+	mem_free(c->wall_plane);
+	mem_free(c->empty);
+	mem_free(c->empty_pos);
 	mem_free(c->monsters);
+	slots_free(c->mon_slots);
+	mon_sched_free(c->mon_sched);
+	mon_spatial_free(c->mon_spatial);
+	proj_cache_free(c->proj);
+	for (i = 0; i < FLOW_MAX; i++)
+		flow_free(c->flow[i]);
 	mem_free(c);
 }
 
@@ -3639,13 +4246,15 @@ void cave_free(struct cave *c) {
  * behave like a rock wall until the player determines it's a door.
  *
  * Use functions like cave_isdiggable, cave_iswall, etc. in these cases.
+ *
+ * Each predicate looks the feature up in feat_props[], which holds what
+ * kinds of square each feature counts as, following the FEAT_ numbering.
  */
-
 /**
  * True if the square is normal open floor.
  */
 bool cave_isfloor(struct cave *c, int y, int x) {
-	return c->feat[y][x] == FEAT_FLOOR;
+	return feat_is(c, y, x, FP_FLOOR);
 }
 
 /**
@@ -3655,13 +4264,7 @@ bool cave_isfloor(struct cave *c, int y, int x) {
  * of cave generation (and should be avoided).
  */
 bool cave_isrock(struct cave *c, int y, int x) {
-	switch (c->feat[y][x]) {
-		case FEAT_WALL_EXTRA:
-		case FEAT_WALL_INNER:
-		case FEAT_WALL_OUTER:
-		case FEAT_WALL_SOLID: return TRUE;
-		default: return FALSE;
-	}
+	return feat_is(c, y, x, FP_ROCK);
 }
 
 /**
@@ -3671,51 +4274,35 @@ bool cave_isrock(struct cave *c, int y, int x) {
  * of cave generation (and should be avoided).
  */
 bool cave_isperm(struct cave *c, int y, int x) {
-	switch (c->feat[y][x]) {
-		case FEAT_PERM_EXTRA:
-		case FEAT_PERM_INNER:
-		case FEAT_PERM_OUTER:
-		case FEAT_PERM_SOLID: return TRUE;
-		default: return FALSE;
-	}
+	return feat_is(c, y, x, FP_PERM);
 }
 
 /**
  * True if the square is a magma wall.
  */
 bool cave_ismagma(struct cave *c, int y, int x) {
-	switch (c->feat[y][x]) {
-		case FEAT_MAGMA:
-		case FEAT_MAGMA_H:
-		case FEAT_MAGMA_K: return TRUE;
-		default: return FALSE;
-	}
+	return feat_is(c, y, x, FP_MAGMA);
 }
 
 /**
  * True if the square is a quartz wall.
  */
 bool cave_isquartz(struct cave *c, int y, int x) {
-	switch (c->feat[y][x]) {
-		case FEAT_QUARTZ:
-		case FEAT_QUARTZ_H:
-		case FEAT_QUARTZ_K: return TRUE;
-		default: return FALSE;
-	}
+	return feat_is(c, y, x, FP_QUARTZ);
 }
 
 /**
  * True if the square is a mineral wall (magma/quartz).
  */
 bool cave_ismineral(struct cave *c, int y, int x) {
-	return cave_isrock(c, y, x) || cave_ismagma(c, y, x) || cave_isquartz(c, y, x);
+	return feat_is(c, y, x, FP_MINERAL);
 }
 
 /**
  * True if the square is rubble.
  */
 bool cave_isrubble(struct cave *c, int y, int x) {
-	return c->feat[y][x] == FEAT_RUBBLE;
+	return feat_is(c, y, x, FP_RUBBLE);
 }
 
 /**
@@ -3725,38 +4312,35 @@ bool cave_isrubble(struct cave *c, int y, int x) {
  * is replaced by a closed door.
  */
 bool cave_issecretdoor(struct cave *c, int y, int x) {
-    return c->feat[y][x] == FEAT_SECRET;
+	return feat_is(c, y, x, FP_SECRET);
 }
 
 /**
  * True if the square is an open door.
  */
 bool cave_isopendoor(struct cave *c, int y, int x) {
-    return c->feat[y][x] == FEAT_OPEN;
+	return feat_is(c, y, x, FP_OPEN);
 }
 
 /**
  * True if the square is a closed door (possibly locked or jammed).
  */
 bool cave_iscloseddoor(struct cave *c, int y, int x) {
-	int feat = c->feat[y][x];
-	return feat >= FEAT_DOOR_HEAD && feat <= FEAT_DOOR_TAIL;
+	return feat_is(c, y, x, FP_CLOSED);
 }
 
 /**
  * True if the square is a closed, locked door.
  */
 bool cave_islockeddoor(struct cave *c, int y, int x) {
-	int feat = c->feat[y][x];
-	return feat >= FEAT_DOOR_HEAD + 0x01 && feat <= FEAT_DOOR_TAIL;
+	return feat_is(c, y, x, FP_LOCKED);
 }
 
 /**
  * True if the square is a closed, jammed door.
  */
 bool cave_isjammeddoor(struct cave *c, int y, int x) {
-	int feat = c->feat[y][x];
-	return feat >= FEAT_DOOR_HEAD + 0x08 && feat <= FEAT_DOOR_TAIL;
+	return feat_is(c, y, x, FP_JAMMED);
 }
 
 /**
@@ -3765,31 +4349,28 @@ bool cave_isjammeddoor(struct cave *c, int y, int x) {
  * This includes open, closed, and hidden doors.
  */
 bool cave_isdoor(struct cave *c, int y, int x) {
-	return (cave_isopendoor(c, y, x) ||
-			cave_issecretdoor(c, y, x) ||
-			cave_iscloseddoor(cave, y, x));
+	return feat_is(c, y, x, FP_DOOR);
 }
 
 /**
  * True if the square is an unknown trap (it will appear as a floor tile).
  */
 bool cave_issecrettrap(struct cave *c, int y, int x) {
-    return c->feat[y][x] == FEAT_INVIS;
+	return feat_is(c, y, x, FP_INVIS);
 }
 
 /**
  * True if the square is a known trap.
  */
 bool cave_isknowntrap(struct cave *c, int y, int x) {
-	int feat = c->feat[y][x];
-	return feat >= FEAT_TRAP_HEAD && feat <= FEAT_TRAP_TAIL;
+	return feat_is(c, y, x, FP_TRAP);
 }
 
 /**
  * True if the square contains a trap, known or unknown.
  */
 bool cave_istrap(struct cave *c, int y, int x) {
-	return cave_issecrettrap(cave, y, x) || cave_isknowntrap(cave, y, x);
+	return feat_is(c, y, x, FP_INVIS | FP_TRAP);
 }
 
 
@@ -3829,9 +4410,7 @@ bool cave_canputitem(struct cave *c, int y, int x) {
  * True if the square can be dug: this includes rubble and non-permanent walls.
  */
 bool cave_isdiggable(struct cave *c, int y, int x) {
-	return (cave_ismineral(c, y, x) ||
-			cave_issecretdoor(c, y, x) || 
-			cave_isrubble(c, y, x));
+	return feat_is(c, y, x, FP_MINERAL | FP_SECRET | FP_RUBBLE);
 }
 
 /**
@@ -3859,7 +4438,7 @@ bool cave_iswall(struct cave *c, int y, int x) {
  * secret doors and rubble.
  */
 bool cave_isstrongwall(struct cave *c, int y, int x) {
-	return cave_ismineral(c, y, x) || cave_isperm(c, y, x);
+	return feat_is(c, y, x, FP_MINERAL | FP_PERM);
 }
 
 /**
@@ -3914,6 +4493,24 @@ int cave_monster_count(struct cave *c) {
 	return c->mon_cnt;
 }
 
+/**
+ * Get a handle for a monster on the current level, which will not find
+ * another monster once this one has died or been moved by compaction.
+ */
+slot_handle cave_monster_handle(struct cave *c, int idx) {
+	return slots_handle(c->mon_slots, idx);
+}
+
+/**
+ * Get a monster on the current level by its handle, or NULL if it is gone.
+ */
+struct monster *cave_monster_byhandle(struct cave *c, slot_handle h) {
+	int idx = slots_lookup(c->mon_slots, h);
+
+	if (!idx || idx >= c->mon_max) return NULL;
+	return cave_monster(c, idx);
+}
+
 /**
  * Add visible treasure to a mineral square.
  */
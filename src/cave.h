@@ -4,7 +4,9 @@
 #define CAVE_H
 
 #include "defines.h"
+#include "flow.h"
 #include "types.h"
+#include "z-slot.h"
 #include "z-type.h"
 
 struct player;
@@ -24,6 +26,8 @@ extern void do_cmd_view_map(void);
 extern errr vinfo_init(void);
 extern void forget_view(void);
 extern void update_view(void);
+extern int view_delta(const u16b **grids);
+extern int view_verify(void);
 extern void map_area(void);
 extern void wiz_light(void);
 extern void wiz_dark(void);
@@ -31,6 +35,7 @@ extern int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int
 extern bool projectable(int y1, int x1, int y2, int x2, int flg);
 extern void scatter(int *yp, int *xp, int y, int x, int d, int m);
 extern void health_track(struct player *p, struct monster *m_ptr);
+extern struct monster *health_tracked(struct player *p);
 extern void monster_race_track(int r_idx);
 extern void track_object(int item);
 extern void track_object_kind(int k_idx);
@@ -39,6 +44,17 @@ extern void disturb(struct player *p, int stop_search, int unused_flag);
 extern bool is_quest(int level);
 extern bool dtrap_edge(int y, int x);
 
+/*
+ * Words in each row of a bit-plane, which holds one bit for each square
+ */
+#define CAVE_PLANE_WORDS	((DUNGEON_WID + 31) / 32)
+
+/*
+ * Width of the rows of info[] and info2[], whatever the size of the level,
+ * so that the view code can step between squares with GRID().
+ */
+#define CAVE_INFO_WID	256
+
 struct cave {
 	s32b created_at;
 	int depth;
@@ -53,30 +69,53 @@ struct cave {
 	
 	u16b feeling_squares; /* Keep track of how many feeling squares the player has visited */
 
-	byte (*info)[256];
-	byte (*info2)[256];
-	byte (*feat)[DUNGEON_WID];
-	byte (*cost)[DUNGEON_WID];
-	byte (*when)[DUNGEON_WID];
-	s16b (*m_idx)[DUNGEON_WID];
-	s16b (*o_idx)[DUNGEON_WID];
+	/* Planes of height rows each, see cave_set_dimensions() */
+	byte **info;
+	byte **info2;
+	byte **feat;
+	s16b **m_idx;
+	s16b **o_idx;
+
+	u32b **wall_plane; /* CAVE_WALL, see cave_note_wall() */
+	u32b wall_serial; /* Bumped whenever a CAVE_WALL flag may have changed */
+	struct proj_cache *proj; /* See projectable() */
+
+	u16b *empty; /* The empty squares, in no order; see cave_note_empty() */
+	s16b *empty_pos; /* Where each square is in empty[], or -1 */
+	int empty_n;
 
 	struct monster *monsters;
 	int mon_max;
 	int mon_cnt;
+	struct slot_list *mon_slots; /* Free monster slots, see mon_pop() */
+	struct mon_sched *mon_sched;
+	struct mon_spatial *mon_spatial;
+
+	struct flow_field *flow[FLOW_MAX];
 };
 
 /* XXX: temporary while I refactor */
 extern struct cave *cave;
 
+/**
+ * How update_view() recomputes the field of view.
+ */
+enum {
+	VIEW_FULL = 0,		/* Rescan every octant on every update */
+	VIEW_INCREMENTAL,	/* Rescan only the octants that may have changed */
+	VIEW_VERIFY		/* Incremental, checked against a full rescan */
+};
+
+extern int view_mode;
+
 extern struct cave *cave_new(void);
 extern void cave_free(struct cave *c);
+extern void cave_set_dimensions(struct cave *c, int h, int w);
 
 extern void cave_set_feat(struct cave *c, int y, int x, int feat);
 extern void cave_note_spot(struct cave *c, int y, int x);
+extern void cave_note_view_change(struct cave *c, int y, int x);
 extern void cave_light_spot(struct cave *c, int y, int x);
-extern void cave_update_flow(struct cave *c);
-extern void cave_forget_flow(struct cave *c);
 extern void cave_illuminate(struct cave *c, bool daytime);
 
 /**
@@ -116,6 +155,20 @@ extern bool cave_isrubble(struct cave *c, int y, int x);
 extern bool cave_isfeel(struct cave *c, int y, int x);
 
 extern void cave_generate(struct cave *c, struct player *p);
+extern void cave_generate_seed(struct cave *c, struct player *p, u32b seed);
+extern u32b cave_next_seed(struct cave *c, int depth);
+extern bool cave_generate_next(struct cave *c, struct player *p);
+extern bool cave_pregen(struct player *p);
+extern void cave_pregen_forget(void);
+
+extern void cave_wipe(struct cave *c);
+extern void cave_note_wall(struct cave *c, int y, int x);
+extern int cave_count_walls(struct cave *c, int y1, int x1, int y2, int x2);
+extern void cave_note_empty(struct cave *c, int y, int x);
+extern void cave_reset_empty(struct cave *c);
+extern bool cave_pick_empty(struct cave *c, int *y, int *x);
+extern int cave_find_empty(struct cave *c, int *y, int *x,
+	cave_predicate pred);
 
 extern bool cave_in_bounds(struct cave *c, int y, int x);
 extern bool cave_in_bounds_fully(struct cave *c, int y, int x);
@@ -124,6 +177,8 @@ extern struct monster *cave_monster(struct cave *c, int idx);
 extern struct monster *cave_monster_at(struct cave *c, int y, int x);
 extern int cave_monster_max(struct cave *c);
 extern int cave_monster_count(struct cave *c);
+extern slot_handle cave_monster_handle(struct cave *c, int idx);
+extern struct monster *cave_monster_byhandle(struct cave *c, slot_handle h);
 
 void upgrade_mineral(struct cave *c, int y, int x);
 
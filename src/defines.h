@@ -674,6 +674,8 @@ enum
 
 #define pf_has(f, flag)        flag_has_dbg(f, PF_SIZE, flag, #f, #flag)
 #define pf_next(f, flag)       flag_next(f, PF_SIZE, flag)
+#define pf_count(f)            flag_count(f, PF_SIZE)
+#define pf_list(f, list)       flag_list(f, PF_SIZE, list)
 #define pf_is_empty(f)         flag_is_empty(f, PF_SIZE)
 #define pf_is_full(f)          flag_is_full(f, PF_SIZE)
 #define pf_is_inter(f1, f2)    flag_is_inter(f1, f2, PF_SIZE)
@@ -754,11 +756,12 @@ enum
 
 
 /*
- * Determines if a map location is "meaningful"
+ * Determines if a map location is "meaningful", that is, on the current
+ * level (which needs "cave.h")
  */
 #define in_bounds(Y,X) \
-	(((unsigned)(Y) < (unsigned)(DUNGEON_HGT)) && \
-	 ((unsigned)(X) < (unsigned)(DUNGEON_WID)))
+	(((unsigned)(Y) < (unsigned)(cave->height)) && \
+	 ((unsigned)(X) < (unsigned)(cave->width)))
 
 /*
  * Determines if a map location is fully inside the outer walls
@@ -766,8 +769,8 @@ enum
  * often we need to exclude the outer walls from calculations.
  */
 #define in_bounds_fully(Y,X) \
-	(((Y) > 0) && ((Y) < DUNGEON_HGT-1) && \
-	 ((X) > 0) && ((X) < DUNGEON_WID-1))
+	(((Y) > 0) && ((Y) < cave->height-1) && \
+	 ((X) > 0) && ((X) < cave->width-1))
 
 /*
  * Determine if a "legal" grid is a "floor" grid
@@ -223,7 +223,7 @@ static void regen_monsters(void)
 			if (m_ptr->hp > m_ptr->maxhp) m_ptr->hp = m_ptr->maxhp;
 
 			/* Redraw (later) if needed */
-			if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+			if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 		}
 	}
 }
@@ -1253,13 +1253,21 @@ static void do_animation(void)
 
 
 /*
- * This is used when the user is idle to allow for simple animations.
- * Currently the only thing it really does is animate shimmering monsters.
+ * This is used when the user is idle to allow for simple animations, and
+ * to make the next levels ahead of time while the game waits for a command.
  */
 void idle_update(void)
 {
 	if (!character_dungeon) return;
 
+	/* Make a level, and mend the map it was drawn over */
+	if (OPT(pregen_levels) && inkey_flag && !character_icky &&
+			cave_pregen(p_ptr)) {
+		p_ptr->redraw |= (PR_MAP);
+		redraw_stuff(p_ptr);
+		Term_fresh();
+	}
+
 	if (!OPT(animate_flicker)) return;
 
 	/* Animate and redraw if necessary */
@@ -1279,11 +1287,6 @@ void idle_update(void)
  */
 static void dungeon(struct cave *c)
 {
-	monster_type *m_ptr;
-	int i;
-
-
-
 	/* Hack -- enforce illegal panel */
 	Term->offset_y = DUNGEON_HGT;
 	Term->offset_x = DUNGEON_WID;
@@ -1426,15 +1429,9 @@ static void dungeon(struct cave *c)
 		/* Hack -- Compact the monster list occasionally */
 		if (cave_monster_count(cave) + 32 > z_info->m_max) compact_monsters(64);
 
-		/* Hack -- Compress the monster list occasionally */
-		if (cave_monster_count(cave) + 32 < cave_monster_max(cave)) compact_monsters(0);
-
 		/* Hack -- Compact the object list occasionally */
 		if (o_cnt + 32 > z_info->o_max) compact_objects(64);
 
-		/* Hack -- Compress the object list occasionally */
-		if (o_cnt + 32 < o_max) compact_objects(0);
-
 		/* Can the player move? */
 		while ((p_ptr->energy >= 100) && !p_ptr->leaving)
 		{
@@ -1514,27 +1511,7 @@ static void dungeon(struct cave *c)
 		/* Give the player some energy */
 		p_ptr->energy += extract_energy[p_ptr->state.speed];
 
-		/* Give energy to all monsters */
-		for (i = cave_monster_max(cave) - 1; i >= 1; i--)
-		{
-			int mspeed;
-			
-			/* Access the monster */
-			m_ptr = cave_monster(cave, i);
-
-			/* Ignore "dead" monsters */
-			if (!m_ptr->r_idx) continue;
-
-			/* Calculate the net speed */
-			mspeed = m_ptr->mspeed;
-			if (m_ptr->m_timed[MON_TMD_FAST])
-				mspeed += 10;
-			if (m_ptr->m_timed[MON_TMD_SLOW])
-				mspeed -= 10;
-
-			/* Give this monster some energy */
-			m_ptr->energy += extract_energy[mspeed];
-		}
+		/* Monsters gain energy as game turns pass (see mon-sched.c) */
 
 		/* Count game turns */
 		turn++;
@@ -1740,7 +1717,7 @@ void play_game(void)
 
 	/* Generate a dungeon level if needed */
 	if (!character_dungeon)
-		cave_generate(cave, p_ptr);
+		cave_generate_next(cave, p_ptr);
 
 
 	/* Character is now "complete" */
@@ -1865,7 +1842,7 @@ void play_game(void)
 		if (p_ptr->is_dead) break;
 
 		/* Make a new level */
-		cave_generate(cave, p_ptr);
+		cave_generate_next(cave, p_ptr);
 	}
 
 	/* Disallow big cursor */
@@ -0,0 +1,432 @@
+/*
+ * File: flow.c
+ * Purpose: Distance fields used by monster pathing
+ *
+ * Copyright (c) 1997 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "flow.h"
+#include "monster/constants.h"
+
+/*
+ * A distance field holds, for every grid, the number of steps to the
+ * nearest of its sources, found by a breadth-first flood which passes
+ * through anything but walls and rubble.
+ *
+ * Every update of a field has a serial number, and each grid remembers the
+ * serial ("stamp") and distance of the last update which reached it.  So
+ * grids with the current serial are part of the field, while grids which
+ * the field used to reach keep an older stamp along with the distance they
+ * had at the time.  For the player noise field this history is the scent
+ * which monsters follow when "birth_ai_smell" is on.  Stamps are 32 bits,
+ * so they never need to be cycled, and the flood queue can hold every grid
+ * of the level, so no grid is ever dropped.
+ *
+ * Forgetting a field just moves the "forget" horizon up, so that older
+ * stamps read as never having been reached, rather than clearing the level.
+ */
+
+/*
+ * Maximum number of terrain changes remembered between updates
+ */
+#define FLOW_NOTE_MAX 32
+
+struct flow_field {
+	u16b *dist;
+	u32b *stamp;
+	u16b *queue;
+
+	u32b serial;
+	u32b forget;
+
+	/* Grids are reached if they are less than this many steps away */
+	int depth;
+
+	/* The current grids are up to date */
+	bool valid;
+
+	/* A forget was requested, to be applied by the next update */
+	bool forget_pending;
+
+	/* Source of a single-source field */
+	int sy, sx;
+
+	/* Grids whose passability changed since the last update */
+	u16b notes[FLOW_NOTE_MAX];
+	int note_n;
+};
+
+/*
+ * Stale grids are forgotten after this many updates
+ */
+#define FLOW_SCENT_AGE 128
+
+#define FLOW_GRID(Y,X)	((Y) * DUNGEON_WID + (X))
+
+/*
+ * Whether a flood can pass through a grid
+ */
+static bool flow_passable(struct cave *c, int y, int x)
+{
+	return c->feat[y][x] < FEAT_RUBBLE;
+}
+
+
+/*
+ * Make a new distance field, reaching grids less than "depth" steps away
+ */
+struct flow_field *flow_new(int depth)
+{
+	struct flow_field *f = ZNEW(struct flow_field);
+
+	f->dist = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u16b);
+	f->stamp = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u32b);
+	f->queue = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u16b);
+	f->depth = depth;
+
+	return f;
+}
+
+void flow_free(struct flow_field *f)
+{
+	FREE(f->dist);
+	FREE(f->stamp);
+	FREE(f->queue);
+	FREE(f);
+}
+
+
+/*
+ * Flood outwards from the grids already in the queue, which must all be
+ * stamped with the current serial and sorted by distance.  Grids are only
+ * ever added with a shorter distance than they had, so this both builds a
+ * field from scratch and repairs one after a grid becomes passable.
+ */
+static void flow_spread(struct cave *c, struct flow_field *f, int head,
+		int tail)
+{
+	while (head != tail)
+	{
+		int g = f->queue[head++];
+		int ty = g / DUNGEON_WID;
+		int tx = g % DUNGEON_WID;
+		int n = f->dist[g] + 1;
+		int d;
+
+		/* Limit flow depth */
+		if (n >= f->depth) continue;
+
+		/* Add the "children" */
+		for (d = 0; d < 8; d++)
+		{
+			int y = ty + ddy_ddd[d];
+			int x = tx + ddx_ddd[d];
+			int cg = FLOW_GRID(y, x);
+
+			if (y < 0 || y >= c->height || x < 0 || x >= c->width)
+				continue;
+
+			/* Ignore grids which are already as close */
+			if (f->stamp[cg] == f->serial && f->dist[cg] <= n) continue;
+
+			/* Ignore "walls" and "rubble" */
+			if (!flow_passable(c, y, x)) continue;
+
+			f->stamp[cg] = f->serial;
+			f->dist[cg] = n;
+			f->queue[tail++] = cg;
+		}
+	}
+}
+
+
+/*
+ * Start a new update of the field, from the given sources
+ */
+static void flow_flood(struct cave *c, struct flow_field *f,
+		const u16b *sources, int n)
+{
+	int i, tail = 0;
+
+	/* Apply a pending forget to everything we have so far */
+	if (f->forget_pending)
+	{
+		f->forget = f->serial;
+		f->forget_pending = FALSE;
+	}
+
+	f->serial++;
+	f->note_n = 0;
+	f->valid = TRUE;
+
+	for (i = 0; i < n; i++)
+	{
+		int g = sources[i];
+
+		if (f->stamp[g] == f->serial) continue;
+
+		f->stamp[g] = f->serial;
+		f->dist[g] = 0;
+		f->queue[tail++] = g;
+	}
+
+	flow_spread(c, f, 0, tail);
+}
+
+
+/*
+ * Bring a field up to date after a grid became passable, by letting the
+ * field spread into it from its neighbours.
+ */
+static void flow_repair(struct cave *c, struct flow_field *f, int g)
+{
+	int y = g / DUNGEON_WID;
+	int x = g % DUNGEON_WID;
+	int d, best = -1;
+
+	/* Already part of the field */
+	if (f->stamp[g] == f->serial) return;
+
+	for (d = 0; d < 8; d++)
+	{
+		int yy = y + ddy_ddd[d];
+		int xx = x + ddx_ddd[d];
+		int cg = FLOW_GRID(yy, xx);
+
+		if (yy < 0 || yy >= c->height || xx < 0 || xx >= c->width)
+			continue;
+
+		if (f->stamp[cg] != f->serial) continue;
+		if (best < 0 || f->dist[cg] < best) best = f->dist[cg];
+	}
+
+	/* Out of reach */
+	if (best < 0 || best + 1 >= f->depth) return;
+
+	f->stamp[g] = f->serial;
+	f->dist[g] = best + 1;
+	f->queue[0] = g;
+	flow_spread(c, f, 0, 1);
+}
+
+
+/*
+ * Apply the terrain changes noted since the last update.  Returns FALSE if
+ * the field must be rebuilt from scratch instead.
+ */
+static bool flow_apply_notes(struct cave *c, struct flow_field *f)
+{
+	int i;
+
+	if (!f->valid || f->note_n > FLOW_NOTE_MAX) return FALSE;
+
+	/* A grid in the field became impassable, so distances may grow */
+	for (i = 0; i < f->note_n; i++)
+	{
+		int g = f->notes[i];
+
+		if (f->stamp[g] == f->serial &&
+				!flow_passable(c, g / DUNGEON_WID, g % DUNGEON_WID))
+			return FALSE;
+	}
+
+	/* Grids which became passable can only bring others closer */
+	for (i = 0; i < f->note_n; i++)
+	{
+		int g = f->notes[i];
+
+		if (flow_passable(c, g / DUNGEON_WID, g % DUNGEON_WID))
+			flow_repair(c, f, g);
+	}
+
+	f->note_n = 0;
+	return TRUE;
+}
+
+
+/*
+ * Fill in the player noise field, with the number of steps needed to reach
+ * each grid the player can reach within MONSTER_FLOW_DEPTH steps.
+ *
+ * If the player has not moved, the field is only repaired for the terrain
+ * which changed since the last update.  A one-step move changes almost every
+ * distance in the field by one, so it is rebuilt, which costs a flood of
+ * the area around the player and nothing proportional to the whole level.
+ */
+void cave_update_flow(struct cave *c)
+{
+	struct flow_field *f = c->flow[FLOW_NOISE];
+	u16b source = FLOW_GRID(p_ptr->py, p_ptr->px);
+
+	if (f->valid && f->sy == p_ptr->py && f->sx == p_ptr->px &&
+			flow_apply_notes(c, f))
+	{
+		/* Forget everything but the current field */
+		if (f->forget_pending)
+		{
+			f->forget = f->serial - 1;
+			f->forget_pending = FALSE;
+		}
+
+		return;
+	}
+
+	f->sy = p_ptr->py;
+	f->sx = p_ptr->px;
+	flow_flood(c, f, &source, 1);
+}
+
+
+/*
+ * Fill in the stairs field, which is only done when it is asked for
+ */
+static void cave_update_stairs_flow(struct cave *c)
+{
+	struct flow_field *f = c->flow[FLOW_STAIRS];
+	u16b *sources;
+	int y, x, n = 0;
+
+	if (flow_apply_notes(c, f)) return;
+
+	sources = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, u16b);
+
+	for (y = 0; y < c->height; y++)
+	{
+		for (x = 0; x < c->width; x++)
+		{
+			if (c->feat[y][x] == FEAT_LESS || c->feat[y][x] == FEAT_MORE)
+				sources[n++] = FLOW_GRID(y, x);
+		}
+	}
+
+	flow_flood(c, f, sources, n);
+	FREE(sources);
+}
+
+
+/*
+ * Forget the "flow" information, both the current field and the history
+ * of where the player has been.
+ */
+void cave_forget_flow(struct cave *c)
+{
+	c->flow[FLOW_NOISE]->forget_pending = TRUE;
+}
+
+
+/*
+ * Forget every field completely, as when the level is cleared
+ */
+void cave_reset_flow(struct cave *c)
+{
+	int i;
+
+	for (i = 0; i < FLOW_MAX; i++)
+	{
+		struct flow_field *f = c->flow[i];
+
+		f->forget = f->serial;
+		f->forget_pending = FALSE;
+		f->valid = FALSE;
+		f->note_n = 0;
+	}
+}
+
+
+/*
+ * Note that a grid may have become passable or impassable
+ */
+void cave_note_flow_change(struct cave *c, int y, int x)
+{
+	int i;
+
+	for (i = 0; i < FLOW_MAX; i++)
+	{
+		struct flow_field *f = c->flow[i];
+
+		if (!f->valid) continue;
+
+		/* Any change to the stairs themselves needs a new flood */
+		if (i == FLOW_STAIRS &&
+				((c->feat[y][x] == FEAT_LESS || c->feat[y][x] == FEAT_MORE) ||
+				 (f->stamp[FLOW_GRID(y, x)] == f->serial &&
+				  f->dist[FLOW_GRID(y, x)] == 0)))
+			f->valid = FALSE;
+
+		/* Too many changes, so just flood again */
+		else if (f->note_n == FLOW_NOTE_MAX)
+			f->note_n++;
+
+		else if (f->note_n < FLOW_NOTE_MAX)
+			f->notes[f->note_n++] = FLOW_GRID(y, x);
+	}
+}
+
+
+static struct flow_field *flow_get(struct cave *c, int field)
+{
+	struct flow_field *f = c->flow[field];
+
+	/* The stairs field is brought up to date on demand */
+	if (field == FLOW_STAIRS && (!f->valid || f->note_n))
+		cave_update_stairs_flow(c);
+
+	return f;
+}
+
+
+/*
+ * The serial of the last update which reached a grid, or zero if the grid
+ * was never reached or has been forgotten.  Larger is more recent.
+ */
+u32b flow_when(struct cave *c, int field, int y, int x)
+{
+	struct flow_field *f = flow_get(c, field);
+	u32b s = f->stamp[FLOW_GRID(y, x)];
+
+	if (s <= f->forget) return 0;
+	if (f->serial - s >= FLOW_SCENT_AGE) return 0;
+
+	return s;
+}
+
+
+/*
+ * The distance of a grid from the field's sources, as of the last update
+ * which reached it.  Only meaningful if flow_when() is not zero.
+ */
+int flow_cost(struct cave *c, int field, int y, int x)
+{
+	struct flow_field *f = flow_get(c, field);
+
+	return f->dist[FLOW_GRID(y, x)];
+}
+
+
+/*
+ * The distance of a grid from the field's sources, or -1 if the latest
+ * update of the field did not reach it.
+ */
+int flow_dist(struct cave *c, int field, int y, int x)
+{
+	struct flow_field *f = flow_get(c, field);
+	int g = FLOW_GRID(y, x);
+
+	if (!f->valid || f->stamp[g] != f->serial || f->serial <= f->forget)
+		return -1;
+
+	return f->dist[g];
+}
@@ -0,0 +1,33 @@
+/* flow.h - distance field interface */
+
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "h-basic.h"
+
+struct cave;
+
+/**
+ * The distance fields kept on each cave.
+ */
+enum {
+	FLOW_NOISE = 0,		/* Steps to the player */
+	FLOW_STAIRS,		/* Steps to the nearest staircase */
+	FLOW_MAX
+};
+
+struct flow_field;
+
+extern struct flow_field *flow_new(int depth);
+extern void flow_free(struct flow_field *f);
+
+extern void cave_update_flow(struct cave *c);
+extern void cave_forget_flow(struct cave *c);
+extern void cave_reset_flow(struct cave *c);
+extern void cave_note_flow_change(struct cave *c, int y, int x);
+
+extern u32b flow_when(struct cave *c, int field, int y, int x);
+extern int flow_cost(struct cave *c, int field, int y, int x);
+extern int flow_dist(struct cave *c, int field, int y, int x);
+
+#endif /* !FLOW_H */
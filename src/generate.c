@@ -23,42 +23,39 @@
 #include "files.h"
 #include "generate.h"
 #include "monster/mon-make.h"
+#include "monster/mon-sched.h"
 #include "monster/mon-spell.h"
 #include "object/tvalsval.h"
+#include "target.h"
 #include "trap.h"
-#include "z-queue.h"
 #include "z-type.h"
 
-/**
- * This is the global structure representing dungeon generation info.
- */
-static struct dun_data *dun;
-
-/**
- * This is a global array of positions in the cave we're currently
- * generating. It's used to quickly randomize all the current cave positions.
- */
-static int *cave_squares = NULL;
-
-static bool town_gen(struct cave *c, struct player *p);
-
-static bool default_gen(struct cave *c, struct player *p);
-static bool labyrinth_gen(struct cave *c, struct player *p);
-static bool cavern_gen(struct cave *c, struct player *p);
-
-static bool build_simple(struct cave *c, int y0, int x0);
-static bool build_circular(struct cave *c, int y0, int x0);
-static bool build_overlap(struct cave *c, int y0, int x0);
-static bool build_crossed(struct cave *c, int y0, int x0);
-static bool build_large(struct cave *c, int y0, int x0);
-static bool build_nest(struct cave *c, int y0, int x0);
-static bool build_pit(struct cave *c, int y0, int x0);
-static bool build_lesser_vault(struct cave *c, int y0, int x0);
-static bool build_medium_vault(struct cave *c, int y0, int x0);
-static bool build_greater_vault(struct cave *c, int y0, int x0);
-
-static void alloc_objects(struct cave *c, int set, int typ, int num, int depth, byte origin);
-static bool alloc_object(struct cave *c, int set, int typ, int depth, byte origin);
+static bool town_gen(struct dun_data *dun, struct cave *c, struct player *p);
+
+static bool default_gen(struct dun_data *dun, struct cave *c, struct player *p);
+static bool labyrinth_gen(struct dun_data *dun, struct cave *c,
+	struct player *p);
+static bool cavern_gen(struct dun_data *dun, struct cave *c, struct player *p);
+
+static bool build_simple(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_circular(struct dun_data *dun, struct cave *c,
+	int y0, int x0);
+static bool build_overlap(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_crossed(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_large(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_nest(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_pit(struct dun_data *dun, struct cave *c, int y0, int x0);
+static bool build_lesser_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0);
+static bool build_medium_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0);
+static bool build_greater_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0);
+
+static void alloc_objects(struct dun_data *dun, struct cave *c,
+	int set, int typ, int num, int depth, byte origin);
+static bool alloc_object(struct dun_data *dun, struct cave *c,
+	int set, int typ, int depth, byte origin);
 
 #if  __STDC_VERSION__ < 199901L
 #define ROOM_DEBUG if (0) msg;
@@ -186,9 +183,46 @@ struct dun_data {
 
 	/* Hack -- there is a pit/nest on this level */
 	bool crowded;
+
+	/* Where to count what generation does, or NULL */
+	struct gen_stats *stats;
 };
 
 
+/**
+ * If set, the statistics which level generation adds to.
+ */
+struct gen_stats *gen_stats = NULL;
+
+/**
+ * The processor time, in seconds, for timing generation.
+ */
+static double gen_clock(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/**
+ * Find the entry for a builder in a list of builder statistics, adding it if
+ * there is room.  Builders are told apart by their name pointers.
+ */
+static struct gen_builder_stats *gen_builder_entry(
+	struct gen_builder_stats *list, const char *name)
+{
+	int i;
+
+	for (i = 0; i < GEN_STATS_BUILDERS; i++) {
+		if (list[i].name == name) return &list[i];
+		if (list[i].name) continue;
+
+		list[i].name = name;
+		return &list[i];
+	}
+
+	return NULL;
+}
+
+
 /**
  * Profile used for generating the town level.
  */
@@ -305,17 +339,18 @@ static void shuffle(int *arr, int n)
 /**
  * Locate a square in y1 <= y < y2, x1 <= x < x2 which satisfies the given
  * predicate.
+ *
+ * Returns the number of squares tested to find one, or 0 if none was found.
  */
-static bool _find_in_range(struct cave *c, int *y, int y1, int y2, int *x,
+static int _find_in_range(struct cave *c, int *y, int y1, int y2, int *x,
 	int x1, int x2, int *squares, cave_predicate pred)
 {
 	int yd = y2 - y1;
 	int xd = x2 - x1;
 	int i, n = yd * xd;
-	bool found = FALSE;
 
 	/* Test each square in (random) order for openness */
-	for (i = 0; i < n && !found; i++) {
+	for (i = 0; i < n; i++) {
 		int j = randint0(n - i) + i;
 		int k = squares[j];
 		squares[j] = squares[i];
@@ -323,22 +358,11 @@ static bool _find_in_range(struct cave *c, int *y, int y1, int y2, int *x,
 
 		*y = (k / xd) + y1;
 		*x = (k % xd) + x1;
-		if (pred(c, *y, *x)) found = TRUE;
+		if (pred(c, *y, *x)) return i + 1;
 	}
 
-	/* Return whether we found an empty square or not. */
-	return found;
-}
-
-
-/**
- * Locate a square in the dungeon which satisfies the given predicate.
- */
-static bool cave_find(struct cave *c, int *y, int *x, cave_predicate pred)
-{
-	int h = c->height;
-	int w = c->width;
-	return _find_in_range(c, y, 0, h, x, 0, w, cave_squares, pred);
+	/* We didn't find a square */
+	return 0;
 }
 
 
@@ -359,7 +383,7 @@ static bool cave_find_in_range(struct cave *c, int *y, int y1, int y2,
 	for (i = 0; i < n; i++) squares[i] = i;
 
 	/* Do the actual search */
-	found = _find_in_range(c, y, y1, y2, x, x1, x2, squares, pred);
+	found = _find_in_range(c, y, y1, y2, x, x1, x2, squares, pred) > 0;
 
 	/* Deallocate memory */
 	FREE(squares);
@@ -370,11 +394,19 @@ static bool cave_find_in_range(struct cave *c, int *y, int y1, int y2,
 
 
 /**
- * Locate an empty square for 0 <= y < ymax, 0 <= x < xmax.
+ * Pick an empty square anywhere in the dungeon.
  */
-static bool find_empty(struct cave *c, int *y, int *x)
+static bool find_empty(struct dun_data *dun, struct cave *c, int *y, int *x)
 {
-	return cave_find(c, y, x, cave_isempty);
+	bool found = cave_pick_empty(c, y, x);
+
+	if (dun->stats) {
+		dun->stats->find_calls++;
+		if (found) dun->stats->find_probes++;
+		else dun->stats->find_fails++;
+	}
+
+	return found;
 }
 
 
@@ -443,15 +475,24 @@ static bool cave_isstart(struct cave *c, int y, int x)
 }
 
 
+/**
+ * Determine whether the given coordinate is outside any room.
+ */
+static bool cave_iscorridor(struct cave *c, int y, int x)
+{
+	return !cave_isroom(c, y, x);
+}
+
+
 /**
  * Place the player at a random starting location.
  */
 static void new_player_spot(struct cave *c, struct player *p)
 {
-	int y, x;
+	int y = 0, x = 0;
 
 	/* Try to find a good place to put the player */
-	cave_find_in_range(c, &y, 0, c->height, &x, 0, c->width, cave_isstart);
+	cave_find_empty(c, &y, &x, cave_isstart);
 
 	/* Create stairs the player came down if allowed and necessary */
 	if (OPT(birth_no_stairs)) {
@@ -621,6 +662,177 @@ void place_random_door(struct cave *c, int y, int x)
 }
 
 
+/*
+ * A vault compiled from its text, so that placing it is a few copies and
+ * a walk over the squares which need something random put on them.  The
+ * terrain is kept as runs of non-blank squares, one or more per row.
+ */
+struct vault_run {
+	byte dy, dx, len;
+};
+
+struct vault_spawn {
+	byte dy, dx;
+	char glyph;
+};
+
+struct vault_plan {
+	byte *feat; /* Terrain of each square, row by row */
+	byte *info; /* CAVE_ROOM, CAVE_ICKY and CAVE_WALL of each square */
+
+	struct vault_run *runs;
+	int num_runs;
+
+	struct vault_spawn *treasure; /* Squares of treasure or a trap */
+	int num_treasure;
+
+	struct vault_spawn *spawns; /* Squares of monsters and their loot */
+	int num_spawns;
+};
+
+/* Vaults by type, those of type t at vault_index[vault_first[t]] onward */
+static struct vault **vault_index;
+static int vault_first[257];
+
+
+/**
+ * Terrain for a vault square; secret doors and traps are fixed features,
+ * and the squares which get treasure or monsters start as floor.
+ */
+static int vault_feat(char glyph)
+{
+	switch (glyph) {
+		case '%': return FEAT_WALL_OUTER;
+		case '#': return FEAT_WALL_INNER;
+		case 'X': return FEAT_PERM_INNER;
+		case '+': return FEAT_SECRET;
+		case '^': return FEAT_INVIS;
+		default: return FEAT_FLOOR;
+	}
+}
+
+
+/**
+ * Compile the text of a vault into its plan.
+ */
+static struct vault_plan *vault_compile(const struct vault *v)
+{
+	struct vault_plan *plan = mem_zalloc(sizeof(*plan));
+	const char *t;
+	int dy, dx, i;
+
+	/* Count everything first, so each list is allocated once */
+	for (t = v->text, dy = 0; dy < v->hgt && *t; dy++) {
+		for (dx = 0; dx < v->wid && *t; dx++, t++) {
+			if (*t == ' ') continue;
+
+			if (dx == 0 || t[-1] == ' ') plan->num_runs++;
+			if (*t == '*') plan->num_treasure++;
+			if (strchr("&@98,", *t)) plan->num_spawns++;
+		}
+	}
+
+	plan->feat = mem_zalloc(v->hgt * v->wid);
+	plan->info = mem_zalloc(v->hgt * v->wid);
+	plan->runs = mem_zalloc(plan->num_runs * sizeof(*plan->runs));
+	plan->treasure = mem_zalloc(plan->num_treasure * sizeof(*plan->treasure));
+	plan->spawns = mem_zalloc(plan->num_spawns * sizeof(*plan->spawns));
+	plan->num_runs = plan->num_treasure = plan->num_spawns = 0;
+
+	for (t = v->text, dy = 0; dy < v->hgt && *t; dy++) {
+		for (dx = 0; dx < v->wid && *t; dx++, t++) {
+			struct vault_spawn *s = NULL;
+
+			if (*t == ' ') continue;
+
+			/* Start a new run, or lengthen the one on the left */
+			if (dx == 0 || t[-1] == ' ') {
+				struct vault_run *r = &plan->runs[plan->num_runs++];
+
+				r->dy = dy;
+				r->dx = dx;
+			}
+			plan->runs[plan->num_runs - 1].len++;
+
+			i = dy * v->wid + dx;
+			plan->feat[i] = vault_feat(*t);
+
+			/* The "door step" of '%' may be tunnelled through, so isn't icky */
+			plan->info[i] = CAVE_ROOM;
+			if (*t != '%') plan->info[i] |= CAVE_ICKY;
+			if (plan->feat[i] >= FEAT_DOOR_HEAD) plan->info[i] |= CAVE_WALL;
+
+			if (*t == '*')
+				s = &plan->treasure[plan->num_treasure++];
+			else if (strchr("&@98,", *t))
+				s = &plan->spawns[plan->num_spawns++];
+
+			if (s) {
+				s->dy = dy;
+				s->dx = dx;
+				s->glyph = *t;
+			}
+		}
+	}
+
+	return plan;
+}
+
+
+static void vault_plan_free(struct vault_plan *plan)
+{
+	if (!plan) return;
+
+	mem_free(plan->feat);
+	mem_free(plan->info);
+	mem_free(plan->runs);
+	mem_free(plan->treasure);
+	mem_free(plan->spawns);
+	mem_free(plan);
+}
+
+
+/**
+ * Compile every vault, and index them by type for random_vault().
+ */
+void vault_plans_init(void)
+{
+	struct vault *v;
+	int count[257] = { 0 };
+	int n = 0, t;
+
+	vault_plans_free();
+
+	for (v = vaults; v; v = v->next) {
+		v->plan = vault_compile(v);
+		count[v->typ]++;
+		n++;
+	}
+
+	/* Keep the vaults of each type in the order of the list */
+	for (t = 0; t < 256; t++)
+		vault_first[t + 1] = vault_first[t] + count[t];
+
+	vault_index = C_ZNEW(n + 1, struct vault *);
+	for (v = vaults; v; v = v->next)
+		vault_index[vault_first[v->typ + 1] - count[v->typ]--] = v;
+}
+
+
+void vault_plans_free(void)
+{
+	struct vault *v;
+
+	for (v = vaults; v; v = v->next) {
+		vault_plan_free(v->plan);
+		v->plan = NULL;
+	}
+
+	FREE(vault_index);
+	memset(vault_first, 0, sizeof(vault_first));
+}
+
+
 /**
  * Chooses a vault of a particular kind at random.
  * 
@@ -630,24 +842,22 @@ void place_random_door(struct cave *c, int y, int x)
  */
 struct vault *random_vault(int typ)
 {
-	struct vault *v = vaults;
-	struct vault *r = NULL;
-	int n = 1;
-	do {
-		if (v->typ == typ) {
-			if (one_in_(n)) r = v;
-			n++;
-		}
-		v = v->next;
-	} while(v);
-	return r;
+	int n;
+
+	if (typ < 0 || typ > 255) return NULL;
+
+	n = vault_first[typ + 1] - vault_first[typ];
+	if (!n) return NULL;
+
+	return vault_index[vault_first[typ] + randint0(n)];
 }
 
 
 /**
  * Place some staircases near walls.
  */
-static void alloc_stairs(struct cave *c, int feat, int num, int walls)
+static void alloc_stairs(struct dun_data *dun, struct cave *c,
+	int feat, int num, int walls)
 {
 	int y, x, i, j, done;
 
@@ -657,7 +867,8 @@ static void alloc_stairs(struct cave *c, int feat, int num, int walls)
 		for (done = FALSE; !done; ) {
 			/* Try several times, then decrease "walls" */
 			for (j = 0; !done && j <= 1000; j++) {
-				find_empty(c, &y, &x);
+				/* Give up if there is nowhere at all */
+				if (!find_empty(dun, c, &y, &x)) return;
 
 				if (next_to_walls(c, y, x) < walls) continue;
 
@@ -677,11 +888,12 @@ static void alloc_stairs(struct cave *c, int feat, int num, int walls)
  *
  * See alloc_object() for more information.
  */
-static void alloc_objects(struct cave *c, int set, int typ, int num, int depth, byte origin)
+static void alloc_objects(struct dun_data *dun, struct cave *c,
+	int set, int typ, int num, int depth, byte origin)
 {
 	int k, l = 0;
 	for (k = 0; k < num; k++) {
-		bool ok = alloc_object(c, set, typ, depth, origin);
+		bool ok = alloc_object(dun, c, set, typ, depth, origin);
 		if (!ok) l++;
 	}
 }
@@ -693,29 +905,28 @@ static void alloc_objects(struct cave *c, int set, int typ, int num, int depth,
  * 'set' controls where the object is placed (corridor, room, either).
  * 'typ' conrols the kind of object (rubble, trap, gold, item).
  */
-static bool alloc_object(struct cave *c, int set, int typ, int depth, byte origin)
+static bool alloc_object(struct dun_data *dun, struct cave *c,
+	int set, int typ, int depth, byte origin)
 {
 	int x, y;
-	int tries = 0;
-	bool room;
-
-	/* Pick a "legal" spot */
-	while (tries < 2000) {
-		tries++;
+	int tried;
+	cave_predicate pred = NULL;
 
-		find_empty(c, &y, &x);
+	/* Pick a "legal" spot, in a corridor or a room as asked */
+	if (set == SET_CORR)
+		pred = cave_iscorridor;
+	else if (set == SET_ROOM)
+		pred = cave_isroom;
 
-		/* See if our spot is in a room or not */
-		room = (c->info[y][x] & CAVE_ROOM) ? TRUE : FALSE;
+	tried = cave_find_empty(c, &y, &x, pred);
 
-		/* If we are ok with a corridor and we're in one, we're done */
-		if (set & SET_CORR && !room) break;
-
-		/* If we are ok with a room and we're in one, we're done */
-		if (set & SET_ROOM && room) break;
+	if (dun->stats) {
+		dun->stats->alloc_calls++;
+		dun->stats->alloc_probes += tried ? tried : c->empty_n;
+		if (!tried) dun->stats->alloc_fails++;
 	}
 
-	if (tries == 2000) return FALSE;
+	if (!tried) return FALSE;
 
 	/* Place something */
 	switch (typ) {
@@ -739,14 +950,15 @@ static bool alloc_object(struct cave *c, int set, int typ, int depth, byte origi
  * with hidden gold, and one with known gold. The hidden gold types are
  * currently unused.
  */
-static void build_streamer(struct cave *c, int feat, int chance)
+static void build_streamer(struct dun_data *dun, struct cave *c,
+	int feat, int chance)
 {
 	int i, tx, ty;
 	int y, x, dir;
 
 	/* Hack -- Choose starting point */
-	y = rand_spread(DUNGEON_HGT / 2, 10);
-	x = rand_spread(DUNGEON_WID / 2, 15);
+	y = rand_spread(c->height / 2, 10);
+	x = rand_spread(c->width / 2, 15);
 
 	/* Choose a random direction */
 	dir = ddd[randint0(8)];
@@ -1030,7 +1242,7 @@ static void generate_hole(struct cave *c, int y1, int x1, int y2, int x2, int fe
 /**
  * Build a circular room (interior radius 4-7).
  */
-static bool build_circular(struct cave *c, int y0, int x0)
+static bool build_circular(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	/* Pick a room size */
 	int radius = 2 + randint1(2) + randint1(3);
@@ -1069,7 +1281,7 @@ static bool build_circular(struct cave *c, int y0, int x0)
 /**
  * Builds a normal rectangular room.
  */
-static bool build_simple(struct cave *c, int y0, int x0)
+static bool build_simple(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int y, x;
 	int light = FALSE;
@@ -1115,7 +1327,7 @@ static bool build_simple(struct cave *c, int y0, int x0)
 /**
  * Builds an overlapping rectangular room.
  */
-static bool build_overlap(struct cave *c, int y0, int x0)
+static bool build_overlap(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int y1a, x1a, y2a, x2a;
 	int y1b, x1b, y2b, x2b;
@@ -1169,7 +1381,7 @@ static bool build_overlap(struct cave *c, int y0, int x0)
  * below will work for 5x5 (and perhaps even for unsymetric values like 4x3 or
  * 5x3 or 3x4 or 3x5).
  */
-static bool build_crossed(struct cave *c, int y0, int x0)
+static bool build_crossed(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int y, x;
 
@@ -1302,7 +1514,7 @@ static bool build_crossed(struct cave *c, int y0, int x0)
  *	4 - An inner room with a checkerboard
  *	5 - An inner room with four compartments
  */
-static bool build_large(struct cave *c, int y0, int x0)
+static bool build_large(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int y, x, y1, x1, y2, x2;
 
@@ -1604,7 +1816,7 @@ static int set_pit_type(int depth, int type)
  *
  * Monster nests will never contain unique monsters.
  */
-static bool build_nest(struct cave *c, int y0, int x0)
+static bool build_nest(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int y, x, y1, x1, y2, x2;
 	int i;
@@ -1723,7 +1935,7 @@ static bool build_nest(struct cave *c, int y0, int x0)
  *
  * Like monster nests, monster pits will never contain unique monsters.
  */
-static bool build_pit(struct cave *c, int y0, int x0)
+static bool build_pit(struct dun_data *dun, struct cave *c, int y0, int x0)
 {
 	int what[16];
 	int i, j, y, x, y1, x1, y2, x2;
@@ -1870,112 +2082,94 @@ static bool build_pit(struct cave *c, int y0, int x0)
 
 
 /**
- * Build a vault from its string representation.
+ * Build a vault from its compiled plan.
  */
-static void build_vault(struct cave *c, int y0, int x0, int ymax, int xmax, const char *data)
+void build_vault(struct cave *c, int y0, int x0, struct vault *v)
 {
-	int dx, dy, x, y;
-	const char *t;
-	bool icky;
+	struct vault_plan *plan = v->plan;
+	int top = y0 - v->hgt / 2;
+	int left = x0 - v->wid / 2;
+	int i, k, y, x;
 
 	assert(c);
 
-	/* Place dungeon features and objects */
-	for (t = data, dy = 0; dy < ymax && *t; dy++) {
-		for (dx = 0; dx < xmax && *t; dx++, t++) {
-			/* Extract the location */
-			x = x0 - (xmax / 2) + dx;
-			y = y0 - (ymax / 2) + dy;
-
-			/* Skip non-grids */
-			if (*t == ' ') continue;
-
-			/* Lay down a floor */
-			cave_set_feat(c, y, x, FEAT_FLOOR);
-
+	/*
+	 * Copy in the terrain a run at a time.  This is cave_set_feat()
+	 * without the flow and view bookkeeping, which a level that is still
+	 * being made doesn't have yet.
+	 */
+	assert(!character_dungeon);
+	for (i = 0; i < plan->num_runs; i++) {
+		struct vault_run *r = &plan->runs[i];
+		int at = r->dy * v->wid + r->dx;
+
+		y = top + r->dy;
+		x = left + r->dx;
+		assert(y >= 0 && y < c->height);
+		assert(x >= 0 && x + r->len <= c->width);
+
+		memcpy(&c->feat[y][x], &plan->feat[at], r->len);
+		for (k = 0; k < r->len; k++) {
 			/* Debugging assertion */
-			assert(cave_isempty(c, y, x));
-
-			/* By default vault squares are marked icky */
-			icky = TRUE;
-
-			/* Analyze the grid */
-			switch (*t) {
-				case '%': {
-					/* In this case, the square isn't really part of the
-					 * vault, but rather is part of the "door step" to the
-					 * vault. We don't mark it icky so that the tunneling
-					 * code knows its allowed to remove this wall. */
-					cave_set_feat(c, y, x, FEAT_WALL_OUTER);
-					icky = FALSE;
-					break;
-				}
-				case '#': cave_set_feat(c, y, x, FEAT_WALL_INNER); break;
-				case 'X': cave_set_feat(c, y, x, FEAT_PERM_INNER); break;
-				case '+': place_secret_door(c, y, x); break;
-				case '^': place_trap(c, y, x); break;
-				case '*': {
-					/* Treasure or a trap */
-					if (randint0(100) < 75)
-						place_object(c, y, x, c->depth, FALSE, FALSE, ORIGIN_VAULT);
-					else
-						place_trap(c, y, x);
-					break;
-				}
-			}
+			assert(!c->m_idx[y][x + k] && !c->o_idx[y][x + k]);
 
-			/* Part of a vault */
-			c->info[y][x] |= CAVE_ROOM;
-			if (icky) c->info[y][x] |= CAVE_ICKY;
+			c->info[y][x + k] = (c->info[y][x + k] & ~CAVE_WALL) |
+				plan->info[at + k];
+			cave_note_wall(c, y, x + k);
+			cave_note_empty(c, y, x + k);
 		}
 	}
 
+	/* Treasure or a trap */
+	for (i = 0; i < plan->num_treasure; i++) {
+		y = top + plan->treasure[i].dy;
+		x = left + plan->treasure[i].dx;
 
-	/* Place dungeon monsters and objects */
-	for (t = data, dy = 0; dy < ymax && *t; dy++) {
-		for (dx = 0; dx < xmax && *t; dx++, t++) {
-			/* Extract the grid */
-			x = x0 - (xmax / 2) + dx;
-			y = y0 - (ymax / 2) + dy;
-
-			/* Hack -- skip "non-grids" */
-			if (*t == ' ') continue;
+		if (randint0(100) < 75)
+			place_object(c, y, x, c->depth, FALSE, FALSE, ORIGIN_VAULT);
+		else
+			place_trap(c, y, x);
+	}
 
-			/* Analyze the symbol */
-			switch (*t) {
-				case '&': pick_and_place_monster(c, y, x, c->depth + 5, TRUE, TRUE,
-					ORIGIN_DROP_VAULT); break;
-				case '@': pick_and_place_monster(c, y, x, c->depth + 11, TRUE, TRUE,
-					ORIGIN_DROP_VAULT); break;
+	/* Place dungeon monsters and objects */
+	for (i = 0; i < plan->num_spawns; i++) {
+		y = top + plan->spawns[i].dy;
+		x = left + plan->spawns[i].dx;
+
+		/* Analyze the symbol */
+		switch (plan->spawns[i].glyph) {
+			case '&': pick_and_place_monster(c, y, x, c->depth + 5, TRUE, TRUE,
+				ORIGIN_DROP_VAULT); break;
+			case '@': pick_and_place_monster(c, y, x, c->depth + 11, TRUE, TRUE,
+				ORIGIN_DROP_VAULT); break;
+
+			case '9': {
+				/* Meaner monster, plus treasure */
+				pick_and_place_monster(c, y, x, c->depth + 9, TRUE, TRUE,
+					ORIGIN_DROP_VAULT);
+				place_object(c, y, x, c->depth + 7, TRUE, FALSE,
+					ORIGIN_VAULT);
+				break;
+			}
 
-				case '9': {
-					/* Meaner monster, plus treasure */
-					pick_and_place_monster(c, y, x, c->depth + 9, TRUE, TRUE,
-						ORIGIN_DROP_VAULT);
-					place_object(c, y, x, c->depth + 7, TRUE, FALSE,
-						ORIGIN_VAULT);
-					break;
-				}
+			case '8': {
+				/* Nasty monster and treasure */
+				pick_and_place_monster(c, y, x, c->depth + 40, TRUE, TRUE,
+					ORIGIN_DROP_VAULT);
+				place_object(c, y, x, c->depth + 20, TRUE, TRUE,
+					ORIGIN_VAULT);
+				break;
+			}
 
-				case '8': {
-					/* Nasty monster and treasure */
-					pick_and_place_monster(c, y, x, c->depth + 40, TRUE, TRUE,
+			case ',': {
+				/* Monster and/or object */
+				if (randint0(100) < 50)
+					pick_and_place_monster(c, y, x, c->depth + 3, TRUE, TRUE,
 						ORIGIN_DROP_VAULT);
-					place_object(c, y, x, c->depth + 20, TRUE, TRUE,
+				if (randint0(100) < 50)
+					place_object(c, y, x, c->depth + 7, FALSE, FALSE,
 						ORIGIN_VAULT);
-					break;
-				}
-
-				case ',': {
-					/* Monster and/or object */
-					if (randint0(100) < 50)
-						pick_and_place_monster(c, y, x, c->depth + 3, TRUE, TRUE,
-							ORIGIN_DROP_VAULT);
-					if (randint0(100) < 50)
-						place_object(c, y, x, c->depth + 7, FALSE, FALSE,
-							ORIGIN_VAULT);
-					break;
-				}
+				break;
 			}
 		}
 	}
@@ -1999,7 +2193,7 @@ static bool build_vault_type(struct cave*c, int y0, int x0, int typ, const char
 	c->mon_rating += v_ptr->rat;
 
 	/* Build the vault */
-	build_vault(c, y0, x0, v_ptr->hgt, v_ptr->wid, v_ptr->text);
+	build_vault(c, y0, x0, v_ptr);
 
 	return TRUE;
 }
@@ -2008,7 +2202,8 @@ static bool build_vault_type(struct cave*c, int y0, int x0, int typ, const char
 /**
  * Build a lesser vault.
  */
-static bool build_lesser_vault(struct cave *c, int y0, int x0)
+static bool build_lesser_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0)
 {
 	return build_vault_type(c, y0, x0, 6, "Lesser vault");
 }
@@ -2017,7 +2212,8 @@ static bool build_lesser_vault(struct cave *c, int y0, int x0)
 /**
  * Build a (medium) vault.
  */
-static bool build_medium_vault(struct cave *c, int y0, int x0)
+static bool build_medium_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0)
 {
 	return build_vault_type(c, y0, x0, 7, "Medium vault");
 }
@@ -2042,7 +2238,8 @@ static bool build_medium_vault(struct cave *c, int y0, int x0)
  * 50-59  1.8 -  2.1%
  * 0-49   0.0 -  1.0%
  */
-static bool build_greater_vault(struct cave *c, int y0, int x0)
+static bool build_greater_vault(struct dun_data *dun, struct cave *c,
+	int y0, int x0)
 {
 	int i;
 	int numerator   = 2;
@@ -2084,7 +2281,8 @@ static bool build_greater_vault(struct cave *c, int y0, int x0)
  * The solid wall check prevents corridors from chopping the corners of rooms
  * off, as well as silly door placement, and excessively wide room entrances.
  */
-static void build_tunnel(struct cave *c, int row1, int col1, int row2, int col2)
+static void build_tunnel(struct dun_data *dun, struct cave *c,
+	int row1, int col1, int row2, int col2)
 {
 	int i, y, x;
 	int tmp_row, tmp_col;
@@ -2310,7 +2508,7 @@ static bool possible_doorway(struct cave *c, int y, int x)
 /**
  * Places door at y, x position if at least 2 walls found
  */
-static void try_door(struct cave *c, int y, int x)
+static void try_door(struct dun_data *dun, struct cave *c, int y, int x)
 {
 	assert(cave_in_bounds(c, y, x));
 
@@ -2323,28 +2521,18 @@ static void try_door(struct cave *c, int y, int x)
 
 
 /**
- * Attempt to build a room of the given type at the given block
- *
- * Note that we restrict the number of "crowded" rooms to reduce
- * the chance of overflowing the monster list during level creation.
+ * Check whether a room of the given type may go in the given blocks
  */
-static bool room_build(struct cave *c, int by0, int bx0, struct room_profile profile)
+static bool room_fits(struct dun_data *dun, struct cave *c,
+	int by1, int bx1, int by2, int bx2, const struct room_profile *profile)
 {
-	/* Extract blocks */
-	int by1 = by0;
-	int bx1 = bx0;
-	int by2 = by0 + profile.height;
-	int bx2 = bx0 + profile.width;
-
-	int allocated;
-	int y, x;
 	int by, bx;
 
 	/* Enforce the room profile's minimum depth */
-	if (c->depth < profile.level) return FALSE;
+	if (c->depth < profile->level) return FALSE;
 
 	/* Only allow one crowded room per level */
-	if (dun->crowded && profile.crowded) return FALSE;
+	if (dun->crowded && profile->crowded) return FALSE;
 
 	/* Never run off the screen */
 	if (by1 < 0 || by2 >= dun->row_rooms) return FALSE;
@@ -2362,12 +2550,55 @@ static bool room_build(struct cave *c, int by0, int bx0, struct room_profile pro
 		}
 	}
 
+	return TRUE;
+}
+
+
+/**
+ * Attempt to build a room of the given type at the given block
+ *
+ * Note that we restrict the number of "crowded" rooms to reduce
+ * the chance of overflowing the monster list during level creation.
+ */
+static bool room_build(struct dun_data *dun, struct cave *c,
+	int by0, int bx0, struct room_profile profile)
+{
+	/* Extract blocks */
+	int by1 = by0;
+	int bx1 = bx0;
+	int by2 = by0 + profile.height;
+	int bx2 = bx0 + profile.width;
+
+	int allocated;
+	int y, x;
+	int by, bx;
+
+	struct gen_builder_stats *stats = NULL;
+	double start = 0.0;
+	bool built;
+
+	if (dun->stats)
+		stats = gen_builder_entry(dun->stats->rooms, profile.name);
+
+	if (!room_fits(dun, c, by1, bx1, by2, bx2, &profile)) {
+		if (stats) stats->rejects++;
+		return FALSE;
+	}
+
 	/* Get the location of the room */
 	y = ((by1 + by2 + 1) * BLOCK_HGT) / 2;
 	x = ((bx1 + bx2 + 1) * BLOCK_WID) / 2;
 
 	/* Try to build a room */
-	if (!profile.builder(c, y, x)) return FALSE;
+	if (stats) start = gen_clock();
+	built = profile.builder(dun, c, y, x);
+	if (stats) {
+		stats->tries++;
+		stats->time += gen_clock() - start;
+		if (!built) stats->fails++;
+	}
+
+	if (!built) return FALSE;
 
 	/* Save the room location */
 	if (dun->cent_n < CENT_MAX) {
@@ -2393,27 +2624,14 @@ static bool room_build(struct cave *c, int by0, int bx0, struct room_profile pro
 }
 
 
-/**
- * 
- */
-static void set_cave_dimensions(struct cave *c, int h, int w)
-{
-	int i, n = h * w;
-	c->height = h;
-	c->width = w;
-	if (cave_squares != NULL) FREE(cave_squares);
-	cave_squares = C_ZNEW(n, int);
-	for (i = 0; i < n; i++) cave_squares[i] = i;
-}
-
-
 /**
  * Generate a new dungeon level.
  */
 #define DUN_AMT_ROOM 7 /* Number of objects for rooms */
 #define DUN_AMT_ITEM 2 /* Number of objects for rooms/corridors */
 #define DUN_AMT_GOLD 3 /* Amount of treasure for rooms/corridors */
-static bool default_gen(struct cave *c, struct player *p) {
+static bool default_gen(struct dun_data *dun, struct cave *c,
+	struct player *p) {
 	int i, j, k, y, x, y1, x1;
 	int by, bx = 0, tby, tbx, key, rarity, built;
 	int num_rooms, size_percent;
@@ -2443,11 +2661,11 @@ static bool default_gen(struct cave *c, struct player *p) {
 
 	/* scale the various generation variables */
 	num_rooms = (dun->profile->dun_rooms * size_percent) / 100;
-	set_cave_dimensions(c, DUNGEON_HGT, DUNGEON_WID);
+	cave_set_dimensions(c, DUNGEON_HGT, DUNGEON_WID);
 	//ROOM_LOG("height=%d  width=%d  nrooms=%d", c->height, c->width, num_rooms);
 
 	/* Initially fill with basic granite */
-	fill_rectangle(c, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, FEAT_WALL_EXTRA);
+	fill_rectangle(c, 0, 0, c->height - 1, c->width - 1, FEAT_WALL_EXTRA);
 
 	/* Actual maximum number of rooms on this level */
 	dun->row_rooms = c->height / BLOCK_HGT;
@@ -2515,7 +2733,7 @@ static bool default_gen(struct cave *c, struct player *p) {
 			if (profile.rarity > rarity) continue;
 			if (profile.cutoff <= key) continue;
 			
-			if (room_build(c, by, bx, profile)) {
+			if (room_build(dun, c, by, bx, profile)) {
 				built++;
 				break;
 			}
@@ -2523,7 +2741,7 @@ static bool default_gen(struct cave *c, struct player *p) {
 	}
 
 	/* Generate permanent walls around the edge of the dungeon */
-	draw_rectangle(c, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, FEAT_PERM_SOLID);
+	draw_rectangle(c, 0, 0, c->height - 1, c->width - 1, FEAT_PERM_SOLID);
 
 	/* Hack -- Scramble the room order */
 	for (i = 0; i < dun->cent_n; i++) {
@@ -2547,7 +2765,7 @@ static bool default_gen(struct cave *c, struct player *p) {
 	/* Connect all the rooms together */
 	for (i = 0; i < dun->cent_n; i++) {
 		/* Connect the room to the previous room */
-		build_tunnel(c, dun->cent[i].y, dun->cent[i].x, y, x);
+		build_tunnel(dun, c, dun->cent[i].y, dun->cent[i].x, y, x);
 
 		/* Remember the "previous" room */
 		y = dun->cent[i].y;
@@ -2561,36 +2779,36 @@ static bool default_gen(struct cave *c, struct player *p) {
 		x = dun->door[i].x;
 
 		/* Try placing doors */
-		try_door(c, y, x - 1);
-		try_door(c, y, x + 1);
-		try_door(c, y - 1, x);
-		try_door(c, y + 1, x);
+		try_door(dun, c, y, x - 1);
+		try_door(dun, c, y, x + 1);
+		try_door(dun, c, y - 1, x);
+		try_door(dun, c, y + 1, x);
 	}
 
 	ensure_connectedness(c);
 
 	/* Add some magma streamers */
 	for (i = 0; i < dun->profile->str.mag; i++)
-		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
+		build_streamer(dun, c, FEAT_MAGMA, dun->profile->str.mc);
 
 	/* Add some quartz streamers */
 	for (i = 0; i < dun->profile->str.qua; i++)
-		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
+		build_streamer(dun, c, FEAT_QUARTZ, dun->profile->str.qc);
 
 	/* Place 3 or 4 down stairs near some walls */
-	alloc_stairs(c, FEAT_MORE, rand_range(3, 4), 3);
+	alloc_stairs(dun, c, FEAT_MORE, rand_range(3, 4), 3);
 
 	/* Place 1 or 2 up stairs near some walls */
-	alloc_stairs(c, FEAT_LESS, rand_range(1, 2), 3);
+	alloc_stairs(dun, c, FEAT_LESS, rand_range(1, 2), 3);
 
 	/* General amount of rubble, traps and monsters */
 	k = MAX(MIN(c->depth / 3, 10), 2);
 
 	/* Put some rubble in corridors */
-	alloc_objects(c, SET_CORR, TYP_RUBBLE, randint1(k), c->depth, 0);
+	alloc_objects(dun, c, SET_CORR, TYP_RUBBLE, randint1(k), c->depth, 0);
 
 	/* Place some traps in the dungeon */
-	alloc_objects(c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
+	alloc_objects(dun, c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
 
 	/* Determine the character location */
 	new_player_spot(c, p);
@@ -2603,13 +2821,13 @@ static bool default_gen(struct cave *c, struct player *p) {
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
 
 	/* Put some objects in rooms */
-	alloc_objects(c, SET_ROOM, TYP_OBJECT, Rand_normal(DUN_AMT_ROOM, 3),
+	alloc_objects(dun, c, SET_ROOM, TYP_OBJECT, Rand_normal(DUN_AMT_ROOM, 3),
 		c->depth, ORIGIN_FLOOR);
 
 	/* Put some objects/gold in the dungeon */
-	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(DUN_AMT_ITEM, 3),
+	alloc_objects(dun, c, SET_BOTH, TYP_OBJECT, Rand_normal(DUN_AMT_ITEM, 3),
 		c->depth, ORIGIN_FLOOR);
-	alloc_objects(c, SET_BOTH, TYP_GOLD, Rand_normal(DUN_AMT_GOLD, 3),
+	alloc_objects(dun, c, SET_BOTH, TYP_GOLD, Rand_normal(DUN_AMT_GOLD, 3),
 		c->depth, ORIGIN_FLOOR);
 
 	return TRUE;
@@ -2679,7 +2897,8 @@ static bool lab_is_tunnel(struct cave *c, int y, int x) {
  * themselves (which means certain level numbers are more likely to generate
  * labyrinths than others).
  */
-static bool labyrinth_gen(struct cave *c, struct player *p) {
+static bool labyrinth_gen(struct dun_data *dun, struct cave *c,
+	struct player *p) {
 	int i, j, k, y, x;
 
 	/* Size of the actual labyrinth part must be odd. */
@@ -2739,10 +2958,10 @@ static bool labyrinth_gen(struct cave *c, struct player *p) {
 	walls = C_ZNEW(n, int);
 
 	/* This is the dungeon size, which does include the enclosing walls */
-	set_cave_dimensions(c, h + 2, w + 2);
+	cave_set_dimensions(c, h + 2, w + 2);
 
 	/* Fill whole level with perma-rock */
-	fill_rectangle(c, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, FEAT_PERM_SOLID);
+	fill_rectangle(c, 0, 0, c->height - 1, c->width - 1, FEAT_PERM_SOLID);
 
 	/* Fill the labyrinth area with rock */
 	fill_rectangle(c, 1, 1, h, w, soft ? FEAT_WALL_SOLID : FEAT_PERM_SOLID);
@@ -2802,21 +3021,21 @@ static bool labyrinth_gen(struct cave *c, struct player *p) {
 	/* The level should have exactly one down and one up staircase */
 	if (OPT(birth_no_stairs)) {
 		/* new_player_spot() won't have created stairs, so make both*/
-		alloc_stairs(c, FEAT_MORE, 1, 3);
-		alloc_stairs(c, FEAT_LESS, 1, 3);
+		alloc_stairs(dun, c, FEAT_MORE, 1, 3);
+		alloc_stairs(dun, c, FEAT_LESS, 1, 3);
 	} else if (p->create_down_stair) {
 		/* new_player_spot() will have created down, so only create up */
-		alloc_stairs(c, FEAT_LESS, 1, 3);
+		alloc_stairs(dun, c, FEAT_LESS, 1, 3);
 	} else {
 		/* new_player_spot() will have created up, so only create down */
-		alloc_stairs(c, FEAT_MORE, 1, 3);
+		alloc_stairs(dun, c, FEAT_MORE, 1, 3);
 	}
 
 	/* Generate a door for every 100 squares in the labyrinth */
 	for (i = n / 100; i > 0; i--) {
 		/* Try 10 times to find a useful place for a door, then place it */
 		for (j = 0; j < 10; j++) {
-			find_empty(c, &y, &x);
+			if (!find_empty(dun, c, &y, &x)) return FALSE;
 			if (lab_is_tunnel(c, y, x)) break;
 
 		}
@@ -2831,31 +3050,31 @@ static bool labyrinth_gen(struct cave *c, struct player *p) {
 	k = (3 * k * (h * w)) / (DUNGEON_HGT * DUNGEON_WID);
 
 	/* Put some rubble in corridors */
-	alloc_objects(c, SET_BOTH, TYP_RUBBLE, randint1(k), c->depth, 0);
+	alloc_objects(dun, c, SET_BOTH, TYP_RUBBLE, randint1(k), c->depth, 0);
 
 	/* Place some traps in the dungeon */
-	alloc_objects(c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
+	alloc_objects(dun, c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
 
 	/* Put some monsters in the dungeon */
 	for (i = MIN_M_ALLOC_LEVEL + randint1(8) + k; i > 0; i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
 
 	/* Put some objects/gold in the dungeon */
-	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(6, 3), c->depth,
+	alloc_objects(dun, c, SET_BOTH, TYP_OBJECT, Rand_normal(6, 3), c->depth,
 		ORIGIN_LABYRINTH);
-	alloc_objects(c, SET_BOTH, TYP_GOLD, Rand_normal(6, 3), c->depth,
+	alloc_objects(dun, c, SET_BOTH, TYP_GOLD, Rand_normal(6, 3), c->depth,
 		ORIGIN_LABYRINTH);
-	alloc_objects(c, SET_BOTH, TYP_GOOD, randint0(2), c->depth,
+	alloc_objects(dun, c, SET_BOTH, TYP_GOOD, randint0(2), c->depth,
 		ORIGIN_LABYRINTH);
 
 	/* Unlit labyrinths will have some good items */
 	if (!lit)
-		alloc_objects(c, SET_BOTH, TYP_GOOD, Rand_normal(3, 2), c->depth,
+		alloc_objects(dun, c, SET_BOTH, TYP_GOOD, Rand_normal(3, 2), c->depth,
 			ORIGIN_LABYRINTH);
 
 	/* Hard (non-diggable) labyrinths will have some great items */
 	if (!soft)
-		alloc_objects(c, SET_BOTH, TYP_GREAT, Rand_normal(2, 1), c->depth,
+		alloc_objects(dun, c, SET_BOTH, TYP_GREAT, Rand_normal(2, 1), c->depth,
 			ORIGIN_LABYRINTH);
 
 	/* If we want the players to see the maze layout, do that now */
@@ -2882,8 +3101,8 @@ static void init_cavern(struct cave *c, struct player *p, int density) {
 	int count = (size * density) / 100;
 	
 	/* Fill the edges with perma-rock, and rest with rock */
-	draw_rectangle(c, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, FEAT_PERM_SOLID);
-	fill_rectangle(c, 1, 1, DUNGEON_HGT - 2, DUNGEON_WID - 2, FEAT_WALL_SOLID);
+	draw_rectangle(c, 0, 0, h - 1, w - 1, FEAT_PERM_SOLID);
+	fill_rectangle(c, 1, 1, h - 2, w - 2, FEAT_WALL_SOLID);
 	
 	while (count > 0) {
 		int y = randint1(h - 2);
@@ -2895,78 +3114,156 @@ static void init_cavern(struct cave *c, struct player *p, int density) {
 	}
 }
 
-/**
- * Return the number of walls (0-8) adjacent to this square.
+/*
+ * The cellular automaton runs on bit-planes of the level, one bit for each
+ * square that is not floor, laid out like the cave's own wall plane.
  */
-static int count_adj_walls(struct cave *c, int y, int x) {
-	int yd, xd;
-	int count = 0;
-
-	for (yd = -1; yd <= 1; yd++) {
-		for (xd = -1; xd <= 1; xd++) {
-			if (yd == 0 && xd == 0) continue;
-			if (cave_isfloor(c, y + yd, x + xd)) continue;
-			count++;
-		}
-	}
-
-	return count;
-}
+typedef u32b cavern_row[CAVE_PLANE_WORDS];
 
 /**
- * Run a single pass of the cellular automata rules (4,5) on the dungeon.
+ * Fill a plane with the squares of the level that are not floor.
  */
-static void mutate_cavern(struct cave *c) {
+static void cavern_pack(struct cave *c, cavern_row *plane) {
 	int y, x;
 	int h = c->height;
 	int w = c->width;
 
-	int *temp = C_ZNEW(h * w, int);
+	memset(plane, 0, DUNGEON_HGT * sizeof(*plane));
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			if (!cave_isfloor(c, y, x))
+				plane[y][x / 32] |= 1UL << (x % 32);
+}
+
+/**
+ * Run a single pass of the cellular automata rules (4,5) from one plane
+ * into another.
+ *
+ * Each word holds 32 squares, and the eight neighbours of all of them are
+ * added up at once in four bit-sliced counters: bit i of n0 to n3 holds
+ * the count for square i. A square turns to wall with more than five
+ * walls next to it, to floor with fewer than four, and is kept otherwise.
+ */
+static void cavern_step(cavern_row *from, cavern_row *to, int h, int w) {
+	int y, k, i;
+	int words = (w + 31) / 32;
+	u32b mask[CAVE_PLANE_WORDS];
+
+	/* Only squares inside the outer edge change */
+	for (k = 0; k < words; k++) {
+		int x1 = MAX(1, 32 * k), x2 = MIN(w - 2, 32 * k + 31);
+
+		mask[k] = 0;
+		for (i = x1; i <= x2; i++)
+			mask[k] |= 1UL << (i % 32);
+	}
+
+	memcpy(to[0], from[0], sizeof(cavern_row));
+	memcpy(to[h - 1], from[h - 1], sizeof(cavern_row));
 
 	for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			int count = count_adj_walls(c, y, x);
-			if (count > 5)
-				temp[y * w + x] = FEAT_WALL_SOLID;
-			else if (count < 4)
-				temp[y * w + x] = FEAT_FLOOR;
-			else
-				temp[y * w + x] = cave->feat[y][x];
+		for (k = 0; k < words; k++) {
+			u32b n0 = 0, n1 = 0, n2 = 0, n3 = 0;
+			u32b adj[8];
+			int r, n = 0;
+
+			/* The squares west and east of each square in the rows
+			 * above, at and below it, and those straight above and below */
+			for (r = -1; r <= 1; r++) {
+				const u32b *row = from[y + r];
+				u32b west = row[k] << 1, east = row[k] >> 1;
+
+				if (k > 0) west |= row[k - 1] >> 31;
+				if (k < words - 1) east |= row[k + 1] << 31;
+
+				adj[n++] = west;
+				adj[n++] = east;
+				if (r) adj[n++] = row[k];
+			}
+
+			/* Add each neighbour into the counters */
+			for (i = 0; i < 8; i++) {
+				u32b carry = n0 & adj[i], next;
+
+				n0 ^= adj[i];
+				next = n1 & carry;
+				n1 ^= carry;
+				carry = next;
+				next = n2 & carry;
+				n2 ^= carry;
+				n3 |= next;
+			}
+
+			/* 6 to 8 walls make a wall; 4 or 5 keep what was there */
+			to[y][k] = ((n3 | (n2 & (n1 | from[y][k]))) & mask[k]) |
+				(from[y][k] & ~mask[k]);
 		}
 	}
+}
+
+/**
+ * Write the squares that one pass changed back to the level.
+ *
+ * They go in the order the old square-by-square pass wrote them, so that
+ * the level's set of empty squares comes out the same.
+ */
+static void cavern_commit(struct cave *c, cavern_row *from, cavern_row *to) {
+	int y, k, i;
+	int h = c->height;
+	int words = (c->width + 31) / 32;
 
 	for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			cave_set_feat(c, y, x, temp[y * w + x]);
+		for (k = 0; k < words; k++) {
+			u32b changed = from[y][k] ^ to[y][k];
+
+			for (i = 0; changed; i++, changed >>= 1) {
+				if (!(changed & 1)) continue;
+				cave_set_feat(c, y, 32 * k + i,
+					(to[y][k] >> i) & 1 ? FEAT_WALL_SOLID : FEAT_FLOOR);
+			}
 		}
 	}
-
-	FREE(temp);
 }
 
 /**
- * Fill an int[] with a single value.
+ * Run the cellular automaton on the level a number of times.
+ *
+ * The level is only ever floor and granite inside its edges here, so the
+ * planes hold all there is to know about it.
  */
-static void array_filler(int data[], int value, int size) {
+static void mutate_cavern(struct cave *c, int times) {
 	int i;
-	for (i = 0; i < size; i++) data[i] = value;
+
+	cavern_row *a = mem_alloc(DUNGEON_HGT * sizeof(*a));
+	cavern_row *b = mem_zalloc(DUNGEON_HGT * sizeof(*b));
+
+	cavern_pack(c, a);
+
+	for (i = 0; i < times; i++) {
+		cavern_row *swap;
+
+		cavern_step(a, b, c->height, c->width);
+		cavern_commit(c, a, b);
+		swap = a;
+		a = b;
+		b = swap;
+	}
+
+	FREE(a);
+	FREE(b);
 }
 
+/* ---------------- REGIONS ---------------------- */
+
 /**
- * Determine if we need to worry about coloring a point, or can ignore it.
+ * Determine whether a square belongs to a region: anything passable, doors,
+ * and the whole of any vault.
  */
-static int ignore_point(struct cave *c, int colors[], int y, int x) {
-	int h = c->height;
-	int w = c->width;
-	int n = lab_toi(y, x, w);
-
-	if (y < 0 || x < 0 || y >= h || x >= w) return TRUE;
-	if (colors[n]) return TRUE;
-	//if (cave_isvault(c, y, x)) return TRUE;
-	if (cave_isvault(c, y, x)) return FALSE;
-	if (cave_ispassable(c, y, x)) return FALSE;
-	if (cave_isdoor(c, y, x)) return FALSE;
-	return TRUE;
+static bool region_square(struct cave *c, int y, int x) {
+	if (cave_isvault(c, y, x)) return TRUE;
+	if (cave_ispassable(c, y, x)) return TRUE;
+	if (cave_isdoor(c, y, x)) return TRUE;
+	return FALSE;
 }
 
 static int xds[] = {0, 0, 1, -1, -1, -1, 1, 1};
@@ -2981,179 +3278,257 @@ static void glow_point(struct cave *c, int y, int x) {
 }
 #endif
 
-/**
- * Color a particular point, and all adjacent points.
- */
-static void build_color_point(struct cave *c, int colors[], int counts[], int y, int x, int color, bool diagonal) {
-	int h = c->height;
-	int w = c->width;
-	int size = h * w;
-	struct queue *queue = q_new(size);
+struct region_map *region_map_new(void) {
+	return ZNEW(struct region_map);
+}
 
-	int dslimit = diagonal ? 8 : 4;
+void region_map_free(struct region_map *m) {
+	if (!m) return;
 
-	int *added = C_ZNEW(size, int);
-	array_filler(added, 0, size);
+	FREE(m->label);
+	FREE(m->size);
+	FREE(m->box);
+	FREE(m->parent);
+	FREE(m->queue);
+	FREE(m->previous);
+	FREE(m);
+}
 
-	q_push_int(queue, lab_toi(y, x, w));
+/**
+ * Make sure the map has room for a level of the given size.  The arrays are
+ * only ever grown, so a map can be used for level after level.
+ */
+static void region_map_resize(struct region_map *m, int h, int w) {
+	size_t n = (size_t)h * w;
+
+	m->height = h;
+	m->width = w;
+	if (n <= m->alloc) return;
+
+	FREE(m->label);
+	FREE(m->size);
+	FREE(m->box);
+	FREE(m->parent);
+	FREE(m->queue);
+	FREE(m->previous);
+
+	m->label = C_ZNEW(n, int);
+	m->size = C_ZNEW(n + 1, int);
+	m->box = C_ZNEW(n + 1, struct region_box);
+	m->parent = C_ZNEW(n + 1, int);
+	m->queue = C_ZNEW(n + 1, int);
+	m->previous = C_ZNEW(n, int);
+	m->alloc = n;
+}
 
-	counts[color] = 0;
+/**
+ * Find the label a label has been merged into, halving the path on the way.
+ */
+static int region_find(int parent[], int r) {
+	while (parent[r] != r) {
+		parent[r] = parent[parent[r]];
+		r = parent[r];
+	}
+	return r;
+}
 
-	while (q_len(queue) > 0) {
-		int i, y2, x2;
-		int n2 = q_pop_int(queue);
+/**
+ * Merge two provisional labels, either of which may be 0 for none, keeping
+ * the lower as the label of both.
+ */
+static int region_merge(int parent[], int a, int b) {
+	if (!a || !b) return a ? a : b;
+
+	a = region_find(parent, a);
+	b = region_find(parent, b);
+	if (a < b) {
+		parent[b] = a;
+		return a;
+	}
 
-		lab_toyx(n2, w, &y2, &x2);
+	parent[a] = b;
+	return b;
+}
 
-		if (ignore_point(cave, colors, y2, x2)) continue;
+/**
+ * Label the connected regions of a level in two passes over it.
+ *
+ * The first pass gives each square a provisional label from its neighbours
+ * already scanned, recording which labels turn out to meet.  The second
+ * numbers the merged labels in the order their first squares are reached, so
+ * regions are numbered the same way as by flooding each in turn from the top
+ * left.
+ */
+int region_label(struct region_map *m, struct cave *c, bool diagonal) {
+	int h = c->height;
+	int w = c->width;
+	int *label, *parent, *number;
+	int y, x, r, next = 1;
 
-		colors[n2] = color;
-		counts[color]++;
+	region_map_resize(m, h, w);
+	label = m->label;
+	parent = m->parent;
+	number = m->queue;
 
-		/*if (lit) glow_point(c, y2, x2);*/
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			int n = y * w + x;
+			int l = 0;
+
+			label[n] = 0;
+			if (!region_square(c, y, x)) continue;
+
+			if (x > 0) l = region_merge(parent, l, label[n - 1]);
+			if (y > 0) {
+				l = region_merge(parent, l, label[n - w]);
+				if (diagonal && x > 0)
+					l = region_merge(parent, l, label[n - w - 1]);
+				if (diagonal && x < w - 1)
+					l = region_merge(parent, l, label[n - w + 1]);
+			}
 
-		for (i = 0; i < dslimit; i++) {
-			int y3 = y2 + yds[i];
-			int x3 = x2 + xds[i];
-			int n3 = lab_toi(y3, x3, w);
-			if (ignore_point(cave, colors, y3, x3)) continue;
-			if (added[n3]) continue;
+			/* A square with no labelled neighbours starts a new label */
+			if (!l) {
+				l = next++;
+				parent[l] = l;
+			}
 
-			q_push_int(queue, n3);
-			added[n3] = 1;
+			label[n] = l;
 		}
 	}
 
-	FREE(added);
-	q_free(queue);
-}
-
-/**
- * Create a color for each "NESW contiguous" region of the dungeon.
- */
-static void build_colors(struct cave *c, int colors[], int counts[], bool diagonal) {
-	int y, x;
-	int h = c->height;
-	int w = c->width;
-	int color = 1;
+	for (r = 1; r < next; r++) number[r] = 0;
+	m->num = 0;
+	m->size[0] = 0;
 
 	for (y = 0; y < h; y++) {
 		for (x = 0; x < w; x++) {
-			if (ignore_point(cave, colors, y, x)) continue;
-			build_color_point(cave, colors, counts, y, x, color, diagonal);
-			color++;
+			int n = y * w + x;
+			struct region_box *b;
+
+			if (!label[n]) continue;
+
+			r = region_find(parent, label[n]);
+			if (!number[r]) {
+				number[r] = ++m->num;
+				m->size[m->num] = 0;
+				b = &m->box[m->num];
+				b->y1 = b->y2 = y;
+				b->x1 = b->x2 = x;
+			}
+
+			r = label[n] = number[r];
+			m->size[r]++;
+
+			b = &m->box[r];
+			b->y2 = y;
+			if (x < b->x1) b->x1 = x;
+			if (x > b->x2) b->x2 = x;
 		}
 	}
+
+	return m->num;
+}
+
+bool cave_is_connected(struct cave *c) {
+	struct region_map *m = region_map_new();
+	bool connected = region_label(m, c, TRUE) <= 1;
+
+	region_map_free(m);
+	return connected;
 }
 
 /**
  * Find and delete all small (<9 square) open regions.
+ *
+ * Every other square of the interior not in a region is filled in too.
  */
-static void clear_small_regions(struct cave *c, int colors[], int counts[]) {
-	int i, y, x;
-	int h = c->height;
+static void clear_small_regions(struct cave *c, struct region_map *m) {
+	int r, y, x;
 	int w = c->width;
-	int size = h * w;
-
-	int *deleted = C_ZNEW(size, int);
-	array_filler(deleted, 0, size);
-
-	for (i = 0; i < size; i++) {
-		if (counts[i] < 9) {
-			deleted[i] = 1;
-			counts[i] = 0;
-		}
-	}
 
 	for (y = 1; y < c->height - 1; y++) {
-		for (x = 1; x < c->width - 1; x++) {
-			i = lab_toi(y, x, w);
+		for (x = 1; x < w - 1; x++) {
+			int n = lab_toi(y, x, w);
 
-			if (!deleted[colors[i]]) continue;
+			r = m->label[n];
+			if (r && m->size[r] >= 9) continue;
 
-			colors[i] = 0;
+			m->label[n] = 0;
 			cave_set_feat(c, y, x, FEAT_WALL_SOLID);
 		}
 	}
-	FREE(deleted);
-}
 
-/**
- * Return the number of colors which have active cells.
- */
-static int count_colors(int counts[], int size) {
-	int i;
-	int num = 0;
-	for (i = 0; i < size; i++) if (counts[i] > 0) num++;
-	return num;
+	for (r = 1; r <= m->num; r++)
+		if (m->size[r] < 9) m->size[r] = 0;
 }
 
 /**
- * Return the first color which has one or more active cells.
+ * Return the region a square is now part of, or 0 if none.
  */
-static int first_color(int counts[], int size) {
-	int i;
-	for (i = 0; i < size; i++) if (counts[i] > 0) return i;
-	return -1;
-}
-
-/**
- * Find all cells of 'fromcolor' and repaint them to 'tocolor'.
- */
-static void fix_colors(int colors[], int counts[], int from, int to, int size) {
-	int i;
-	for (i = 0; i < size; i++) if (colors[i] == from) colors[i] = to;
-	counts[to] += counts[from];
-	counts[from] = 0;
+static int region_of(struct region_map *m, int n) {
+	return m->label[n] ? region_find(m->parent, m->label[n]) : 0;
 }
 
 /**
  * Create a tunnel connecting a region to one of its nearest neighbors.
  */
-static void join_region(struct cave *c, int colors[], int counts[], int color) {
+static void join_region(struct cave *c, struct region_map *m, int color) {
 	int i;
 	int h = c->height;
 	int w = c->width;
 	int size = h * w;
 
-	/* Allocate a processing queue */
-	struct queue *queue = q_new(size);
-
-	/* Allocate an array to keep track of handled squares, and which square
-	 * we reached them from.
-	 */
-	int *previous = C_ZNEW(size, int);
-	array_filler(previous, -1, size);
+	/* The queue of squares to process, and which square we reached each from,
+	 * or -1 for squares not yet reached */
+	int *queue = m->queue;
+	int *previous = m->previous;
+	int head = 0, tail = 0;
 
 	/* Push all squares of the given color onto the queue */
 	for (i = 0; i < size; i++) {
-		if (colors[i] == color) {
-			q_push_int(queue, i);
+		previous[i] = -1;
+		if (region_of(m, i) == color) {
+			queue[tail++] = i;
 			previous[i] = i;
 		}
 	}
 
 	/* Process all squares into the queue */
-	while (q_len(queue) > 0) {
+	while (head < tail) {
 		/* Get the current square and its color */
-		int n = q_pop_int(queue);
-		int color2 = colors[n];
+		int n = queue[head++];
+		int color2 = region_of(m, n);
 
 		/* See if we've reached a square with a new color */
 		if (color2 && color2 != color) {
+			struct region_box *b = &m->box[color];
+			struct region_box *b2 = &m->box[color2];
+
 			/* Step backward through the path, turning stone to tunnel */
-			while (colors[n] != color) {
+			while (region_of(m, n) != color) {
 				int x, y;
 				lab_toyx(n, w, &y, &x);
-				colors[n] = color;
+				if (!m->label[n]) m->size[color]++;
+				m->label[n] = color;
 				if (!cave_isperm(c, y, x) && !cave_isvault(c, y, x)) {
 					cave_set_feat(c, y, x, FEAT_FLOOR);
 				}
+				b->y1 = MIN(b->y1, y);
+				b->x1 = MIN(b->x1, x);
+				b->y2 = MAX(b->y2, y);
+				b->x2 = MAX(b->x2, x);
 				n = previous[n];
 			}
 
-			/* Update the color mapping to combine the two colors */
-			fix_colors(colors, counts, color2, color, size);
+			/* Combine the two colors */
+			m->parent[color2] = color;
+			m->size[color] += m->size[color2];
+			m->size[color2] = 0;
+			b->y1 = MIN(b->y1, b2->y1);
+			b->x1 = MIN(b->x1, b2->x1);
+			b->y2 = MAX(b->y2, b2->y2);
+			b->x2 = MAX(b->x2, b2->x2);
 
 			/* We're done now */
 			break;
@@ -3177,32 +3552,34 @@ static void join_region(struct cave *c, int colors[], int counts[], int color) {
 			/* If the cell hasn't already been procssed, add it to the queue */
 			n2 = lab_toi(y, x, w);
 			if (previous[n2] >= 0) continue;
-			q_push_int(queue, n2);
+			queue[tail++] = n2;
 			previous[n2] = n;
 		}
 	}
-
-	/* Free the memory we've allocated */
-	q_free(queue);
-	FREE(previous);
 }
 
 
 /**
  * Start connecting regions, stopping when the cave is entirely connected.
+ *
+ * Each region is joined in turn to the first one left, which so remains the
+ * first.
  */
-static void join_regions(struct cave *c, int colors[], int counts[]) {
-	int h = c->height;
-	int w = c->width;
-	int size = h * w;
-	int num = count_colors(counts, size);
+static void join_regions(struct cave *c, struct region_map *m) {
+	int r, first = 0, num = 0;
+
+	for (r = 1; r <= m->num; r++) {
+		m->parent[r] = r;
+		if (!m->size[r]) continue;
+		if (!first) first = r;
+		num++;
+	}
 
 	/* While we have multiple colors (i.e. disconnected regions), join one of
 	 * the regions to another one.
 	 */
 	while (num > 1) {
-		int color = first_color(counts, size);
-		join_region(c, colors, counts, color);
+		join_region(c, m, first);
 		num--;
 	}
 }
@@ -3212,14 +3589,9 @@ static void join_regions(struct cave *c, int colors[], int counts[]) {
  * Count the number of open cells in the dungeon.
  */
 static int open_count(struct cave *c) {
-	int x, y;
 	int h = c->height;
 	int w = c->width;
-	int num = 0;
-	for (y = 0; y < h; y++)
-		for (x = 0; x < w; x++)
-			if (cave_ispassable(c, y, x)) num++;
-	return num;
+	return h * w - cave_count_walls(c, 0, 0, h - 1, w - 1);
 }
 
 
@@ -3230,15 +3602,11 @@ static int open_count(struct cave *c) {
  * information to join them into one conected region.
  */
 void ensure_connectedness(struct cave *c) {
-	int size = c->height * c->width;
-	int *colors = C_ZNEW(size, int);
-	int *counts = C_ZNEW(size, int);
-
-	build_colors(c, colors, counts, TRUE);
-	join_regions(c, colors, counts);
+	struct region_map *m = region_map_new();
 
-	FREE(colors);
-	FREE(counts);
+	region_label(m, c, TRUE);
+	join_regions(c, m);
+	region_map_free(m);
 }
 
 
@@ -3246,7 +3614,7 @@ void ensure_connectedness(struct cave *c) {
 /**
  * The generator's main function.
  */
-bool cavern_gen(struct cave *c, struct player *p) {
+bool cavern_gen(struct dun_data *dun, struct cave *c, struct player *p) {
 	int i, k, openc;
 
 	int h = rand_range(DUNGEON_HGT / 2, (DUNGEON_HGT * 3) / 4);
@@ -3257,14 +3625,13 @@ bool cavern_gen(struct cave *c, struct player *p) {
 	int density = rand_range(25, 30);
 	int times = rand_range(3, 6);
 
-	int *colors = C_ZNEW(size, int);
-	int *counts = C_ZNEW(size, int);
+	struct region_map *regions = region_map_new();
 
 	int tries = 0;
 
 	bool ok = TRUE;
 
-	set_cave_dimensions(c, h, w);
+	cave_set_dimensions(c, h, w);
 	ROOM_LOG("cavern h=%d w=%d size=%d density=%d times=%d", h, w, size, density, times);
 
 	if (c->depth < 15) {
@@ -3273,13 +3640,10 @@ bool cavern_gen(struct cave *c, struct player *p) {
 
 	} else {
 		/* Start trying to build caverns */
-		array_filler(colors, 0, size);
-		array_filler(counts, 0, size);
-	
 		for (tries = 0; tries < MAX_CAVERN_TRIES; tries++) {
 			/* Build a random cavern and mutate it a number of times */
 			init_cavern(c, p, density);
-			for (i = 0; i < times; i++) mutate_cavern(c);
+			mutate_cavern(c, times);
 	
 			/* If there are enough open squares then we're done */
 			openc = open_count(c);
@@ -3295,15 +3659,15 @@ bool cavern_gen(struct cave *c, struct player *p) {
 	}
 
 	if (ok) {
-		build_colors(c, colors, counts, FALSE);
-		clear_small_regions(c, colors, counts);
-		join_regions(c, colors, counts);
+		region_label(regions, c, FALSE);
+		clear_small_regions(c, regions);
+		join_regions(c, regions);
 	
 		/* Place 2-3 down stairs near some walls */
-		alloc_stairs(c, FEAT_MORE, rand_range(1, 3), 3);
+		alloc_stairs(dun, c, FEAT_MORE, rand_range(1, 3), 3);
 	
 		/* Place 1-2 up stairs near some walls */
-		alloc_stairs(c, FEAT_LESS, rand_range(1, 2), 3);
+		alloc_stairs(dun, c, FEAT_LESS, rand_range(1, 2), 3);
 	
 		/* General some rubble, traps and monsters */
 		k = MAX(MIN(c->depth / 3, 10), 2);
@@ -3312,10 +3676,10 @@ bool cavern_gen(struct cave *c, struct player *p) {
 		k = (2 * k * (h *  w)) / (DUNGEON_HGT * DUNGEON_WID);
 	
 		/* Put some rubble in corridors */
-		alloc_objects(c, SET_BOTH, TYP_RUBBLE, randint1(k), c->depth, 0);
+		alloc_objects(dun, c, SET_BOTH, TYP_RUBBLE, randint1(k), c->depth, 0);
 	
 		/* Place some traps in the dungeon */
-		alloc_objects(c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
+		alloc_objects(dun, c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
 	
 		/* Determine the character location */
 		new_player_spot(c, p);
@@ -3325,16 +3689,15 @@ bool cavern_gen(struct cave *c, struct player *p) {
 			pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
 	
 		/* Put some objects/gold in the dungeon */
-		alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(6, 3), c->depth,
+		alloc_objects(dun, c, SET_BOTH, TYP_OBJECT, Rand_normal(6, 3), c->depth,
 			ORIGIN_CAVERN);
-		alloc_objects(c, SET_BOTH, TYP_GOLD, Rand_normal(6, 3), c->depth,
+		alloc_objects(dun, c, SET_BOTH, TYP_GOLD, Rand_normal(6, 3), c->depth,
 			ORIGIN_CAVERN);
-		alloc_objects(c, SET_BOTH, TYP_GOOD, randint0(2), c->depth,
+		alloc_objects(dun, c, SET_BOTH, TYP_GOOD, randint0(2), c->depth,
 			ORIGIN_CAVERN);
 	}
 
-	FREE(colors);
-	FREE(counts);
+	region_map_free(regions);
 
 	return ok;
 }
@@ -3434,25 +3797,17 @@ static void town_gen_hack(struct cave *c, struct player *p) {
  * anything about the owners of the stores, nor the contents thereof. It only
  * handles the physical layout.
  */
-static bool town_gen(struct cave *c, struct player *p) {
+static bool town_gen(struct dun_data *dun, struct cave *c, struct player *p) {
 	int i;
 	bool daytime = turn % (10 * TOWN_DAWN) < (10 * TOWN_DUSK);
 	int residents = daytime ? MIN_M_ALLOC_TD : MIN_M_ALLOC_TN;
 
 	assert(c);
 
-	set_cave_dimensions(c, TOWN_HGT, TOWN_WID);
-
-	/* NOTE: We can't use c->height and c->width here because then there'll be
-	 * a bunch of empty space in the level that monsters might spawn in (or
-	 * teleport might take you to, or whatever).
-	 *
-	 * TODO: fix this to use c->height and c->width when all the 'choose
-	 * random location' things honor them.
-	 */
+	cave_set_dimensions(c, TOWN_HGT, TOWN_WID);
 
 	/* Start with solid walls, and then create some floor in the middle */
-	fill_rectangle(c, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, FEAT_PERM_SOLID);
+	fill_rectangle(c, 0, 0, c->height - 1, c->width - 1, FEAT_PERM_SOLID);
 	fill_rectangle(c, 1, 1, c->height -2, c->width - 2, FEAT_FLOOR);
 
 	/* Build stuff */
@@ -3473,32 +3828,14 @@ static bool town_gen(struct cave *c, struct player *p) {
  * Clear the dungeon, ready for generation to begin.
  */
 static void cave_clear(struct cave *c, struct player *p) {
-	int x, y;
-
 	wipe_o_list(c);
 	wipe_mon_list(c, p);
 
-	/* Clear flags and flow information. */
-	for (y = 0; y < DUNGEON_HGT; y++) {
-		for (x = 0; x < DUNGEON_WID; x++) {
-			/* Erase features */
-			c->feat[y][x] = 0;
-
-			/* Erase flags */
-			c->info[y][x] = 0;
-			c->info2[y][x] = 0;
+	/* Erase features, flags, monsters, the player and items */
+	cave_wipe(c);
 
-			/* Erase flow */
-			c->cost[y][x] = 0;
-			c->when[y][x] = 0;
-
-			/* Erase monsters/player */
-			c->m_idx[y][x] = 0;
-
-			/* Erase items */
-			c->o_idx[y][x] = 0;
-		}
-	}
+	/* Forget the flow information */
+	cave_reset_flow(c);
 
 	/* Unset the player's coordinates */
 	p->px = p->py = 0;
@@ -3522,9 +3859,12 @@ static void place_feeling(struct cave *c)
 	for (i = 0; i < FEELING_TOTAL; i++){
 		for(j = 0; j < tries; j++){
 			
-			/* Pick a random dungeon coordinate */
+			/* Pick a random dungeon coordinate (from the largest level,
+			 * so that smaller ones come out as they always have) */
 			y = randint0(DUNGEON_HGT);
 			x = randint0(DUNGEON_WID);
+			if (!cave_in_bounds(c, y, x))
+				continue;
 			
 			/* Check to see if it is not a wall */
 			if (cave_iswall(c,y,x))
@@ -3615,6 +3955,31 @@ static void clear_dun_data(struct dun_data *d) {
 	}
 }
 
+/**
+ * Run the builder of the chosen profile, counting it if asked to.
+ */
+static bool run_profile(struct dun_data *dun, struct cave *c, struct player *p)
+{
+	struct gen_builder_stats *stats = NULL;
+	double start = 0.0;
+	bool ok;
+
+	if (dun->stats) {
+		stats = gen_builder_entry(dun->stats->profiles, dun->profile->name);
+		start = gen_clock();
+	}
+
+	ok = dun->profile->builder(dun, c, p);
+
+	if (stats) {
+		stats->tries++;
+		stats->time += gen_clock() - start;
+		if (!ok) stats->fails++;
+	}
+
+	return ok;
+}
+
 /**
  * Generate a random level.
  *
@@ -3623,28 +3988,31 @@ static void clear_dun_data(struct dun_data *d) {
 void cave_generate(struct cave *c, struct player *p) {
 	const char *error = "no generation";
 	int tries = 0;
+	struct dun_data dun_body, *dun = &dun_body;
+	double start = gen_clock(), phase = start;
 
 	assert(c);
 
 	c->depth = p->depth;
+	WIPE(dun, struct dun_data);
+	dun->stats = gen_stats;
 
 	/* Generate */
 	for (tries = 0; tries < 100 && error; tries++) {
-		struct dun_data dun_body;
-
 		error = NULL;
+		if (dun->stats) phase = gen_clock();
 		cave_clear(c, p);
+		if (dun->stats) dun->stats->time_clear += gen_clock() - phase;
 
 		/* Mark the dungeon as being unready (to avoid artifact loss, etc) */
 		character_dungeon = FALSE;
 
-		/* Allocate global data (will be freed when we leave the loop) */
-		dun = &dun_body;
+		/* Reset the generation data */
 		clear_dun_data(dun);
 
 		if (p->depth == 0) {
 			dun->profile = &town_profile;
-			dun->profile->builder(c, p);
+			run_profile(dun, c, p);
 		} else {
 			int perc = randint0(100);
 			int last = NUM_CAVE_PROFILES - 1;
@@ -3656,12 +4024,13 @@ void cave_generate(struct cave *c, struct player *p) {
 				profile = dun->profile = &cave_profiles[i];
 				if (i < last && profile->cutoff < perc) continue;
 
-				ok = dun->profile->builder(c, p);
+				ok = run_profile(dun, c, p);
 				if (ok) break;
 			}
 		}
 
 		/* Ensure quest monsters */
+		if (dun->stats) phase = gen_clock();
 		if (is_quest(c->depth)) {
 			int i;
 			for (i = 1; i < z_info->r_max; i++) {
@@ -3674,32 +4043,419 @@ void cave_generate(struct cave *c, struct player *p) {
 				if (r_ptr->level != c->depth) continue;
 	
 				/* Pick a location and place the monster */
-				find_empty(c, &y, &x);
-				place_new_monster(c, y, x, i, TRUE, TRUE, ORIGIN_DROP);
+				if (find_empty(dun, c, &y, &x))
+					place_new_monster(c, y, x, i, TRUE, TRUE, ORIGIN_DROP);
 			}
 		}
 
+		if (dun->stats) {
+			dun->stats->time_quests += gen_clock() - phase;
+			phase = gen_clock();
+		}
+
 		/* Place dungeon squares to trigger feeling */
 		place_feeling(c);
 		
 		c->feeling = calc_obj_feeling(c) + calc_mon_feeling(c);
+		if (dun->stats) dun->stats->time_feeling += gen_clock() - phase;
 
 		/* Regenerate levels that overflow their maxima */
-		if (o_max >= z_info->o_max) 
+		if (o_max >= z_info->o_max) {
 			error = "too many objects";
-		if (cave_monster_max(cave) >= z_info->m_max)
+			if (dun->stats) dun->stats->too_many_objects++;
+		}
+		if (cave_monster_max(c) >= z_info->m_max) {
 			error = "too many monsters";
+			if (dun->stats) dun->stats->too_many_monsters++;
+		}
 
 		if (error) ROOM_LOG("Generation restarted: %s.", error);
 	}
 
-	FREE(cave_squares);
-	cave_squares = NULL;
-
 	if (error) quit_fmt("cave_generate() failed 100 times!");
 
 	/* The dungeon is ready */
 	character_dungeon = TRUE;
 
 	c->created_at = turn;
+
+	if (dun->stats) {
+		dun->stats->levels++;
+		dun->stats->time += gen_clock() - start;
+		dun->stats->profile = dun->profile->name;
+	}
+}
+
+/**
+ * Generate a level from its own stream of random numbers, started from the
+ * given seed, leaving the game's stream as it was.
+ *
+ * The same seed gives the same level, as long as the rest of the game (which
+ * uniques are alive, the player's depth, and so on) is the same.
+ */
+void cave_generate_seed(struct cave *c, struct player *p, u32b seed) {
+	struct rand_state game, level;
+
+	Rand_state_seed(&level, seed);
+	Rand_state_save(&game);
+	Rand_state_load(&level);
+
+	cave_generate(c, p);
+
+	Rand_state_load(&game);
+}
+
+/**
+ * Work out the seed for the level the player is going to at `depth`, from
+ * the level `c` they are leaving.  Every level is made from a seed like
+ * this (see cave_generate_next()), so a level made ahead of time by
+ * cave_pregen() is just the level the player would have found anyway.
+ */
+u32b cave_next_seed(struct cave *c, int depth) {
+	u32b v[4];
+	u32b h = 2166136261UL;
+	int i, j;
+
+	v[0] = seed_flavor;
+	v[1] = (u32b)c->created_at;
+	v[2] = (u32b)c->depth;
+	v[3] = (u32b)depth;
+
+	/* FNV-1a, a byte at a time */
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 4; j++) {
+			h ^= (v[i] >> (8 * j)) & 0xFF;
+			h = (h * 16777619UL) & 0xFFFFFFFFUL;
+		}
+	}
+
+	return h;
+}
+
+
+/*
+ * Everything besides the cave which goes into making a level: its seed,
+ * its depth, the stairs it must have back (see new_player_spot()), whether
+ * it is a quest level, and which monsters and artifacts are still about
+ * once the level before has been wiped.  Two levels made from the same of
+ * these are the same.
+ */
+struct level_key {
+	u32b seed;
+	int depth;
+	bool up_stair;
+	bool down_stair;
+	bool quest;
+
+	byte *cur_num;
+	byte *max_num;
+	bool *created;
+};
+
+/*
+ * A level made ahead of time by cave_pregen(), with what it was made from,
+ * and what making it did to the rest of the game.
+ */
+struct pregen {
+	bool ready;
+	struct level_key key;
+
+	struct cave *cave;
+	struct object_list *objects;
+	byte *cur_num;
+	bool *created;
+	s16b num_repro;
+	int py, px;
+	bool up_stair;
+	bool down_stair;
+	u32b update;
+	u32b redraw;
+};
+
+/*
+ * The levels below and above the player, and room to work out a key
+ */
+static struct pregen pregen[2];
+static struct level_key pregen_key;
+
+static void level_key_init(struct level_key *k) {
+	k->cur_num = C_ZNEW(z_info->r_max, byte);
+	k->max_num = C_ZNEW(z_info->r_max, byte);
+	k->created = C_ZNEW(z_info->a_max, bool);
+}
+
+static void level_key_free(struct level_key *k) {
+	FREE(k->cur_num);
+	FREE(k->max_num);
+	FREE(k->created);
+}
+
+/*
+ * Work out what a level at `depth` would be made from, were the player to
+ * go there from the level `c` now.  Unless `c` has been wiped already, the
+ * monsters and artifacts on it are put back just as wiping it would.
+ */
+static void level_key_get(struct level_key *k, struct cave *c, int depth,
+		bool up, bool down, bool wiped) {
+	int i;
+
+	k->seed = cave_next_seed(c, depth);
+	k->depth = depth;
+	k->up_stair = up;
+	k->down_stair = down;
+	k->quest = is_quest(depth);
+
+	for (i = 0; i < z_info->r_max; i++) {
+		k->cur_num[i] = r_info[i].cur_num;
+		k->max_num[i] = r_info[i].max_num;
+	}
+	for (i = 0; i < z_info->a_max; i++)
+		k->created[i] = a_info[i].created;
+
+	if (wiped) return;
+
+	/* See wipe_mon_list() */
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *m_ptr = cave_monster(c, i);
+
+		if (m_ptr->r_idx) k->cur_num[m_ptr->r_idx]--;
+	}
+
+	/* See wipe_o_list() */
+	for (i = 1; i < o_max; i++) {
+		struct object *o_ptr = object_byid(i);
+
+		if (!o_ptr->kind || !o_ptr->artifact) continue;
+		if (wipe_keeps_artifact(o_ptr))
+			k->created[o_ptr->artifact->aidx] = FALSE;
+	}
+}
+
+static bool level_key_same(const struct level_key *a,
+		const struct level_key *b) {
+	return a->seed == b->seed && a->depth == b->depth &&
+		a->up_stair == b->up_stair && a->down_stair == b->down_stair &&
+		a->quest == b->quest &&
+		!memcmp(a->cur_num, b->cur_num, z_info->r_max * sizeof(byte)) &&
+		!memcmp(a->max_num, b->max_num, z_info->r_max * sizeof(byte)) &&
+		!memcmp(a->created, b->created, z_info->a_max * sizeof(bool));
+}
+
+/*
+ * The cheat options which tell the player about a level as it is made, so
+ * it cannot be made ahead of time
+ */
+static bool pregen_cheating(void) {
+	return OPT(cheat_hear) || OPT(cheat_room) || OPT(cheat_xtra);
+}
+
+/*
+ * Make a level at `depth` in the cave of `g`, with objects of its own, and
+ * put the rest of the game back as it was.  What making it changed is kept
+ * in `g`, to be put in place by pregen_take().
+ */
+static void pregen_build(struct pregen *g, struct player *p, int depth,
+		bool up, bool down) {
+	struct cave *c = cave;
+	struct player old_p = *p;
+	struct target old_target;
+	bool old_dungeon = character_dungeon;
+	s16b old_repro = num_repro;
+	int i;
+
+	if (!g->cave) {
+		g->cave = cave_new();
+		g->objects = object_list_new();
+		level_key_init(&g->key);
+		g->cur_num = C_ZNEW(z_info->r_max, byte);
+		g->created = C_ZNEW(z_info->a_max, bool);
+	}
+
+	/* What the level is made from, and the racial counts and artifacts to
+	 * put back afterwards */
+	level_key_get(&g->key, c, depth, up, down, FALSE);
+	level_key_get(&pregen_key, c, depth, up, down, TRUE);
+	target_save(&old_target);
+
+	/* Empty the cave of whatever was made in it last */
+	cave = g->cave;
+	objects_swap(g->objects);
+	character_dungeon = FALSE;
+	cave_clear(cave, p);
+
+	for (i = 0; i < z_info->r_max; i++)
+		r_info[i].cur_num = g->key.cur_num[i];
+	for (i = 0; i < z_info->a_max; i++)
+		a_info[i].created = g->key.created[i];
+
+	p->depth = depth;
+	p->create_up_stair = up;
+	p->create_down_stair = down;
+	p->update = 0;
+	p->redraw = 0;
+
+	cave_generate_seed(cave, p, g->key.seed);
+
+	/* Keep what making the level did */
+	for (i = 0; i < z_info->r_max; i++)
+		g->cur_num[i] = r_info[i].cur_num;
+	for (i = 0; i < z_info->a_max; i++)
+		g->created[i] = a_info[i].created;
+	g->num_repro = num_repro;
+	g->py = p->py;
+	g->px = p->px;
+	g->up_stair = p->create_up_stair;
+	g->down_stair = p->create_down_stair;
+	g->update = p->update;
+	g->redraw = p->redraw;
+	g->ready = TRUE;
+
+	/* Put back the game as it was */
+	objects_swap(g->objects);
+	cave = c;
+
+	for (i = 0; i < z_info->r_max; i++)
+		r_info[i].cur_num = pregen_key.cur_num[i];
+	for (i = 0; i < z_info->a_max; i++)
+		a_info[i].created = pregen_key.created[i];
+
+	*p = old_p;
+	target_restore(&old_target);
+	num_repro = old_repro;
+	character_dungeon = old_dungeon;
+	get_mon_num_invalidate();
+}
+
+/*
+ * Put the level made by pregen_build() in place of the wiped level `c`, as
+ * if it had just been made there.
+ */
+static void pregen_take(struct pregen *g, struct cave *c, struct player *p) {
+	struct cave old = *c;
+	int i;
+
+	*c = *g->cave;
+	*g->cave = old;
+	objects_swap(g->objects);
+	g->ready = FALSE;
+
+	for (i = 0; i < z_info->r_max; i++)
+		r_info[i].cur_num = g->cur_num[i];
+	for (i = 0; i < z_info->a_max; i++)
+		a_info[i].created = g->created[i];
+	num_repro = g->num_repro;
+	get_mon_num_invalidate();
+
+	p->py = g->py;
+	p->px = g->px;
+	p->create_up_stair = g->up_stair;
+	p->create_down_stair = g->down_stair;
+	p->update |= g->update;
+	p->redraw |= g->redraw;
+
+	/* The monsters start gaining energy from now, not from when the level
+	 * was made */
+	mon_sched_reset(c);
+	for (i = 1; i < cave_monster_max(c); i++)
+		if (cave_monster(c, i)->r_idx) mon_sched_add(c, i);
+
+	/* The dungeon is ready */
+	character_dungeon = TRUE;
+
+	c->created_at = turn;
+}
+
+/**
+ * Make one of the levels the player may go to next, down or up the stairs
+ * from the current level, unless it is made already from what it would be
+ * made from now.  This is meant for when the game is waiting for a command,
+ * so that the level is ready when the player gets there (see
+ * cave_generate_next()).
+ *
+ * Returns whether a level was made, so that the caller knows to redraw the
+ * map, which making the level draws over, and to come back for the other.
+ */
+bool cave_pregen(struct player *p) {
+	int i;
+
+	if (!character_dungeon || p->is_dead || p->leaving) return FALSE;
+	if (pregen_cheating()) return FALSE;
+
+	if (!pregen_key.cur_num) level_key_init(&pregen_key);
+
+	for (i = 0; i < (int)N_ELEMENTS(pregen); i++) {
+		struct pregen *g = &pregen[i];
+		bool down = (i == 0);
+		int depth = p->depth + (down ? 1 : -1);
+
+		/* Only levels which can be reached by the stairs */
+		if (down && depth >= MAX_DEPTH) continue;
+		if (!down && (depth < 1 || OPT(birth_ironman))) continue;
+
+		/* Taking the stairs makes stairs back */
+		if (g->ready) {
+			level_key_get(&pregen_key, cave, depth, down, !down, FALSE);
+			if (level_key_same(&pregen_key, &g->key)) continue;
+		}
+
+		pregen_build(g, p, depth, down, !down);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Free the levels made by cave_pregen().
+ */
+void cave_pregen_forget(void) {
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(pregen); i++) {
+		struct pregen *g = &pregen[i];
+
+		if (!g->cave) continue;
+
+		cave_free(g->cave);
+		object_list_free(g->objects);
+		level_key_free(&g->key);
+		FREE(g->cur_num);
+		FREE(g->created);
+		WIPE(g, struct pregen);
+	}
+
+	level_key_free(&pregen_key);
+}
+
+/**
+ * Make the level the player is going to, at the player's new depth, in
+ * place of the level `c` they are leaving, from the seed cave_next_seed()
+ * gives it.  If cave_pregen() has made the level from just the same, it
+ * is used instead of making it again.
+ *
+ * Returns whether the level was made ahead of time.
+ */
+bool cave_generate_next(struct cave *c, struct player *p) {
+	u32b seed = cave_next_seed(c, p->depth);
+	size_t i;
+
+	/* Leave the old level, as the first try at making the new one would */
+	wipe_o_list(c);
+	wipe_mon_list(c, p);
+
+	for (i = 0; i < N_ELEMENTS(pregen) && !pregen_cheating(); i++) {
+		struct pregen *g = &pregen[i];
+
+		if (!g->ready) continue;
+
+		level_key_get(&pregen_key, c, p->depth, p->create_up_stair,
+				p->create_down_stair, TRUE);
+		if (!level_key_same(&pregen_key, &g->key)) continue;
+
+		pregen_take(g, c, p);
+		return TRUE;
+	}
+
+	cave_generate_seed(c, p, seed);
+	return FALSE;
 }
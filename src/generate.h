@@ -3,6 +3,80 @@
 #ifndef GENERATE_H
 #define GENERATE_H
 
+/**
+ * The bounding box of a region, inclusive.
+ */
+struct region_box {
+	int y1, x1;
+	int y2, x2;
+};
+
+/**
+ * The connected regions of a level, as labelled by region_label().
+ *
+ * A region is a connected set of passable squares, doors and vault squares.
+ * Regions are numbered from 1; `size` and `box` are indexed by region.  The
+ * remaining arrays are scratch space, kept so one map can be reused.
+ */
+struct region_map {
+	int height, width;
+	int *label; /* Region of each square (y * width + x), or 0 for none */
+	int num; /* Number of regions */
+	int *size; /* Number of squares in each region */
+	struct region_box *box; /* Bounding box of each region */
+
+	int *parent;
+	int *queue;
+	int *previous;
+	size_t alloc;
+};
+
+/**
+ * Counts and times for one level or room builder.
+ */
+struct gen_builder_stats {
+	const char *name;
+	u32b tries; /* Times the builder was run */
+	u32b fails; /* Times it gave up */
+	u32b rejects; /* Times a room was refused before building */
+	double time; /* Time spent in the builder */
+};
+
+#define GEN_STATS_BUILDERS 16
+
+/**
+ * Statistics on level generation, gathered while gen_stats points to them.
+ * Times are in seconds of processor time.
+ */
+struct gen_stats {
+	u32b levels; /* Levels finished */
+	u32b too_many_objects; /* Levels thrown away for overflowing o_max */
+	u32b too_many_monsters; /* Levels thrown away for overflowing m_max */
+	const char *profile; /* Name of the profile which built the last level */
+
+	double time; /* Total time in cave_generate() */
+	double time_clear; /* Wiping the previous level */
+	double time_quests; /* Placing quest monsters */
+	double time_feeling; /* Placing feeling squares and rating the level */
+
+	struct gen_builder_stats profiles[GEN_STATS_BUILDERS];
+	struct gen_builder_stats rooms[GEN_STATS_BUILDERS];
+
+	u32b find_calls; /* Searches for an empty square */
+	u32b find_probes; /* Squares tested by those searches */
+	u32b find_fails; /* Searches which found nothing */
+
+	u32b alloc_calls; /* Objects, traps and rubble placed at random */
+	u32b alloc_probes; /* Empty squares tried for them */
+	u32b alloc_fails; /* Placements which gave up */
+};
+
+extern struct gen_stats *gen_stats;
+
+struct region_map *region_map_new(void);
+void region_map_free(struct region_map *m);
+int region_label(struct region_map *m, struct cave *c, bool diagonal);
+bool cave_is_connected(struct cave *c);
 void ensure_connectedness(struct cave *c);
 
 void place_object(struct cave *c, int y, int x, int level, bool good,
@@ -12,7 +86,10 @@ void place_secret_door(struct cave *c, int y, int x);
 void place_closed_door(struct cave *c, int y, int x);
 void place_random_door(struct cave *c, int y, int x);
 
+void vault_plans_init(void);
+void vault_plans_free(void);
 extern struct vault *random_vault(int typ);
+void build_vault(struct cave *c, int y0, int x0, struct vault *v);
 
 struct tunnel_profile {
 	const char *name;
@@ -33,10 +110,17 @@ struct streamer_profile {
     int qc; /* 1/chance of treasure per quartz */
 };
 
+/**
+ * The state of the level being generated, private to generate.c.  It is
+ * passed to the builders so that nothing about a generation is global.
+ */
+struct dun_data;
+
 /*
 * cave_builder is a function pointer which builds a level.
 */
-typedef bool (*cave_builder) (struct cave *c, struct player *p);
+typedef bool (*cave_builder) (struct dun_data *dun, struct cave *c,
+	struct player *p);
 
 
 struct cave_profile {
@@ -57,7 +141,8 @@ struct cave_profile {
  * room_builder is a function pointer which builds rooms in the cave given
  * anchor coordinates.
  */
-typedef bool (*room_builder) (struct cave *c, int y0, int x0);
+typedef bool (*room_builder) (struct dun_data *dun, struct cave *c,
+	int y0, int x0);
 
 
 /**
@@ -2501,8 +2501,7 @@ static void handle_sidebar(game_event_type type, game_event_data *data, void *us
 	
 	xtra_win_data *xd = &xdata[5];
 	long xp = (long)p_ptr->exp;
-	monster_type *m_ptr = p_ptr->health_who != NULL ?
-            cave_monster(cave, p_ptr->health_who->midx) : NULL;
+	monster_type *m_ptr = health_tracked(p_ptr);
 	int i = 0, sidebar_length = 12;
 
 	/* Calculate XP for next level */
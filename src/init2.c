@@ -28,6 +28,7 @@
 #include "keymap.h"
 #include "init.h"
 #include "monster/init.h"
+#include "monster/mon-make.h"
 #include "monster/mon-msg.h"
 #include "monster/mon-util.h"
 #include "object/object.h"
@@ -282,12 +283,25 @@ static void cleanup_z(void)
 	mem_free(z_info);
 }
 
+static void save_z(struct raw *r)
+{
+	raw_put(r, z_info, sizeof(*z_info));
+}
+
+static void load_z(struct raw *r)
+{
+	z_info = mem_zalloc(sizeof(*z_info));
+	raw_get(r, z_info, sizeof(*z_info));
+}
+
 static struct file_parser z_parser = {
 	"limits",
 	init_parse_z,
 	run_parse_z,
 	finish_parse_z,
-	cleanup_z
+	cleanup_z,
+	save_z,
+	load_z
 };
 
 /* Parsing functions for object_base.txt */
@@ -421,12 +435,35 @@ static void cleanup_kb(void)
 	mem_free(kb_info);
 }
 
+static void save_kb(struct raw *r)
+{
+	int idx;
+	for (idx = 0; idx < TV_MAX; idx++) {
+		raw_put(r, &kb_info[idx], sizeof(*kb_info));
+		raw_put_str(r, kb_info[idx].name);
+	}
+}
+
+static void load_kb(struct raw *r)
+{
+	int idx;
+
+	kb_info = mem_zalloc(TV_MAX * sizeof(*kb_info));
+	for (idx = 0; idx < TV_MAX; idx++) {
+		raw_get(r, &kb_info[idx], sizeof(*kb_info));
+		kb_info[idx].name = raw_get_str(r);
+		kb_info[idx].next = NULL;
+	}
+}
+
 struct file_parser kb_parser = {
 	"object_base",
 	init_parse_kb,
 	run_parse_kb,
 	finish_parse_kb,
-	cleanup_kb
+	cleanup_kb,
+	save_kb,
+	load_kb
 };
 
 
@@ -668,12 +705,51 @@ static void cleanup_k(void)
 	mem_free(k_info);
 }
 
+static void save_k(struct raw *r)
+{
+	int idx;
+
+	raw_put_u32(r, z_info->k_max);
+	for (idx = 0; idx < z_info->k_max; idx++) {
+		struct object_kind *k = &k_info[idx];
+
+		raw_put(r, k, sizeof(*k));
+		raw_put_str(r, k->name);
+		raw_put_str(r, k->text);
+		raw_put_u32(r, k->next ? k->next - k_info + 1 : 0);
+		raw_put_u32(r, k->base ? k->base - kb_info + 1 : 0);
+	}
+}
+
+static void load_k(struct raw *r)
+{
+	int idx;
+
+	z_info->k_max = raw_get_u32(r);
+	k_info = mem_zalloc(z_info->k_max * sizeof(*k_info));
+	for (idx = 0; idx < z_info->k_max; idx++) {
+		struct object_kind *k = &k_info[idx];
+		u32b next, base;
+
+		raw_get(r, k, sizeof(*k));
+		k->name = raw_get_str(r);
+		k->text = raw_get_str(r);
+		next = raw_get_ref(r, z_info->k_max);
+		base = raw_get_ref(r, TV_MAX);
+		k->next = next ? &k_info[next - 1] : NULL;
+		k->base = base ? &kb_info[base - 1] : NULL;
+		k->flavor = NULL;
+	}
+}
+
 struct file_parser k_parser = {
 	"object",
 	init_parse_k,
 	run_parse_k,
 	finish_parse_k,
-	cleanup_k
+	cleanup_k,
+	save_k,
+	load_k
 };
 
 /* Parsing functions for artifact.txt */
@@ -897,12 +973,49 @@ static void cleanup_a(void)
 	mem_free(a_info);
 }
 
+static void save_a(struct raw *r)
+{
+	int idx;
+
+	raw_put_u32(r, z_info->a_max);
+	for (idx = 0; idx < z_info->a_max; idx++) {
+		struct artifact *a = &a_info[idx];
+
+		raw_put(r, a, sizeof(*a));
+		raw_put_str(r, a->name);
+		raw_put_str(r, a->text);
+		raw_put_str(r, a->effect_msg);
+		raw_put_u32(r, a->next ? a->next - a_info + 1 : 0);
+	}
+}
+
+static void load_a(struct raw *r)
+{
+	int idx;
+
+	z_info->a_max = raw_get_u32(r);
+	a_info = mem_zalloc(z_info->a_max * sizeof(*a_info));
+	for (idx = 0; idx < z_info->a_max; idx++) {
+		struct artifact *a = &a_info[idx];
+		u32b next;
+
+		raw_get(r, a, sizeof(*a));
+		a->name = raw_get_str(r);
+		a->text = raw_get_str(r);
+		a->effect_msg = raw_get_str(r);
+		next = raw_get_ref(r, z_info->a_max);
+		a->next = next ? &a_info[next - 1] : NULL;
+	}
+}
+
 struct file_parser a_parser = {
 	"artifact",
 	init_parse_a,
 	run_parse_a,
 	finish_parse_a,
-	cleanup_a
+	cleanup_a,
+	save_a,
+	load_a
 };
 
 /* Parsing functions for names.txt (random name fragments) */
@@ -1188,12 +1301,45 @@ static void cleanup_f(void) {
 	mem_free(f_info);
 }
 
+static void save_f(struct raw *r)
+{
+	int idx;
+
+	raw_put_u32(r, z_info->f_max);
+	for (idx = 0; idx < z_info->f_max; idx++) {
+		struct feature *f = &f_info[idx];
+
+		raw_put(r, f, sizeof(*f));
+		raw_put_str(r, f->name);
+		raw_put_u32(r, f->next ? f->next - f_info + 1 : 0);
+	}
+}
+
+static void load_f(struct raw *r)
+{
+	int idx;
+
+	z_info->f_max = raw_get_u32(r);
+	f_info = mem_zalloc(z_info->f_max * sizeof(*f_info));
+	for (idx = 0; idx < z_info->f_max; idx++) {
+		struct feature *f = &f_info[idx];
+		u32b next;
+
+		raw_get(r, f, sizeof(*f));
+		f->name = raw_get_str(r);
+		next = raw_get_ref(r, z_info->f_max);
+		f->next = next ? &f_info[next - 1] : NULL;
+	}
+}
+
 struct file_parser f_parser = {
 	"terrain",
 	init_parse_f,
 	run_parse_f,
 	finish_parse_f,
-	cleanup_f
+	cleanup_f,
+	save_f,
+	load_f
 };
 
 /* Parsing functions for ego-item.txt */
@@ -1439,12 +1585,51 @@ static void cleanup_e(void)
 	free_slay_cache();
 }
 
+static void save_e(struct raw *r)
+{
+	int idx;
+
+	raw_put_u32(r, z_info->e_max);
+	for (idx = 0; idx < z_info->e_max; idx++) {
+		struct ego_item *e = &e_info[idx];
+
+		raw_put(r, e, sizeof(*e));
+		raw_put_str(r, e->name);
+		raw_put_str(r, e->text);
+		raw_put_u32(r, e->next ? e->next - e_info + 1 : 0);
+	}
+}
+
+static void load_e(struct raw *r)
+{
+	int idx;
+
+	z_info->e_max = raw_get_u32(r);
+	e_info = mem_zalloc(z_info->e_max * sizeof(*e_info));
+	for (idx = 0; idx < z_info->e_max; idx++) {
+		struct ego_item *e = &e_info[idx];
+		u32b next;
+
+		raw_get(r, e, sizeof(*e));
+		e->name = raw_get_str(r);
+		e->text = raw_get_str(r);
+		next = raw_get_ref(r, z_info->e_max);
+		e->next = next ? &e_info[next - 1] : NULL;
+	}
+
+	/* The slay cache is quick to make again */
+	if (!r->bad)
+		create_slay_cache(e_info);
+}
+
 struct file_parser e_parser = {
 	"ego_item",
 	init_parse_e,
 	run_parse_e,
 	finish_parse_e,
-	cleanup_e
+	cleanup_e,
+	save_e,
+	load_e
 };
 
 /* Parsing functions for prace.txt */
@@ -1946,6 +2131,7 @@ static errr run_parse_v(struct parser *p) {
 
 static errr finish_parse_v(struct parser *p) {
 	vaults = parser_priv(p);
+	vault_plans_init();
 	parser_destroy(p);
 	return 0;
 }
@@ -1953,6 +2139,8 @@ static errr finish_parse_v(struct parser *p) {
 static void cleanup_v(void)
 {
 	struct vault *v, *next;
+
+	vault_plans_free();
 	for (v = vaults; v; v = next) {
 		next = v->next;
 		mem_free(v->name);
@@ -1961,12 +2149,53 @@ static void cleanup_v(void)
 	}
 }
 
+static void save_v(struct raw *r)
+{
+	struct vault *v;
+	u32b count = 0;
+
+	for (v = vaults; v; v = v->next)
+		count++;
+
+	raw_put_u32(r, count);
+	for (v = vaults; v; v = v->next) {
+		raw_put(r, v, sizeof(*v));
+		raw_put_str(r, v->name);
+		raw_put_str(r, v->text);
+	}
+}
+
+static void load_v(struct raw *r)
+{
+	struct vault **last = &vaults;
+	u32b count = raw_get_u32(r);
+
+	/* Keep the vaults in the same order */
+	vaults = NULL;
+	while (count-- && !r->bad) {
+		struct vault *v = mem_zalloc(sizeof(*v));
+
+		raw_get(r, v, sizeof(*v));
+		v->name = raw_get_str(r);
+		v->text = raw_get_str(r);
+		v->next = NULL;
+		v->plan = NULL;
+
+		*last = v;
+		last = &v->next;
+	}
+
+	vault_plans_init();
+}
+
 struct file_parser v_parser = {
 	"vault",
 	init_parse_v,
 	run_parse_v,
 	finish_parse_v,
-	cleanup_v
+	cleanup_v,
+	save_v,
+	load_v
 };
 
 /* Parsing functions for p_hist.txt */
@@ -2961,6 +3190,180 @@ static errr init_alloc(void)
 	return (0);
 }
 
+/*
+ * The edit cache keeps the arrays made from the files in lib/edit in binary
+ * form, in the user directory, so that the next start need not parse them
+ * again.  It is only used when it is newer than every file it was made from,
+ * and when it was written by the same build of the game with the same
+ * structure layout and the same flag lists, since it holds the structures
+ * exactly as they are laid out in memory, with flags and effects as indexes
+ * into those lists.  A game built without a BUILD_ID cannot tell its parsers
+ * from another build's, so never uses the cache.
+ */
+#define EDIT_CACHE_NAME		"edit.raw"
+#define EDIT_CACHE_MAGIC	0x41524157UL
+#define EDIT_CACHE_MAX		(64L * 1024L * 1024L)
+
+struct edit_cache_header {
+	u32b magic;
+	char version[32];
+	u32b layout;
+	u32b lists;
+	u32b len;
+	u32b sum;
+};
+
+/* The parsers which can use the cache */
+static struct file_parser *edit_cache_parsers[] = {
+	&z_parser, &f_parser, &kb_parser, &k_parser, &e_parser, &a_parser,
+	&rb_parser, &r_parser, &v_parser, NULL
+};
+
+/* The names in every list the parsers turn into flag or effect indexes */
+static const char *edit_cache_lists[] = {
+	#define OF(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q, r, s) #a,
+	#include "object/list-object-flags.h"
+	#undef OF
+	"",
+	#define EFFECT(x, y, r, z) #x,
+	#include "list-effects.h"
+	#undef EFFECT
+	"",
+	#define RF(a, b) #a,
+	#include "monster/list-mon-flags.h"
+	#undef RF
+	"",
+	#define RSF(a, b, c, d, e, f, g, h, i, j, k, l, m) #a,
+	#include "monster/list-mon-spells.h"
+	#undef RSF
+	"",
+	#define RBM(a, b) #a,
+	#include "monster/list-blow-methods.h"
+	#undef RBM
+	"",
+	#define RBE(a, b) #a,
+	#include "monster/list-blow-effects.h"
+	#undef RBE
+};
+
+/* FNV-1a, to catch a file cut short or damaged */
+static u32b edit_cache_hash(u32b h, const byte *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= buf[i];
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+static void edit_cache_header(struct edit_cache_header *h, const struct raw *r)
+{
+	/* The sizes of everything stored in the cache */
+	u32b sizes[] = {
+		sizeof(void *), sizeof(maxima), sizeof(struct feature),
+		sizeof(object_base), sizeof(struct object_kind),
+		sizeof(struct ego_item), sizeof(struct artifact),
+		sizeof(struct monster_base), sizeof(struct monster_race),
+		sizeof(struct monster_drop), sizeof(struct vault)
+	};
+
+	size_t i;
+
+	memset(h, 0, sizeof(*h));
+	h->magic = EDIT_CACHE_MAGIC;
+	my_strcpy(h->version, VERSION_STRING, sizeof(h->version));
+	h->layout = edit_cache_hash(2166136261UL, (const byte *)sizes,
+		sizeof(sizes));
+
+	/* Each name with its terminator, so the boundaries count too */
+	h->lists = 2166136261UL;
+	for (i = 0; i < N_ELEMENTS(edit_cache_lists); i++)
+		h->lists = edit_cache_hash(h->lists,
+			(const byte *)edit_cache_lists[i],
+			strlen(edit_cache_lists[i]) + 1);
+	h->len = r->len;
+	h->sum = edit_cache_hash(2166136261UL, r->buf, r->len);
+}
+
+/*
+ * Read the edit cache into `r`, if it is up to date
+ */
+static bool edit_cache_read(struct raw *r)
+{
+	struct edit_cache_header want, have;
+	char path[1024], src[1024];
+	ang_file *fh;
+	int i;
+
+	/* Rebalancing monsters changes what the parsers make */
+	if (arg_rebalance) return FALSE;
+
+	/* Without a build id, another build's cache can't be told apart */
+#ifndef BUILD_ID
+	return FALSE;
+#endif
+
+	path_build(path, sizeof(path), ANGBAND_DIR_USER, EDIT_CACHE_NAME);
+	for (i = 0; edit_cache_parsers[i]; i++) {
+		path_build(src, sizeof(src), ANGBAND_DIR_EDIT,
+			format("%s.txt", edit_cache_parsers[i]->name));
+		if (!file_newer(path, src)) return FALSE;
+	}
+
+	fh = file_open(path, MODE_READ, -1);
+	if (!fh) return FALSE;
+
+	/* Read the whole thing in one block */
+	if (file_read(fh, (char *)&have, sizeof(have)) == sizeof(have) &&
+			have.magic == EDIT_CACHE_MAGIC && have.len < EDIT_CACHE_MAX) {
+		r->buf = mem_alloc(MAX(have.len, 1));
+		r->len = r->size = have.len;
+		if (file_read(fh, (char *)r->buf, have.len) != (int)have.len)
+			r->len = 0;
+	}
+	file_close(fh);
+
+	edit_cache_header(&want, r);
+	if (!r->len || memcmp(&want, &have, sizeof(want))) {
+		raw_free(r);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Write the arrays saved in `r` out as the edit cache
+ */
+static void edit_cache_write(const struct raw *r)
+{
+	struct edit_cache_header h;
+	char path[1024];
+	ang_file *fh;
+
+	if (arg_rebalance || !r->len) return;
+
+#ifndef BUILD_ID
+	return;
+#endif
+
+	path_build(path, sizeof(path), ANGBAND_DIR_USER, EDIT_CACHE_NAME);
+	fh = file_open(path, MODE_WRITE, FTYPE_RAW);
+	if (!fh) return;
+
+	edit_cache_header(&h, r);
+	if (!file_write(fh, (const char *)&h, sizeof(h)) ||
+			!file_write(fh, (const char *)r->buf, r->len)) {
+		file_close(fh);
+		file_delete(path);
+		return;
+	}
+	file_close(fh);
+}
+
 /*
  * Initialise just the internal arrays.
  * This should be callable by the test suite, without relying on input, or
@@ -2970,6 +3373,17 @@ static errr init_alloc(void)
  */
 void init_arrays(void)
 {
+	struct raw cache;
+	bool cached;
+
+	/* Use the edit cache if it is good, and otherwise make a new one */
+	memset(&cache, 0, sizeof(cache));
+	cached = edit_cache_read(&cache);
+	if (cached)
+		parser_set_cache(&cache, NULL);
+	else
+		parser_set_cache(NULL, &cache);
+
 	/* Initialize size info */
 	event_signal_string(EVENT_INITSTATUS, "Initializing array sizes...");
 	if (run_parser(&z_parser)) quit("Cannot initialize sizes");
@@ -3046,6 +3460,19 @@ void init_arrays(void)
 	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (random names)");
 	if (run_parser(&names_parser)) quit("Can't parse names");
 
+	/* Done with the cache; one which failed to load is made again */
+	parser_set_cache(NULL, NULL);
+	if (!cached || cache.bad) {
+		char path[1024];
+
+		path_build(path, sizeof(path), ANGBAND_DIR_USER, EDIT_CACHE_NAME);
+		if (cached)
+			file_delete(path);
+		else
+			edit_cache_write(&cache);
+	}
+	raw_free(&cache);
+
 	/* Initialize some other arrays */
 	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (other)");
 	if (init_other()) quit("Cannot initialize other stuff");
@@ -3165,6 +3592,7 @@ void cleanup_angband(void)
 	free_obj_alloc();
 	FREE(alloc_ego_table);
 	FREE(alloc_race_table);
+	get_mon_num_free();
 
 	event_remove_all_handlers();
 
@@ -3184,6 +3612,7 @@ void cleanup_angband(void)
 	/* Free the temp array */
 	FREE(temp_g);
 
+	cave_pregen_forget();
 	cave_free(cave);
 
 	/* Free the stacked monster messages */
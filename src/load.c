@@ -674,9 +674,9 @@ int rd_randomizer(void)
 
 
 /*
- * Read options, version 2.
+ * Read options, version 2 or later (version 3 added the distant range).
  */
-int rd_options_2(void)
+static int rd_options(int version)
 {
 	int i, n;
 
@@ -702,6 +702,12 @@ int rd_options_2(void)
 	rd_u16b(&tmp16u);
 	lazymove_delay = (tmp16u < 1000) ? tmp16u : 0;
 
+	/* Read the distant monster range */
+	if (version >= 3) {
+		rd_byte(&b);
+		op_ptr->distant_range = b;
+	}
+
 
 	/*** Normal Options ***/
 
@@ -748,6 +754,9 @@ int rd_options_2(void)
 	return 0;
 }
 
+int rd_options_3(void) { return rd_options(3); }
+int rd_options_2(void) { return rd_options(2); }
+
 
 static const struct {
 	int num;
@@ -1009,6 +1018,9 @@ int rd_monster_memory_2(void)
 		/* Repair the spell lore flags */
 		rsf_inter(l_ptr->spell_flags, r_ptr->spell_flags);
 	}
+
+	/* Uniques may have been killed */
+	get_mon_num_invalidate();
 	
 	return 0;
 }
@@ -1082,6 +1094,9 @@ int rd_monster_memory_1(void)
 		/* Repair the spell lore flags */
 		rsf_inter(l_ptr->spell_flags, r_ptr->spell_flags);
 	}
+
+	/* Uniques may have been killed */
+	get_mon_num_invalidate();
 	
 	return 0;
 }
@@ -1975,9 +1990,9 @@ int rd_stores_1(void) { return rd_stores(rd_item_1); } /* remove post-3.3 */
  * The monsters/objects must be loaded in the same order
  * that they were stored, since the actual indexes matter.
  *
- * Note that the size of the dungeon is now hard-coded to
- * DUNGEON_HGT by DUNGEON_WID, and any dungeon with another
- * size will be silently discarded by this routine.
+ * Version 2 saves only the squares of the level, which is as large as
+ * its height and width say.  Version 1 saved the largest level there
+ * could be whatever its size, so such a level is given that size.
  *
  * Note that dungeon objects, including objects held by monsters, are
  * placed directly into the dungeon, using "object_copy()", which will
@@ -1987,7 +2002,7 @@ int rd_stores_1(void) { return rd_stores(rd_item_1); } /* remove post-3.3 */
  * After loading the monsters, the objects being held by monsters are
  * linked directly into those monsters.
  */
-int rd_dungeon(void)
+static int rd_dungeon(int version)
 {
 	int i, y, x;
 
@@ -2023,12 +2038,25 @@ int rd_dungeon(void)
 		return (0);
 	}
 
-	cave->width = xmax;
-	cave->height = ymax;
+	if (version < 2)
+	{
+		ymax = DUNGEON_HGT;
+		xmax = DUNGEON_WID;
+	}
 
 	/* Ignore illegal dungeons */
-	if ((px < 0) || (px >= DUNGEON_WID) ||
-	    (py < 0) || (py >= DUNGEON_HGT))
+	if ((ymax < 1) || (ymax > DUNGEON_HGT) ||
+	    (xmax < 1) || (xmax > DUNGEON_WID))
+	{
+		note(format("Ignoring illegal dungeon size (%d,%d)", ymax, xmax));
+		return (-1);
+	}
+
+	cave_set_dimensions(cave, ymax, xmax);
+
+	/* Ignore illegal dungeons */
+	if ((px < 0) || (px >= xmax) ||
+	    (py < 0) || (py >= ymax))
 	{
 		note(format("Ignoring illegal player location (%d,%d).", py, px));
 		return (1);
@@ -2038,7 +2066,7 @@ int rd_dungeon(void)
 	/*** Run length decoding ***/
 
 	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
+	for (x = y = 0; y < ymax; )
 	{
 		/* Grab RLE info */
 		rd_byte(&count);
@@ -2051,19 +2079,19 @@ int rd_dungeon(void)
 			cave->info[y][x] = tmp8u;
 
 			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			if (++x >= xmax)
 			{
 				/* Wrap */
 				x = 0;
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++y >= ymax) break;
 			}
 		}
 	}
 
 	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
+	for (x = y = 0; y < ymax; )
 	{
 		/* Grab RLE info */
 		rd_byte(&count);
@@ -2076,13 +2104,13 @@ int rd_dungeon(void)
 			cave->info2[y][x] = tmp8u;
 
 			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			if (++x >= xmax)
 			{
 				/* Wrap */
 				x = 0;
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++y >= ymax) break;
 			}
 		}
 	}
@@ -2091,7 +2119,7 @@ int rd_dungeon(void)
 	/*** Run length decoding ***/
 
 	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
+	for (x = y = 0; y < ymax; )
 	{
 		/* Grab RLE info */
 		rd_byte(&count);
@@ -2104,13 +2132,13 @@ int rd_dungeon(void)
 			cave_set_feat(cave, y, x, tmp8u);
 
 			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			if (++x >= xmax)
 			{
 				/* Wrap */
 				x = 0;
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++y >= ymax) break;
 			}
 		}
 	}
@@ -2139,6 +2167,9 @@ int rd_dungeon(void)
 	return 0;
 }
 
+int rd_dungeon_2(void) { return rd_dungeon(2); }
+int rd_dungeon_1(void) { return rd_dungeon(1); }
+
 /* Read the floor object list */
 static int rd_objects(rd_item_t rd_item_version)
 {
@@ -2211,6 +2242,7 @@ static int rd_objects(rd_item_t rd_item_version)
 
 			/* Link the floor to the object */
 			cave->o_idx[y][x] = o_idx;
+			cave_note_empty(cave, y, x);
 		}
 	}
 
@@ -2691,7 +2723,8 @@ int rd_monsters_5(void)
 }
 
 /**
- * Read monsters (added m_ptr->mimicked_o_idx)
+ * Read monsters (added m_ptr->mimicked_o_idx, and in version 7
+ * m_ptr->lod_turns in the spare byte, which older versions left as 0)
  */
 int rd_monsters_6(void)
 {
@@ -2747,7 +2780,7 @@ int rd_monsters_6(void)
 			rd_byte(&m_ptr->known_pflags[j]);
 		if (j < OF_BYTES) strip_bytes(OF_BYTES - j);
 		
-		strip_bytes(1);
+		rd_byte(&m_ptr->lod_turns);
 
 		/* Place monster in dungeon */
 		if (place_monster(m_ptr->fy, m_ptr->fx, m_ptr, 0) != i)
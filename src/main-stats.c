@@ -22,6 +22,7 @@
 
 #include "birth.h"
 #include "buildid.h"
+#include "generate.h"
 #include "init.h"
 #include "monster/mon-make.h"
 #include "object/pval.h"
@@ -53,6 +54,7 @@ static u32b num_runs = 1;
 static bool quiet = FALSE;
 static int nextkey = 0;
 static int running_stats = 0;
+static bool gen_only = FALSE;
 static char *ANGBAND_DIR_STATS;
 
 static int *consumables_index;
@@ -251,6 +253,8 @@ static void kill_all_monsters(int level)
 		if (rf_has(r_ptr->flags, RF_UNIQUE))
 			r_ptr->max_num = 0;
 	}
+
+	get_mon_num_invalidate();
 }
 
 static void unkill_uniques(void)
@@ -268,6 +272,8 @@ static void unkill_uniques(void)
 		if (rf_has(r_ptr->flags, RF_UNIQUE))
 			r_ptr->max_num = 1;
 	}
+
+	get_mon_num_invalidate();
 }
 
 static void reset_artifacts(void)
@@ -288,8 +294,8 @@ static void log_all_objects(int level)
 {
 	int x, y, i;
 
-	for (y = 1; y < DUNGEON_HGT - 1; y++) {
-		for (x = 1; x < DUNGEON_WID - 1; x++) {
+	for (y = 1; y < cave->height - 1; y++) {
+		for (x = 1; x < cave->width - 1; x++) {
 			object_type *o_ptr = get_first_object(y, x);
 
 			if (o_ptr) do {
@@ -1664,6 +1670,170 @@ static errr run_stats(void)
 	exit(0);
 }
 
+/**
+ * Add one set of generation statistics to another, matching builders by name.
+ */
+static void gen_stats_add_builders(struct gen_builder_stats *to,
+	const struct gen_builder_stats *from)
+{
+	int i, j;
+
+	for (i = 0; i < GEN_STATS_BUILDERS && from[i].name; i++) {
+		for (j = 0; j < GEN_STATS_BUILDERS; j++)
+			if (!to[j].name || to[j].name == from[i].name) break;
+		if (j == GEN_STATS_BUILDERS) continue;
+
+		to[j].name = from[i].name;
+		to[j].tries += from[i].tries;
+		to[j].fails += from[i].fails;
+		to[j].rejects += from[i].rejects;
+		to[j].time += from[i].time;
+	}
+}
+
+static void gen_stats_add(struct gen_stats *to, const struct gen_stats *from)
+{
+	to->levels += from->levels;
+	to->too_many_objects += from->too_many_objects;
+	to->too_many_monsters += from->too_many_monsters;
+	to->time += from->time;
+	to->time_clear += from->time_clear;
+	to->time_quests += from->time_quests;
+	to->time_feeling += from->time_feeling;
+	gen_stats_add_builders(to->profiles, from->profiles);
+	gen_stats_add_builders(to->rooms, from->rooms);
+	to->find_calls += from->find_calls;
+	to->find_probes += from->find_probes;
+	to->find_fails += from->find_fails;
+	to->alloc_calls += from->alloc_calls;
+	to->alloc_probes += from->alloc_probes;
+	to->alloc_fails += from->alloc_fails;
+}
+
+/**
+ * Write a table of builder statistics.
+ */
+static void gen_stats_dump_builders(ang_file *f, const char *title,
+	const struct gen_builder_stats *list)
+{
+	int i;
+
+	file_putf(f, "\n%-16s %9s %9s %9s %10s %10s\n", title, "tries", "fails",
+		"rejects", "total ms", "ms/try");
+
+	for (i = 0; i < GEN_STATS_BUILDERS && list[i].name; i++) {
+		const struct gen_builder_stats *b = &list[i];
+
+		file_putf(f, "%-16s %9lu %9lu %9lu %10.1f %10.3f\n", b->name,
+			(unsigned long)b->tries, (unsigned long)b->fails,
+			(unsigned long)b->rejects, b->time * 1000.0,
+			b->tries ? b->time * 1000.0 / b->tries : 0.0);
+	}
+}
+
+static double gen_ratio(u32b a, u32b b)
+{
+	return b ? (double)a / b : 0.0;
+}
+
+/**
+ * Write the report on level generation.
+ */
+static void gen_stats_dump(ang_file *f, struct gen_stats *depths, int max)
+{
+	struct gen_stats total;
+	int level;
+
+	WIPE(&total, struct gen_stats);
+
+	file_putf(f, "Level generation, %d levels per depth\n\n", num_runs);
+	file_putf(f, "%5s %9s %9s %9s %9s %9s %9s\n", "depth", "ms/level",
+		"restarts", "objects", "monsters", "probes", "tries");
+
+	for (level = 1; level < max; level++) {
+		struct gen_stats *s = &depths[level];
+
+		file_putf(f, "%5d %9.3f %9lu %9lu %9lu %9.1f %9.1f\n", level,
+			s->levels ? s->time * 1000.0 / s->levels : 0.0,
+			(unsigned long)(s->too_many_objects + s->too_many_monsters),
+			(unsigned long)s->too_many_objects,
+			(unsigned long)s->too_many_monsters,
+			gen_ratio(s->find_probes, s->find_calls),
+			gen_ratio(s->alloc_probes, s->alloc_calls));
+
+		gen_stats_add(&total, s);
+	}
+
+	file_putf(f, "\n(probes: squares tested per search for an empty square;"
+		" tries: searches per random placement)\n");
+
+	file_putf(f, "\n%lu levels in %.1f ms: %.1f ms clearing, %.1f ms placing"
+		" quest monsters, %.1f ms rating\n", (unsigned long)total.levels,
+		total.time * 1000.0, total.time_clear * 1000.0,
+		total.time_quests * 1000.0, total.time_feeling * 1000.0);
+	file_putf(f, "%lu empty-square searches testing %lu squares, %lu failed\n",
+		(unsigned long)total.find_calls, (unsigned long)total.find_probes,
+		(unsigned long)total.find_fails);
+	file_putf(f, "%lu random placements making %lu searches, %lu failed\n",
+		(unsigned long)total.alloc_calls, (unsigned long)total.alloc_probes,
+		(unsigned long)total.alloc_fails);
+
+	gen_stats_dump_builders(f, "profile", total.profiles);
+	gen_stats_dump_builders(f, "room", total.rooms);
+}
+
+/**
+ * Generate num_runs levels at every depth, and report where the time goes.
+ */
+static errr run_gen_stats(void)
+{
+	static struct gen_stats depths[LEVEL_MAX];
+	char buf[1024];
+	ang_file *f;
+	u32b run;
+	int level;
+	time_t start;
+
+	prep_output_dir();
+
+	start = time(NULL);
+	for (run = 1; run <= num_runs; run++) {
+		if (!quiet) progress_bar(run - 1, start);
+
+		initialize_character();
+		unkill_uniques();
+		reset_artifacts();
+
+		for (level = 1; level < LEVEL_MAX; level++) {
+			dungeon_change_level(level);
+
+			gen_stats = &depths[level];
+			cave_generate(cave, p_ptr);
+			gen_stats = NULL;
+		}
+
+		stats_cleanup_angband_run();
+	}
+
+	if (!quiet) {
+		progress_bar(num_runs, start);
+		printf("\n");
+	}
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_STATS, "generate.txt");
+	f = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+	if (!f) quit_fmt("Couldn't write %s!", buf);
+	gen_stats_dump(f, depths, LEVEL_MAX);
+	file_close(f);
+
+	if (!quiet) printf("Wrote %s\n", buf);
+
+	string_free(ANGBAND_DIR_STATS);
+	cleanup_angband();
+	quit(NULL);
+	exit(0);
+}
+
 typedef struct term_data term_data;
 struct term_data {
 	term t;
@@ -1712,7 +1882,7 @@ static errr term_xtra_event(int v) {
 		return 0;
 	}
 	running_stats = 1;
-	return run_stats();
+	return gen_only ? run_gen_stats() : run_stats();
 }
 
 static errr term_xtra_flush(int v) {
@@ -1786,17 +1956,18 @@ static void term_data_link(int i) {
 	angband_term[i] = t;
 }
 
-const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling)";
+const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -g(eneration only)";
 
 /*
  * Usage:
  *
- * angband -mstats -- [-q] [-r] [-nNNNN] [-s]
+ * angband -mstats -- [-q] [-r] [-nNNNN] [-s] [-g]
  *
  *   -q      Quiet mode (turn off progress messages)
  *   -r      Turn on randarts
  *   -nNNNN  Make NNNN runs through the dungeon (default: 1)
  *   -s      Turn on no-selling
+ *   -g      Only time level generation, writing stats/generate.txt
  */
 
 errr init_stats(int argc, char *argv[]) {
@@ -1820,6 +1991,10 @@ errr init_stats(int argc, char *argv[]) {
 			no_selling = 1;
 			continue;
 		}
+		if (streq(argv[i], "-g")) {
+			gen_only = TRUE;
+			continue;
+		}
 		printf("init-stats: bad argument '%s'\n", argv[i]);
 	}
 
@@ -86,6 +86,8 @@ enum
 
 #define rf_has(f, flag)        flag_has_dbg(f, RF_SIZE, flag, #f, #flag)
 #define rf_next(f, flag)       flag_next(f, RF_SIZE, flag)
+#define rf_count(f)            flag_count(f, RF_SIZE)
+#define rf_list(f, list)       flag_list(f, RF_SIZE, list)
 #define rf_is_empty(f)         flag_is_empty(f, RF_SIZE)
 #define rf_is_full(f)          flag_is_full(f, RF_SIZE)
 #define rf_is_inter(f1, f2)    flag_is_inter(f1, f2, RF_SIZE)
@@ -20,6 +20,7 @@
 #include "attack.h"
 #include "cave.h"
 #include "monster/mon-make.h"
+#include "monster/mon-sched.h"
 #include "monster/mon-spell.h"
 #include "monster/mon-timed.h"
 #include "monster/mon-util.h"
@@ -202,9 +203,9 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 	int num = 0;
-	byte spells[RSF_MAX];
+	int spells[RSF_MAX];
 
-	int i, py = p_ptr->py, px = p_ptr->px;
+	int py = p_ptr->py, px = p_ptr->px;
 
 	bool has_escape, has_attack, has_summon, has_tactic;
 	bool has_annoy, has_haste, has_heal;
@@ -300,10 +301,7 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 	}
 
 	/* Extract all spells: "innate", "normal", "bizarre" */
-	for (i = FLAG_START, num = 0; i < RSF_MAX; i++)
-	{
-		if (rsf_has(f, i)) spells[num++] = i;
-	}
+	num = rsf_list(f, spells);
 
 	/* Paranoia */
 	if (num == 0) return 0;
@@ -642,14 +640,15 @@ static bool get_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 
 	int i, y, x, y1, x1;
 
-	int when = 0;
+	u32b when = 0;
 	int cost = 999;
 
 	monster_type *m_ptr = cave_monster(cave, m_idx);
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 	/* Monster can go through rocks */
-	if (flags_test(r_ptr->flags, RF_SIZE, RF_PASS_WALL, RF_KILL_WALL, FLAG_END)){
+	if (rf_has(r_ptr->flags, RF_PASS_WALL) ||
+			rf_has(r_ptr->flags, RF_KILL_WALL)) {
 	
 	    /* If monster is near a permwall, use normal pathfinding */
 	    if (!near_permwall(m_ptr, c)) return (FALSE);
@@ -661,18 +660,18 @@ static bool get_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 	x1 = m_ptr->fx;
 
 	/* The player is not currently near the monster grid */
-	if (c->when[y1][x1] < c->when[py][px])
+	if (flow_when(c, FLOW_NOISE, y1, x1) < flow_when(c, FLOW_NOISE, py, px))
 	{
 		/* The player has never been near the monster grid */
-		if (c->when[y1][x1] == 0) return (FALSE);
+		if (flow_when(c, FLOW_NOISE, y1, x1) == 0) return (FALSE);
 
 		/* The monster is not allowed to track the player */
 		if (!OPT(birth_ai_smell)) return (FALSE);
 	}
 
 	/* Monster is too far away to notice the player */
-	if (c->cost[y1][x1] > MONSTER_FLOW_DEPTH) return (FALSE);
-	if (c->cost[y1][x1] > r_ptr->aaf) return (FALSE);
+	if (flow_cost(c, FLOW_NOISE, y1, x1) > MONSTER_FLOW_DEPTH) return (FALSE);
+	if (flow_cost(c, FLOW_NOISE, y1, x1) > r_ptr->aaf) return (FALSE);
 
 	/* Hack -- Player can see us, run towards him */
 	if (player_has_los_bold(y1, x1)) return (FALSE);
@@ -685,17 +684,17 @@ static bool get_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 		x = x1 + ddx_ddd[i];
 
 		/* Ignore illegal locations */
-		if (c->when[y][x] == 0) continue;
+		if (flow_when(c, FLOW_NOISE, y, x) == 0) continue;
 
 		/* Ignore ancient locations */
-		if (c->when[y][x] < when) continue;
+		if (flow_when(c, FLOW_NOISE, y, x) < when) continue;
 
 		/* Ignore distant locations */
-		if (c->cost[y][x] > cost) continue;
+		if (flow_cost(c, FLOW_NOISE, y, x) > cost) continue;
 
 		/* Save the cost and time */
-		when = c->when[y][x];
-		cost = c->cost[y][x];
+		when = flow_when(c, FLOW_NOISE, y, x);
+		cost = flow_cost(c, FLOW_NOISE, y, x);
 
 		/* Hack -- Save the "twiddled" location */
 		(*yp) = py + 16 * ddy_ddd[i];
@@ -719,7 +718,8 @@ static bool get_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 static bool get_fear_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 {
 	int y, x, y1, x1, fy, fx, py, px, gy = 0, gx = 0;
-	int when = 0, score = -1;
+	u32b when = 0;
+	int score = -1;
 	int i;
 
 	monster_type *m_ptr = cave_monster(cave, m_idx);
@@ -738,15 +738,15 @@ static bool get_fear_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 	x1 = fx - (*xp);
 
 	/* The player is not currently near the monster grid */
-	if (c->when[fy][fx] < c->when[py][px])
+	if (flow_when(c, FLOW_NOISE, fy, fx) < flow_when(c, FLOW_NOISE, py, px))
 	{
 		/* No reason to attempt flowing */
 		return (FALSE);
 	}
 
 	/* Monster is too far away to use flow information */
-	if (c->cost[fy][fx] > MONSTER_FLOW_DEPTH) return (FALSE);
-	if (c->cost[fy][fx] > r_ptr->aaf) return (FALSE);
+	if (flow_cost(c, FLOW_NOISE, fy, fx) > MONSTER_FLOW_DEPTH) return (FALSE);
+	if (flow_cost(c, FLOW_NOISE, fy, fx) > r_ptr->aaf) return (FALSE);
 
 	/* Check nearby grids, diagonals first */
 	for (i = 7; i >= 0; i--)
@@ -758,16 +758,16 @@ static bool get_fear_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 		x = fx + ddx_ddd[i];
 
 		/* Ignore illegal locations */
-		if (c->when[y][x] == 0) continue;
+		if (flow_when(c, FLOW_NOISE, y, x) == 0) continue;
 
 		/* Ignore ancient locations */
-		if (c->when[y][x] < when) continue;
+		if (flow_when(c, FLOW_NOISE, y, x) < when) continue;
 
 		/* Calculate distance of this grid from our destination */
 		dis = distance(y, x, y1, x1);
 
 		/* Score this grid */
-		s = 5000 / (dis + 3) - 500 / (c->cost[y][x] + 1);
+		s = 5000 / (dis + 3) - 500 / (flow_cost(c, FLOW_NOISE, y, x) + 1);
 
 		/* No negative scores */
 		if (s < 0) s = 0;
@@ -776,7 +776,7 @@ static bool get_fear_moves_aux(struct cave *c, int m_idx, int *yp, int *xp)
 		if (s < score) continue;
 
 		/* Save the score and time */
-		when = c->when[y][x];
+		when = flow_when(c, FLOW_NOISE, y, x);
 		score = s;
 
 		/* Save the location */
@@ -983,10 +983,14 @@ static bool find_safety(struct cave *c, int m_idx, int *yp, int *xp)
 			if (!cave_floor_bold(y, x)) continue;
 
 			/* Ignore grids very far from the player */
-			if (c->when[y][x] < c->when[py][px]) continue;
+			if (flow_when(c, FLOW_NOISE, y, x) <
+					flow_when(c, FLOW_NOISE, py, px))
+				continue;
 
 			/* Ignore too-distant grids */
-			if (c->cost[y][x] > c->cost[fy][fx] + 2 * d) continue;
+			if (flow_cost(c, FLOW_NOISE, y, x) >
+					flow_cost(c, FLOW_NOISE, fy, fx) + 2 * d)
+				continue;
 
 			/* Check for absence of shot (more or less) */
 			if (!player_has_los_bold(y,x))
@@ -1137,7 +1141,8 @@ static bool get_moves(struct cave *c, int m_idx, int mm[5])
 	/* Normal animal packs try to get the player out of corridors. */
 	if (OPT(birth_ai_packs) &&
 	    rf_has(r_ptr->flags, RF_FRIENDS) && rf_has(r_ptr->flags, RF_ANIMAL) &&
-	    !flags_test(r_ptr->flags, RF_SIZE, RF_PASS_WALL, RF_KILL_WALL, FLAG_END))
+	    !rf_has(r_ptr->flags, RF_PASS_WALL) &&
+	    !rf_has(r_ptr->flags, RF_KILL_WALL))
 	{
 		int i, open = 0;
 
@@ -1954,7 +1959,7 @@ static bool make_attack_normal(struct monster *m_ptr, struct player *p)
 							m_ptr->hp += heal;
 
 							/* Redraw (later) if needed */
-							if (p->health_who == m_ptr)
+							if (health_tracked(p) == m_ptr)
 								p->redraw |= (PR_HEALTH);
 
 							/* Combine / Reorder the pack */
@@ -2817,7 +2822,7 @@ static void process_monster(struct cave *c, int m_idx)
 				msg("%s wakes up.", m_name);
 
 				/* Hack -- Update the health bar */
-				if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+				if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 			}
 
 			/* Efficiency XXX XXX */
@@ -2857,7 +2862,7 @@ static void process_monster(struct cave *c, int m_idx)
 					msg("%s wakes up.", m_name);
 
 					/* Hack -- Update the health bar */
-					if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+					if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 					/* Hack -- Count the wakings */
 					if (l_ptr->wake < MAX_UCHAR)
@@ -2979,7 +2984,8 @@ static void process_monster(struct cave *c, int m_idx)
 				rf_on(l_ptr->flags, RF_RAND_25);
 
 			/* Stagger */
-			if (flags_test(r_ptr->flags, RF_SIZE, RF_RAND_25, RF_RAND_50, FLAG_END))
+			if (rf_has(r_ptr->flags, RF_RAND_25) ||
+					rf_has(r_ptr->flags, RF_RAND_50))
 				stagger = TRUE;
 
 		/* Random movement (50%) */
@@ -2995,7 +3001,8 @@ static void process_monster(struct cave *c, int m_idx)
 		/* Random movement (75%) */
 		} else if (roll < 75) {
 			/* Stagger */
-			if (flags_test_all(r_ptr->flags, RF_SIZE, RF_RAND_25, RF_RAND_50, FLAG_END))
+			if (rf_has(r_ptr->flags, RF_RAND_25) &&
+					rf_has(r_ptr->flags, RF_RAND_50))
 				stagger = TRUE;
 		}
 	}
@@ -3417,6 +3424,76 @@ static void process_monster(struct cave *c, int m_idx)
 }
 
 
+/*
+ * Distant monster turns are saved up and taken this many at a time
+ */
+#define MON_LOD_BATCH	4
+
+/*
+ * Take a number of turns of a distant monster at once: its timed effects
+ * wear off, and it may wander one step.  A sleeping monster stays asleep
+ * until the player comes closer.
+ */
+static void process_monster_distant(struct cave *c, int m_idx, int turns,
+		bool wander)
+{
+	monster_type *m_ptr = cave_monster(c, m_idx);
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+	int d, y, x;
+
+	if (m_ptr->m_timed[MON_TMD_SLEEP]) return;
+
+	if (m_ptr->m_timed[MON_TMD_FAST])
+		mon_dec_timed(m_ptr, MON_TMD_FAST, turns, 0, FALSE);
+
+	if (m_ptr->m_timed[MON_TMD_SLOW])
+		mon_dec_timed(m_ptr, MON_TMD_SLOW, turns, 0, FALSE);
+
+	if (m_ptr->m_timed[MON_TMD_STUN]) {
+		/* One "saving throw" for the lot */
+		if (m_ptr->m_timed[MON_TMD_STUN] > turns &&
+				randint0(5000) > turns * r_ptr->level * r_ptr->level)
+			mon_dec_timed(m_ptr, MON_TMD_STUN, turns, MON_TMD_FLG_NOMESSAGE,
+				FALSE);
+		else
+			mon_clear_timed(m_ptr, MON_TMD_STUN, MON_TMD_FLG_NOMESSAGE, FALSE);
+	}
+
+	if (m_ptr->m_timed[MON_TMD_CONF]) {
+		d = damroll(turns, r_ptr->level / 10 + 1);
+
+		if (m_ptr->m_timed[MON_TMD_CONF] > d)
+			mon_dec_timed(m_ptr, MON_TMD_CONF, d, MON_TMD_FLG_NOMESSAGE,
+				FALSE);
+		else
+			mon_clear_timed(m_ptr, MON_TMD_CONF, MON_TMD_FLG_NOMESSAGE, FALSE);
+	}
+
+	if (m_ptr->m_timed[MON_TMD_FEAR]) {
+		d = damroll(turns, r_ptr->level / 10 + 1);
+
+		if (m_ptr->m_timed[MON_TMD_FEAR] > d)
+			mon_dec_timed(m_ptr, MON_TMD_FEAR, d, MON_TMD_FLG_NOMESSAGE,
+				FALSE);
+		else
+			mon_clear_timed(m_ptr, MON_TMD_FEAR, MON_TMD_FLG_NOMESSAGE, FALSE);
+	}
+
+	/* Wander one step, onto empty floor */
+	if (!wander || rf_has(r_ptr->flags, RF_NEVER_MOVE)) return;
+	if (m_ptr->m_timed[MON_TMD_STUN]) return;
+
+	d = randint0(8);
+	y = m_ptr->fy + ddy_ddd[d];
+	x = m_ptr->fx + ddx_ddd[d];
+
+	if (!cave_in_bounds_fully(c, y, x) || !cave_isopen(c, y, x)) return;
+	if (c->feat[y][x] == FEAT_GLYPH) return;
+
+	monster_swap(m_ptr->fy, m_ptr->fx, y, x);
+}
+
+
 static bool monster_can_flow(struct cave *c, int m_idx)
 {
 	monster_type *m_ptr;
@@ -3431,9 +3508,9 @@ static bool monster_can_flow(struct cave *c, int m_idx)
 	fx = m_ptr->fx;
 
 	/* Check the flow (normal aaf is about 20) */
-	if ((c->when[fy][fx] == c->when[p_ptr->py][p_ptr->px]) &&
-	    (c->cost[fy][fx] < MONSTER_FLOW_DEPTH) &&
-	    (c->cost[fy][fx] < r_ptr->aaf))
+	if ((flow_dist(c, FLOW_NOISE, fy, fx) >= 0) &&
+	    (flow_dist(c, FLOW_NOISE, fy, fx) < MONSTER_FLOW_DEPTH) &&
+	    (flow_dist(c, FLOW_NOISE, fy, fx) < r_ptr->aaf))
 		return TRUE;
 	return FALSE;
 }
@@ -3446,7 +3523,7 @@ static bool monster_can_flow(struct cave *c, int m_idx)
  * monster, and allowing fully energized monsters to move, attack, pass, etc.
  *
  * Note that monsters can never move in the monster array (except when the
- * "compact_monsters()" function is called by "dungeon()" or "save_player()").
+ * "compact_monsters()" function reorders it for "save_player()").
  *
  * This function is responsible for at least half of the processor time
  * on a normal system with a "normal" amount of monsters and a player doing
@@ -3463,13 +3540,18 @@ static bool monster_can_flow(struct cave *c, int m_idx)
  */
 void process_monsters(struct cave *c, byte minimum_energy)
 {
-	int i;
+	int i, energy;
+	bool full, hurt;
 
 	monster_type *m_ptr;
 	monster_race *r_ptr;
 
+	/* Find the monsters which have gained enough energy to move */
+	mon_sched_update(c);
+
 	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(c) - 1; i >= 1; i--)
+	for (i = mon_sched_next(c, cave_monster_max(c)); i >= 1;
+			i = mon_sched_next(c, i))
 	{
 		/* Handle "leaving" */
 		if (p_ptr->leaving) break;
@@ -3484,10 +3566,11 @@ void process_monsters(struct cave *c, byte minimum_energy)
 
 
 		/* Not enough energy to move */
-		if (m_ptr->energy < minimum_energy) continue;
+		energy = mon_energy(m_ptr);
+		if (energy < minimum_energy) continue;
 
 		/* Use up "some" energy */
-		m_ptr->energy -= 100;
+		mon_set_energy(c, m_ptr, energy - 100);
 
 
 		/* Heal monster? XXX XXX XXX */
@@ -3502,12 +3585,32 @@ void process_monsters(struct cave *c, byte minimum_energy)
 		 * - is hurt
 		 * - can "see" the player (checked backwards)
 		 * - can "smell" the player from far away (flow)
+		 *
+		 * Monsters which are only hurt, and further away than the distant
+		 * monster range, get a distant update instead.
 		 */
-		if ((m_ptr->cdis <= r_ptr->aaf) ||
-		    (m_ptr->hp < m_ptr->maxhp) ||
-		    player_has_los_bold(m_ptr->fy, m_ptr->fx) ||
-		    monster_can_flow(c, i))
+		full = (m_ptr->cdis <= r_ptr->aaf) ||
+			player_has_los_bold(m_ptr->fy, m_ptr->fx) ||
+			monster_can_flow(c, i);
+		hurt = (m_ptr->hp < m_ptr->maxhp);
+
+		if (!full && hurt && op_ptr->distant_range &&
+				m_ptr->cdis > op_ptr->distant_range)
+		{
+			/* Save up distant turns */
+			if (++m_ptr->lod_turns >= MON_LOD_BATCH) {
+				process_monster_distant(c, i, m_ptr->lod_turns, TRUE);
+				m_ptr->lod_turns = 0;
+			}
+		}
+		else if (full || hurt)
 		{
+			/* Catch up on any distant turns first */
+			if (m_ptr->lod_turns) {
+				process_monster_distant(c, i, m_ptr->lod_turns, FALSE);
+				m_ptr->lod_turns = 0;
+			}
+
 			/* Process the monster */
 			process_monster(c, i);
 		}
@@ -177,12 +177,54 @@ static void cleanup_rb(void)
 	}
 }
 
+static void save_rb(struct raw *r)
+{
+	struct monster_base *rb;
+	u32b count = 0;
+
+	for (rb = rb_info; rb; rb = rb->next)
+		count++;
+
+	raw_put_u32(r, count);
+	for (rb = rb_info; rb; rb = rb->next) {
+		raw_put(r, rb, sizeof(*rb));
+		raw_put_str(r, rb->name);
+		raw_put_str(r, rb->text);
+		raw_put_u32(r, rb->pain ? rb->pain - pain_messages + 1 : 0);
+	}
+}
+
+static void load_rb(struct raw *r)
+{
+	struct monster_base **last = &rb_info;
+	u32b count = raw_get_u32(r);
+
+	/* Keep the bases in the same order, as monsters refer to them by it */
+	rb_info = NULL;
+	while (count-- && !r->bad) {
+		struct monster_base *rb = mem_zalloc(sizeof(*rb));
+		u32b pain;
+
+		raw_get(r, rb, sizeof(*rb));
+		rb->name = raw_get_str(r);
+		rb->text = raw_get_str(r);
+		pain = raw_get_ref(r, z_info->mp_max);
+		rb->pain = pain ? &pain_messages[pain - 1] : NULL;
+		rb->next = NULL;
+
+		*last = rb;
+		last = &rb->next;
+	}
+}
+
 struct file_parser rb_parser = {
 	"monster_base",
 	init_parse_rb,
 	run_parse_rb,
 	finish_parse_rb,
-	cleanup_rb
+	cleanup_rb,
+	save_rb,
+	load_rb
 };
 
 
@@ -590,11 +632,124 @@ static void cleanup_r(void)
 	mem_free(r_info);
 }
 
+/* Position of a monster base in the list, counting from one */
+static u32b rb_ref(const struct monster_base *base)
+{
+	const struct monster_base *rb;
+	u32b ref = 1;
+
+	if (!base) return 0;
+	for (rb = rb_info; rb && rb != base; rb = rb->next)
+		ref++;
+
+	return ref;
+}
+
+static void save_r(struct raw *r)
+{
+	int ridx;
+
+	raw_put_u32(r, z_info->r_max);
+	for (ridx = 0; ridx < z_info->r_max; ridx++) {
+		struct monster_race *race = &r_info[ridx];
+		struct monster_drop *d;
+		struct monster_mimic *m;
+		u32b count;
+
+		raw_put(r, race, sizeof(*race));
+		raw_put_str(r, race->name);
+		raw_put_str(r, race->text);
+		raw_put_u32(r, race->next ? race->next - r_info + 1 : 0);
+		raw_put_u32(r, rb_ref(race->base));
+
+		for (count = 0, d = race->drops; d; d = d->next)
+			count++;
+		raw_put_u32(r, count);
+		for (d = race->drops; d; d = d->next) {
+			raw_put(r, d, sizeof(*d));
+			raw_put_u32(r, d->kind ? d->kind - k_info + 1 : 0);
+			raw_put_u32(r, d->artifact ? d->artifact - a_info + 1 : 0);
+		}
+
+		for (count = 0, m = race->mimic_kinds; m; m = m->next)
+			count++;
+		raw_put_u32(r, count);
+		for (m = race->mimic_kinds; m; m = m->next)
+			raw_put_u32(r, m->kind ? m->kind - k_info + 1 : 0);
+	}
+
+	/* Made by eval_r_power() along with the races' power */
+	raw_put_u32(r, (u32b)tot_mon_power);
+}
+
+static void load_r(struct raw *r)
+{
+	int ridx;
+
+	z_info->r_max = raw_get_u32(r);
+	r_info = mem_zalloc(z_info->r_max * sizeof(*r_info));
+	for (ridx = 0; ridx < z_info->r_max && !r->bad; ridx++) {
+		struct monster_race *race = &r_info[ridx];
+		struct monster_drop **last_drop = &race->drops;
+		struct monster_mimic **last_mimic = &race->mimic_kinds;
+		u32b next, base, count;
+
+		raw_get(r, race, sizeof(*race));
+		race->name = raw_get_str(r);
+		race->text = raw_get_str(r);
+		next = raw_get_ref(r, z_info->r_max);
+		race->next = next ? &r_info[next - 1] : NULL;
+
+		/* Find the base by its place in the list */
+		race->base = NULL;
+		base = raw_get_u32(r);
+		if (base) {
+			race->base = rb_info;
+			while (--base && race->base)
+				race->base = race->base->next;
+			if (!race->base) r->bad = TRUE;
+		}
+
+		race->drops = NULL;
+		count = raw_get_u32(r);
+		while (count-- && !r->bad) {
+			struct monster_drop *d = mem_zalloc(sizeof(*d));
+			u32b kind, art;
+
+			raw_get(r, d, sizeof(*d));
+			kind = raw_get_ref(r, z_info->k_max);
+			art = raw_get_ref(r, z_info->a_max);
+			d->kind = kind ? &k_info[kind - 1] : NULL;
+			d->artifact = art ? &a_info[art - 1] : NULL;
+			d->next = NULL;
+
+			*last_drop = d;
+			last_drop = &d->next;
+		}
+
+		race->mimic_kinds = NULL;
+		count = raw_get_u32(r);
+		while (count-- && !r->bad) {
+			struct monster_mimic *m = mem_zalloc(sizeof(*m));
+			u32b kind = raw_get_ref(r, z_info->k_max);
+
+			m->kind = kind ? &k_info[kind - 1] : NULL;
+
+			*last_mimic = m;
+			last_mimic = &m->next;
+		}
+	}
+
+	tot_mon_power = (s32b)raw_get_u32(r);
+}
+
 struct file_parser r_parser = {
 	"monster",
 	init_parse_r,
 	run_parse_r,
 	finish_parse_r,
-	cleanup_r
+	cleanup_r,
+	save_r,
+	load_r
 };
 
@@ -21,6 +21,8 @@
 #include "target.h"
 #include "monster/mon-lore.h"
 #include "monster/mon-make.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-spatial.h"
 #include "monster/mon-timed.h"
 #include "monster/mon-util.h"
 #include "object/tvalsval.h"
@@ -49,18 +51,19 @@ void delete_monster_idx(int m_idx)
 
 	/* Hack -- Reduce the racial counter */
 	r_ptr->cur_num--;
+	if (r_ptr->cur_num == r_ptr->max_num - 1) get_mon_num_invalidate();
 
 	/* Hack -- count the number of "reproducers" */
 	if (rf_has(r_ptr->flags, RF_MULTIPLY)) num_repro--;
 
-	/* Hack -- remove target monster */
-	if (target_get_monster() == m_idx) target_set_monster(0);
-
-	/* Hack -- remove tracked monster */
-	if (p_ptr->health_who == m_ptr) health_track(p_ptr, NULL);
+	/* Hack -- remove tracked monster (the target just goes stale) */
+	if (health_tracked(p_ptr) == m_ptr) health_track(p_ptr, NULL);
 
 	/* Monster is gone */
 	cave->m_idx[y][x] = 0;
+	cave_note_empty(cave, y, x);
+	mon_sched_remove(cave, m_idx);
+	mon_spatial_remove(cave, m_idx);
 
 	/* Delete objects */
 	for (this_o_idx = m_ptr->hold_o_idx; this_o_idx; this_o_idx = next_o_idx)
@@ -96,6 +99,9 @@ void delete_monster_idx(int m_idx)
 	/* Count monsters */
 	cave->mon_cnt--;
 
+	/* The slot can be reused */
+	slots_give(cave->mon_slots, m_idx);
+
 	/* Visual update */
 	cave_light_spot(cave, y, x);
 }
@@ -120,6 +126,7 @@ void delete_monster(int y, int x)
 static void compact_monsters_aux(int i1, int i2)
 {
 	int y, x;
+	bool target, tracked;
 
 	monster_type *m_ptr;
 
@@ -165,16 +172,19 @@ static void compact_monsters_aux(int i1, int i2)
 		o_ptr->mimicking_m_idx = i2;
 	}
 
-	/* Hack -- Update the target */
-	if (target_get_monster() == i1)
-		target_set_monster(i2);
-
-	/* Hack -- Update the health bar */
-	if (p_ptr->health_who == m_ptr)
-		p_ptr->health_who = cave_monster(cave, i2);
+	/* Note the target and health bar, whose handles go stale in the move */
+	target = (target_get_monster() == i1);
+	tracked = (health_tracked(p_ptr) == m_ptr);
 
 	/* Hack -- move monster */
 	COPY(cave_monster(cave, i2), cave_monster(cave, i1), struct monster);
+	mon_sched_move(cave, i1, i2);
+	mon_spatial_move(cave, i1, i2);
+	slots_retire(cave->mon_slots, i1);
+
+	/* Hack -- Update the target and health bar */
+	if (target) target_set_monster(i2);
+	if (tracked) health_track(p_ptr, cave_monster(cave, i2));
 
 	/* Hack -- wipe hole */
 	(void)WIPE(cave_monster(cave, i1), monster_type);
@@ -188,7 +198,9 @@ static void compact_monsters_aux(int i1, int i2)
  *
  * When `num_to_compact` is 0, we just reorder the monsters into a more compact
  * order, eliminating any "holes" left by dead monsters. If `num_to_compact` is
- * positive, then we delete at least that many monsters and then reorder.
+ * positive, then we delete at least that many monsters, and leave their slots
+ * for mon_pop() to reuse.  Reordering moves monsters to new indices, so it is
+ * only done when asked for, before saving.
  * We try not to delete monsters that are high level or close to the player.
  * Each time we make a full pass through the monster list, if we haven't
  * deleted enough monsters, we relax our bounds a little to accept
@@ -249,6 +261,8 @@ void compact_monsters(int num_to_compact)
 		}
 	}
 
+	/* Leave the holes to be reused */
+	if (num_to_compact) return;
 
 	/* Excise dead monsters (backwards!) */
 	for (m_idx = cave_monster_max(cave) - 1; m_idx >= 1; m_idx--) {
@@ -263,6 +277,9 @@ void compact_monsters(int num_to_compact)
 		/* Compress "cave->mon_max" */
 		cave->mon_max--;
 	}
+
+	/* There are no holes left */
+	slots_reset(cave->mon_slots);
 }
 
 
@@ -294,11 +311,23 @@ void wipe_mon_list(struct cave *c, struct player *p)
 
 		/* Monster is gone */
 		c->m_idx[m_ptr->fy][m_ptr->fx] = 0;
+		cave_note_empty(c, m_ptr->fy, m_ptr->fx);
 
 		/* Wipe the Monster */
 		(void)WIPE(m_ptr, monster_type);
+
+		/* Handles to it are stale */
+		slots_retire(c->mon_slots, m_idx);
 	}
 
+	/* Nobody is left to act */
+	mon_sched_reset(c);
+	mon_spatial_reset(c);
+	slots_reset(c->mon_slots);
+
+	/* Uniques are available again */
+	get_mon_num_invalidate();
+
 	/* Reset "cave->mon_max" */
 	cave->mon_max = 1;
 
@@ -318,41 +347,30 @@ void wipe_mon_list(struct cave *c, struct player *p)
 /**
  * Returns the index of a "free" monster, or 0 if no slot is available.
  *
+ * The slots of dead monsters are kept on a free list, and reused (most
+ * recent first) before the array is expanded, so no search is needed.
+ *
  * This routine should almost never fail, but it *can* happen.
  * The calling code must check for and handle a 0 return.
  */
 static s16b mon_pop(void)
 {
-	int m_idx;
+	/* Recycle a dead monster */
+	int m_idx = slots_take(cave->mon_slots);
 
 	/* Normal allocation */
-	if (cave_monster_max(cave) < z_info->m_max) {
+	if (!m_idx && cave_monster_max(cave) < z_info->m_max) {
 		/* Get the next hole */
 		m_idx = cave_monster_max(cave);
 
 		/* Expand the array */
 		cave->mon_max++;
-
-		/* Count monsters */
-		cave->mon_cnt++;
-
-		return m_idx;
 	}
 
-	/* Recycle dead monsters if we've run out of room */
-	for (m_idx = 1; m_idx < cave_monster_max(cave); m_idx++) {
-		monster_type *m_ptr;
-
-		/* Get the monster */
-		m_ptr = cave_monster(cave, m_idx);
-
-		/* Skip live monsters */
-		if (m_ptr->r_idx) continue;
-
+	if (m_idx) {
 		/* Count monsters */
 		cave->mon_cnt++;
 
-		/* Use this monster */
 		return m_idx;
 	}
 
@@ -367,6 +385,61 @@ static s16b mon_pop(void)
 }
 
 
+/*
+ * Running totals of the "prob3" field of the monster allocation table, as
+ * get_mon_num() would compute it for one level.  "total[i]" is the sum of
+ * the chances of the first "i + 1" entries, so a pick is a binary search.
+ *
+ * The totals depend on the level, on which uniques are still available, on
+ * how many FORCE_DEPTH monsters lie below the current depth, and on the
+ * restriction installed by get_mon_num_prep().  One set is kept for each
+ * level, and for both the unrestricted table and the latest restriction.
+ */
+struct mon_num_cache {
+	u32b serial;	/* Serial the totals were built for, 0 if never built */
+	int depth;		/* Depth which decided FORCE_DEPTH monsters */
+	int n;			/* Number of entries considered */
+	long *total;
+};
+
+static struct mon_num_cache *mon_num_cache[2];
+static int mon_num_levels;
+
+/* Bumped whenever the totals of the unrestricted, or restricted, table change */
+static u32b mon_num_serial[2] = { 1, 1 };
+
+
+/**
+ * Forgets every cached monster allocation total.  This must be called
+ * whenever a unique becomes available or unavailable, that is whenever
+ * "cur_num" crosses "max_num" or "max_num" changes.
+ */
+void get_mon_num_invalidate(void)
+{
+	mon_num_serial[0]++;
+	mon_num_serial[1]++;
+}
+
+/**
+ * Frees the cached monster allocation totals.
+ */
+void get_mon_num_free(void)
+{
+	int i, lev;
+
+	for (i = 0; i < 2; i++) {
+		if (!mon_num_cache[i]) continue;
+
+		for (lev = 0; lev < mon_num_levels; lev++)
+			FREE(mon_num_cache[i][lev].total);
+		FREE(mon_num_cache[i]);
+	}
+
+	mon_num_levels = 0;
+	get_mon_num_invalidate();
+}
+
+
 /**
  * Apply a "monster restriction function" to the "monster allocation table".
  * This way, we can use get_mon_num() to get a level-appropriate monster that
@@ -390,43 +463,116 @@ void get_mon_num_prep(void)
 			entry->prob2 = 0;
 	}
 
+	/* The unrestricted totals are still good when the restriction is lifted */
+	if (get_mon_num_hook) mon_num_serial[1]++;
+
 	return;
 }
 
 /**
- * Helper function for get_mon_num(). Scans the prepared monster allocation
- * table and picks a random monster. Returns the index of a monster in
- * `table`.
+ * Helper function for get_mon_num(). Finds the cached allocation totals for
+ * the given level, building them if needed.
  */
-int get_mon_num_aux(long total, const alloc_entry *table)
+static const struct mon_num_cache *get_mon_num_totals(int level)
+{
+	int which = get_mon_num_hook ? 1 : 0;
+	int depth, i;
+	long total = 0L;
+
+	alloc_entry *table = alloc_race_table;
+	struct mon_num_cache *cache;
+
+	/* Every level past the deepest monster gives the same table */
+	if (!mon_num_levels) {
+		mon_num_levels = table[alloc_race_size - 1].level + 1;
+		mon_num_cache[0] = C_ZNEW(mon_num_levels, struct mon_num_cache);
+		mon_num_cache[1] = C_ZNEW(mon_num_levels, struct mon_num_cache);
+	}
+
+	if (level >= mon_num_levels) level = mon_num_levels - 1;
+	depth = MIN(p_ptr->depth, level);
+
+	cache = &mon_num_cache[which][level];
+	if (cache->serial == mon_num_serial[which] && cache->depth == depth)
+		return cache;
+
+	if (!cache->total) cache->total = C_ZNEW(alloc_race_size, long);
+
+	/* Process probabilities */
+	for (i = 0; i < alloc_race_size; i++) {
+		int r_idx;
+		monster_race *r_ptr;
+
+		/* Monsters are sorted by depth */
+		if (table[i].level > level) break;
+
+		/* Default */
+		cache->total[i] = total;
+
+		/* Hack -- No town monsters in dungeon */
+		if ((level > 0) && (table[i].level <= 0)) continue;
+
+		/* Get the chosen monster */
+		r_idx = table[i].index;
+		r_ptr = &r_info[r_idx];
+
+		/* Hack -- "unique" monsters must be "unique" */
+		if (rf_has(r_ptr->flags, RF_UNIQUE) &&
+				r_ptr->cur_num >= r_ptr->max_num)
+			continue;
+
+		/* Depth Monsters never appear out of depth */
+		if (rf_has(r_ptr->flags, RF_FORCE_DEPTH) &&
+				r_ptr->level > p_ptr->depth)
+			continue;
+
+		/* Accept */
+		total += table[i].prob2;
+		cache->total[i] = total;
+	}
+
+	cache->n = i;
+	cache->depth = depth;
+	cache->serial = mon_num_serial[which];
+
+	return cache;
+}
+
+/**
+ * Helper function for get_mon_num(). Picks a random monster from the
+ * allocation totals. Returns the index of a monster in `alloc_race_table`.
+ *
+ * This finds the same monster as stepping through the table subtracting
+ * each chance from the random value, for the same random value.
+ */
+static int get_mon_num_aux(const struct mon_num_cache *cache)
 {
-	int i;
-	
 	long value;
-	
+	int lo = 0, hi = cache->n - 1;
+
 	/* Pick a monster */
-	value = randint0(total);
+	value = randint0(cache->total[cache->n - 1]);
 
-	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
+	/* Find the first monster whose running total exceeds the value */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
 
-		/* Decrement */
-		value = value - table[i].prob3;
+		if (value < cache->total[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
-	
-	return i;
+
+	return lo;
 }
 
 /**
  * Chooses a monster race that seems "appropriate" to the given level
  *
  * This function uses the "prob2" field of the "monster allocation table",
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an "appropriate" monster, in
- * a relatively efficient manner.
+ * and various local information, to calculate the chance of each monster,
+ * which is then used to choose an "appropriate" monster, in a relatively
+ * efficient manner.  The chances are cached between calls.
  *
  * Note that "town" monsters will *only* be created in the town, and
  * "normal" monsters will *never* be created in the town, unless the
@@ -446,11 +592,7 @@ s16b get_mon_num(int level)
 {
 	int i, j, p;
 
-	int r_idx;
-
-	long total;
-
-	monster_race *r_ptr;
+	const struct mon_num_cache *cache;
 
 	alloc_entry *table = alloc_race_table;
 
@@ -458,45 +600,16 @@ s16b get_mon_num(int level)
 	if (level > 0 && one_in_(NASTY_MON))
 		level += MIN(level / 4 + 2, MON_OOD_MAX);
 
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Monsters are sorted by depth */
-		if (table[i].level > level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* Hack -- No town monsters in dungeon */
-		if ((level > 0) && (table[i].level <= 0)) continue;
+	/* No monsters this shallow */
+	if (level < 0) return (0);
 
-		/* Get the chosen monster */
-		r_idx = table[i].index;
-		r_ptr = &r_info[r_idx];
-
-		/* Hack -- "unique" monsters must be "unique" */
-		if (rf_has(r_ptr->flags, RF_UNIQUE) && 
-				r_ptr->cur_num >= r_ptr->max_num)
-			continue;
-
-		/* Depth Monsters never appear out of depth */
-		if (rf_has(r_ptr->flags, RF_FORCE_DEPTH) && 
-				r_ptr->level > p_ptr->depth)
-			continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
+	cache = get_mon_num_totals(level);
 
 	/* No legal monsters */
-	if (total <= 0) return (0);
+	if (!cache->n || cache->total[cache->n - 1] <= 0) return (0);
 
 	/* Pick a monster */
-	i = get_mon_num_aux(total, table);
+	i = get_mon_num_aux(cache);
 
 	/* Try for a "harder" monster once (50%) or twice (10%) */
 	p = randint0(100);
@@ -506,7 +619,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		i = get_mon_num_aux(total, table);
+		i = get_mon_num_aux(cache);
 
 		/* Keep the deepest one */
 		if (table[i].level < table[j].level) i = j;
@@ -518,7 +631,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		i = get_mon_num_aux(total, table);
+		i = get_mon_num_aux(cache);
 
 		/* Keep the deepest one */
 		if (table[i].level < table[j].level) i = j;
@@ -542,6 +655,7 @@ void player_place(struct cave *c, struct player *p, int y, int x)
 
 	/* Mark cave grid */
 	c->m_idx[y][x] = -1;
+	cave_note_empty(c, y, x);
 }
 
 
@@ -668,6 +782,7 @@ s16b place_monster(int y, int x, monster_type *n_ptr, byte origin)
 
 	/* Notify cave of the new monster */
 	cave->m_idx[y][x] = m_idx;
+	cave_note_empty(cave, y, x);
 
 	/* Copy the monster */
 	m_ptr = cave_monster(cave, m_idx);
@@ -677,7 +792,14 @@ s16b place_monster(int y, int x, monster_type *n_ptr, byte origin)
 	m_ptr->fy = y;
 	m_ptr->fx = x;
 
-	update_mon(m_idx, TRUE);
+	/* Start gaining energy */
+	mon_sched_add(cave, m_idx);
+	mon_spatial_add(cave, m_idx);
+
+	/* A level being made is looked over all at once when play starts on
+	 * it (see dungeon()), so that making it leaves the lore alone */
+	if (character_dungeon)
+		update_mon(m_idx, TRUE);
 
 	/* Get the new race */
 	r_ptr = &r_info[m_ptr->r_idx];
@@ -687,6 +809,7 @@ s16b place_monster(int y, int x, monster_type *n_ptr, byte origin)
 
 	/* Count racial occurrences */
 	r_ptr->cur_num++;
+	if (r_ptr->cur_num == r_ptr->max_num) get_mon_num_invalidate();
 
 	/* Create the monster's drop, if any */
 	if (origin)
@@ -1205,12 +1328,11 @@ bool pick_and_place_distant_monster(struct cave *c, struct loc loc, int dis,
 
 	/* Find a legal, distant, unoccupied, space */
 	while (--attempts_left) {
-		/* Pick a location */
-		y = randint0(c->height);
-		x = randint0(c->width);
-
-		/* Require "naked" floor grid */
-		if (!cave_isempty(c, y, x)) continue;
+		/* Pick a "naked" floor grid, if there are any */
+		if (!cave_pick_empty(c, &y, &x)) {
+			attempts_left = 0;
+			break;
+		}
 
 		/* Accept far away grids */
 		if (distance(y, x, py, px) > dis) break;
@@ -1408,7 +1530,7 @@ bool mon_take_hit(struct monster *m_ptr, int dam, bool *fear, const char *note)
 	l_ptr = &l_list[m_ptr->r_idx];
 
 	/* Redraw (later) if needed */
-	if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+	if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 	/* Wake it up */
 	mon_clear_timed(m_ptr, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, FALSE);
@@ -1485,6 +1607,7 @@ bool mon_take_hit(struct monster *m_ptr, int dam, bool *fear, const char *note)
 		if (rf_has(r_ptr->flags, RF_UNIQUE)) {
 			char unique_name[80];
 			r_ptr->max_num = 0;
+			get_mon_num_invalidate();
 
 			/* 
 			 * This gets the correct name if we slay an invisible 
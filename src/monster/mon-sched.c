@@ -0,0 +1,368 @@
+/*
+ * File: mon-sched.c
+ * Purpose: Monster energy scheduler.
+ *
+ * Copyright (c) 1997-2007 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-timed.h"
+
+/*
+ * Monsters no longer gain energy one game turn at a time.  Instead each
+ * monster remembers the game turn at which its "energy" was last brought up
+ * to date, and its energy at any later turn follows from its speed.  Every
+ * change of speed (haste, slow) brings the energy up to date first.
+ *
+ * A monster with at least 100 energy is "ready" and is kept in a list sorted
+ * by decreasing index, which is the order process_monsters() has always
+ * used.  Every other monster waits in a min-heap keyed on the game turn at
+ * which it will next have 100 energy, so each game turn only costs as much
+ * as the monsters which actually act.
+ */
+struct mon_sched {
+	/* Heap of waiting monsters */
+	s16b *heap;
+	int heap_n;
+
+	/* Ready monsters, by decreasing index */
+	s16b *ready;
+	int ready_n;
+
+	/* Per monster: the turn it becomes ready, and its heap position */
+	s32b *when;
+	s16b *pos;
+};
+
+/*
+ * Heap position of a monster which is not waiting
+ */
+#define SCHED_NONE	-1
+
+
+struct mon_sched *mon_sched_new(int size)
+{
+	struct mon_sched *s = ZNEW(struct mon_sched);
+	int i;
+
+	s->heap = C_ZNEW(size, s16b);
+	s->ready = C_ZNEW(size, s16b);
+	s->when = C_ZNEW(size, s32b);
+	s->pos = C_ZNEW(size, s16b);
+
+	for (i = 0; i < size; i++)
+		s->pos[i] = SCHED_NONE;
+
+	return s;
+}
+
+void mon_sched_free(struct mon_sched *s)
+{
+	FREE(s->heap);
+	FREE(s->ready);
+	FREE(s->when);
+	FREE(s->pos);
+	FREE(s);
+}
+
+
+/*
+ * Energy gained by a monster each game turn, at its current speed
+ */
+static int mon_energy_rate(const struct monster *m_ptr)
+{
+	int mspeed = m_ptr->mspeed;
+
+	if (m_ptr->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (m_ptr->m_timed[MON_TMD_SLOW])
+		mspeed -= 10;
+
+	return extract_energy[mspeed];
+}
+
+/**
+ * Returns the energy a monster has now.
+ */
+int mon_energy(const struct monster *m_ptr)
+{
+	return m_ptr->energy +
+		mon_energy_rate(m_ptr) * (turn - m_ptr->energy_turn);
+}
+
+
+/*** The heap ***/
+
+static bool heap_before(struct mon_sched *s, int a, int b)
+{
+	if (s->when[a] != s->when[b]) return s->when[a] < s->when[b];
+	return a > b;
+}
+
+static void heap_set(struct mon_sched *s, int pos, int m_idx)
+{
+	s->heap[pos] = m_idx;
+	s->pos[m_idx] = pos;
+}
+
+static void heap_up(struct mon_sched *s, int pos)
+{
+	int m_idx = s->heap[pos];
+
+	while (pos > 0)
+	{
+		int parent = (pos - 1) / 2;
+
+		if (!heap_before(s, m_idx, s->heap[parent])) break;
+		heap_set(s, pos, s->heap[parent]);
+		pos = parent;
+	}
+
+	heap_set(s, pos, m_idx);
+}
+
+static void heap_down(struct mon_sched *s, int pos)
+{
+	int m_idx = s->heap[pos];
+
+	while (TRUE)
+	{
+		int child = 2 * pos + 1;
+
+		if (child >= s->heap_n) break;
+		if (child + 1 < s->heap_n &&
+				heap_before(s, s->heap[child + 1], s->heap[child]))
+			child++;
+
+		if (!heap_before(s, s->heap[child], m_idx)) break;
+		heap_set(s, pos, s->heap[child]);
+		pos = child;
+	}
+
+	heap_set(s, pos, m_idx);
+}
+
+static void heap_push(struct mon_sched *s, int m_idx)
+{
+	heap_set(s, s->heap_n++, m_idx);
+	heap_up(s, s->heap_n - 1);
+}
+
+static void heap_remove(struct mon_sched *s, int m_idx)
+{
+	int pos = s->pos[m_idx];
+	int last = s->heap[--s->heap_n];
+
+	s->pos[m_idx] = SCHED_NONE;
+	if (last == m_idx) return;
+
+	heap_set(s, pos, last);
+	heap_up(s, pos);
+	heap_down(s, s->pos[last]);
+}
+
+
+/*** The ready list ***/
+
+/*
+ * Find where a monster is, or would go, in the ready list
+ */
+static int ready_find(struct mon_sched *s, int m_idx)
+{
+	int lo = 0, hi = s->ready_n;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (s->ready[mid] > m_idx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static bool ready_has(struct mon_sched *s, int m_idx)
+{
+	int i = ready_find(s, m_idx);
+
+	return i < s->ready_n && s->ready[i] == m_idx;
+}
+
+static void ready_add(struct mon_sched *s, int m_idx)
+{
+	int i = ready_find(s, m_idx);
+
+	if (i < s->ready_n && s->ready[i] == m_idx) return;
+
+	memmove(&s->ready[i + 1], &s->ready[i],
+			(s->ready_n - i) * sizeof(s->ready[0]));
+	s->ready[i] = m_idx;
+	s->ready_n++;
+}
+
+static void ready_remove(struct mon_sched *s, int m_idx)
+{
+	int i = ready_find(s, m_idx);
+
+	if (i == s->ready_n || s->ready[i] != m_idx) return;
+
+	s->ready_n--;
+	memmove(&s->ready[i], &s->ready[i + 1],
+			(s->ready_n - i) * sizeof(s->ready[0]));
+}
+
+
+/*
+ * Take a monster out of the schedule, wherever it is
+ */
+static void sched_unlink(struct mon_sched *s, int m_idx)
+{
+	if (s->pos[m_idx] != SCHED_NONE)
+		heap_remove(s, m_idx);
+	else
+		ready_remove(s, m_idx);
+}
+
+/*
+ * Put a monster whose energy is up to date into the schedule
+ */
+static void sched_link(struct mon_sched *s, struct monster *m_ptr, int m_idx)
+{
+	int rate;
+
+	if (m_ptr->energy >= 100)
+	{
+		ready_add(s, m_idx);
+		return;
+	}
+
+	/* The first turn at which the monster will have 100 energy */
+	rate = mon_energy_rate(m_ptr);
+	s->when[m_idx] = turn + (100 - m_ptr->energy + rate - 1) / rate;
+	heap_push(s, m_idx);
+}
+
+
+/**
+ * Sets the energy a monster has now, and reschedules it.  This must also be
+ * called, with the monster's current energy, before its speed changes.
+ */
+void mon_set_energy(struct cave *c, struct monster *m_ptr, int energy)
+{
+	struct mon_sched *s = c->mon_sched;
+	int m_idx = m_ptr->midx;
+
+	m_ptr->energy = energy;
+	m_ptr->energy_turn = turn;
+
+	sched_unlink(s, m_idx);
+	sched_link(s, m_ptr, m_idx);
+}
+
+
+/**
+ * Adds a newly placed monster to the schedule, with the energy it has now.
+ */
+void mon_sched_add(struct cave *c, int m_idx)
+{
+	struct monster *m_ptr = cave_monster(c, m_idx);
+
+	m_ptr->energy_turn = turn;
+	sched_link(c->mon_sched, m_ptr, m_idx);
+}
+
+/**
+ * Removes a monster which is being deleted from the schedule.
+ */
+void mon_sched_remove(struct cave *c, int m_idx)
+{
+	sched_unlink(c->mon_sched, m_idx);
+}
+
+/**
+ * Follows a monster which was moved from index `i1` to index `i2`.
+ */
+void mon_sched_move(struct cave *c, int i1, int i2)
+{
+	struct mon_sched *s = c->mon_sched;
+
+	if (s->pos[i1] != SCHED_NONE)
+	{
+		s->when[i2] = s->when[i1];
+		heap_set(s, s->pos[i1], i2);
+		s->pos[i1] = SCHED_NONE;
+
+		/* Ties are broken by index */
+		heap_up(s, s->pos[i2]);
+		heap_down(s, s->pos[i2]);
+	}
+	else if (ready_has(s, i1))
+	{
+		ready_remove(s, i1);
+		ready_add(s, i2);
+	}
+}
+
+/**
+ * Empties the schedule, when every monster is wiped.
+ */
+void mon_sched_reset(struct cave *c)
+{
+	struct mon_sched *s = c->mon_sched;
+	int i;
+
+	for (i = 0; i < s->heap_n; i++)
+		s->pos[s->heap[i]] = SCHED_NONE;
+
+	s->heap_n = 0;
+	s->ready_n = 0;
+}
+
+
+/**
+ * Moves every monster which has gained 100 energy by this game turn onto
+ * the ready list.
+ */
+void mon_sched_update(struct cave *c)
+{
+	struct mon_sched *s = c->mon_sched;
+
+	while (s->heap_n && s->when[s->heap[0]] <= turn)
+	{
+		int m_idx = s->heap[0];
+
+		heap_remove(s, m_idx);
+		ready_add(s, m_idx);
+	}
+}
+
+/**
+ * Returns the highest index of a ready monster which is below `m_idx`, or
+ * zero if there is none.
+ */
+int mon_sched_next(struct cave *c, int m_idx)
+{
+	struct mon_sched *s = c->mon_sched;
+	int i = ready_find(s, m_idx);
+
+	/* Skip the monster itself */
+	if (i < s->ready_n && s->ready[i] == m_idx) i++;
+
+	return (i < s->ready_n) ? s->ready[i] : 0;
+}
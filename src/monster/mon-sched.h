@@ -0,0 +1,41 @@
+/*
+ * File: mon-sched.h
+ * Purpose: Structures and functions for the monster energy scheduler.
+ *
+ * Copyright (c) 1997-2007 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef MONSTER_SCHED_H
+#define MONSTER_SCHED_H
+
+#include "angband.h"
+
+struct mon_sched;
+
+/** Functions **/
+struct mon_sched *mon_sched_new(int size);
+void mon_sched_free(struct mon_sched *s);
+void mon_sched_reset(struct cave *c);
+
+void mon_sched_add(struct cave *c, int m_idx);
+void mon_sched_remove(struct cave *c, int m_idx);
+void mon_sched_move(struct cave *c, int i1, int i2);
+
+void mon_sched_update(struct cave *c);
+int mon_sched_next(struct cave *c, int m_idx);
+
+int mon_energy(const struct monster *m_ptr);
+void mon_set_energy(struct cave *c, struct monster *m_ptr, int energy);
+
+#endif /* MONSTER_SCHED_H */
@@ -0,0 +1,264 @@
+/*
+ * File: mon-spatial.c
+ * Purpose: Monster spatial index.
+ *
+ * Copyright (c) 1997-2007 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "monster/mon-spatial.h"
+
+/*
+ * The level is cut into square buckets, and every live monster is kept on a
+ * doubly linked list for the bucket it stands in.  So finding the monsters
+ * in an area only looks at the buckets which overlap it, however many
+ * monsters there are elsewhere on the level.
+ *
+ * Results always come back sorted by index, which is the order the old
+ * scans of the whole monster list visited them in.
+ */
+#define SPATIAL_SHIFT	3
+#define SPATIAL_ROWS	((DUNGEON_HGT >> SPATIAL_SHIFT) + 1)
+#define SPATIAL_COLS	((DUNGEON_WID >> SPATIAL_SHIFT) + 1)
+
+#define SPATIAL_BUCKET(Y,X) \
+	(((Y) >> SPATIAL_SHIFT) * SPATIAL_COLS + ((X) >> SPATIAL_SHIFT))
+
+/*
+ * Bucket of a monster which is not in the index
+ */
+#define SPATIAL_NONE	-1
+
+struct mon_spatial {
+	/* First monster in each bucket, or 0 */
+	s16b head[SPATIAL_ROWS * SPATIAL_COLS];
+
+	/* Per monster: its neighbours in its bucket, and the bucket */
+	s16b *next;
+	s16b *prev;
+	s16b *bucket;
+};
+
+
+struct mon_spatial *mon_spatial_new(int size)
+{
+	struct mon_spatial *s = ZNEW(struct mon_spatial);
+	int i;
+
+	s->next = C_ZNEW(size, s16b);
+	s->prev = C_ZNEW(size, s16b);
+	s->bucket = C_ZNEW(size, s16b);
+
+	for (i = 0; i < size; i++)
+		s->bucket[i] = SPATIAL_NONE;
+
+	return s;
+}
+
+void mon_spatial_free(struct mon_spatial *s)
+{
+	FREE(s->next);
+	FREE(s->prev);
+	FREE(s->bucket);
+	FREE(s);
+}
+
+
+static void spatial_link(struct mon_spatial *s, int m_idx, int b)
+{
+	s->bucket[m_idx] = b;
+	s->prev[m_idx] = 0;
+	s->next[m_idx] = s->head[b];
+	if (s->head[b]) s->prev[s->head[b]] = m_idx;
+	s->head[b] = m_idx;
+}
+
+static void spatial_unlink(struct mon_spatial *s, int m_idx)
+{
+	int b = s->bucket[m_idx];
+
+	if (b == SPATIAL_NONE) return;
+
+	if (s->prev[m_idx])
+		s->next[s->prev[m_idx]] = s->next[m_idx];
+	else
+		s->head[b] = s->next[m_idx];
+
+	if (s->next[m_idx])
+		s->prev[s->next[m_idx]] = s->prev[m_idx];
+
+	s->bucket[m_idx] = SPATIAL_NONE;
+}
+
+
+/**
+ * Adds a newly placed monster to the index, where it stands.
+ */
+void mon_spatial_add(struct cave *c, int m_idx)
+{
+	struct monster *m_ptr = cave_monster(c, m_idx);
+
+	spatial_link(c->mon_spatial, m_idx, SPATIAL_BUCKET(m_ptr->fy, m_ptr->fx));
+}
+
+/**
+ * Removes a monster which is being deleted from the index.
+ */
+void mon_spatial_remove(struct cave *c, int m_idx)
+{
+	spatial_unlink(c->mon_spatial, m_idx);
+}
+
+/**
+ * Follows a monster which was moved from index `i1` to index `i2`.
+ */
+void mon_spatial_move(struct cave *c, int i1, int i2)
+{
+	struct mon_spatial *s = c->mon_spatial;
+	int b = s->bucket[i1];
+
+	if (b == SPATIAL_NONE) return;
+
+	spatial_unlink(s, i1);
+	spatial_link(s, i2, b);
+}
+
+/**
+ * Follows a monster which has moved to another grid.
+ */
+void mon_spatial_relocate(struct cave *c, int m_idx)
+{
+	struct mon_spatial *s = c->mon_spatial;
+	struct monster *m_ptr = cave_monster(c, m_idx);
+	int b = SPATIAL_BUCKET(m_ptr->fy, m_ptr->fx);
+
+	if (s->bucket[m_idx] == b) return;
+
+	spatial_unlink(s, m_idx);
+	spatial_link(s, m_idx, b);
+}
+
+/**
+ * Empties the index, when every monster is wiped.
+ */
+void mon_spatial_reset(struct cave *c)
+{
+	struct mon_spatial *s = c->mon_spatial;
+	int b;
+
+	for (b = 0; b < SPATIAL_ROWS * SPATIAL_COLS; b++)
+	{
+		while (s->head[b])
+			spatial_unlink(s, s->head[b]);
+	}
+}
+
+
+static int cmp_s16b(const void *a, const void *b)
+{
+	return *(const s16b *)a - *(const s16b *)b;
+}
+
+/*
+ * Walks the monsters standing from (y1, x1) to (y2, x2) inclusive, putting
+ * their indices in `list` unless it is NULL, and returns how many there are.
+ */
+static int spatial_scan(struct cave *c, int y1, int x1, int y2, int x2,
+		s16b *list)
+{
+	struct mon_spatial *s = c->mon_spatial;
+	int by, bx, n = 0;
+
+	y1 = MAX(y1, 0);
+	x1 = MAX(x1, 0);
+	y2 = MIN(y2, DUNGEON_HGT - 1);
+	x2 = MIN(x2, DUNGEON_WID - 1);
+	if (y1 > y2 || x1 > x2) return 0;
+
+	for (by = y1 >> SPATIAL_SHIFT; by <= y2 >> SPATIAL_SHIFT; by++)
+	{
+		for (bx = x1 >> SPATIAL_SHIFT; bx <= x2 >> SPATIAL_SHIFT; bx++)
+		{
+			int m_idx = s->head[by * SPATIAL_COLS + bx];
+
+			for (; m_idx; m_idx = s->next[m_idx])
+			{
+				struct monster *m_ptr = cave_monster(c, m_idx);
+
+				if (m_ptr->fy < y1 || m_ptr->fy > y2) continue;
+				if (m_ptr->fx < x1 || m_ptr->fx > x2) continue;
+
+				if (list) list[n] = m_idx;
+				n++;
+			}
+		}
+	}
+
+	return n;
+}
+
+/**
+ * Counts the monsters standing from (y1, x1) to (y2, x2) inclusive, so that
+ * a list for mon_spatial_rect() can be made just big enough.
+ */
+int mon_spatial_count(struct cave *c, int y1, int x1, int y2, int x2)
+{
+	return spatial_scan(c, y1, x1, y2, x2, NULL);
+}
+
+/**
+ * Finds every monster standing from (y1, x1) to (y2, x2) inclusive, and
+ * puts their indices in `list`, in increasing order.  `list` must have room
+ * for every monster in the area; see mon_spatial_count().  Returns the number
+ * found.
+ */
+int mon_spatial_rect(struct cave *c, int y1, int x1, int y2, int x2,
+		s16b *list)
+{
+	int n = spatial_scan(c, y1, x1, y2, x2, list);
+
+	qsort(list, n, sizeof(*list), cmp_s16b);
+	return n;
+}
+
+/**
+ * Counts the monsters in the square of grids no more than `r` grids from
+ * (y, x) in each direction, so a list for mon_spatial_near() can be made.
+ */
+int mon_spatial_count_near(struct cave *c, int y, int x, int r)
+{
+	return spatial_scan(c, y - r, x - r, y + r, x + r, NULL);
+}
+
+/**
+ * Finds every monster no more than `r` grids from (y, x), as measured by
+ * distance(), like mon_spatial_rect().  `list` must have room for every
+ * monster counted by mon_spatial_count_near().
+ */
+int mon_spatial_near(struct cave *c, int y, int x, int r, s16b *list)
+{
+	int i, k = 0;
+	int n = mon_spatial_rect(c, y - r, x - r, y + r, x + r, list);
+
+	for (i = 0; i < n; i++)
+	{
+		struct monster *m_ptr = cave_monster(c, list[i]);
+
+		if (distance(y, x, m_ptr->fy, m_ptr->fx) <= r)
+			list[k++] = list[i];
+	}
+
+	return k;
+}
@@ -0,0 +1,42 @@
+/*
+ * File: mon-spatial.h
+ * Purpose: Structures and functions for the monster spatial index.
+ *
+ * Copyright (c) 1997-2007 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef MONSTER_SPATIAL_H
+#define MONSTER_SPATIAL_H
+
+#include "angband.h"
+
+struct mon_spatial;
+
+/** Functions **/
+struct mon_spatial *mon_spatial_new(int size);
+void mon_spatial_free(struct mon_spatial *s);
+void mon_spatial_reset(struct cave *c);
+
+void mon_spatial_add(struct cave *c, int m_idx);
+void mon_spatial_remove(struct cave *c, int m_idx);
+void mon_spatial_move(struct cave *c, int i1, int i2);
+void mon_spatial_relocate(struct cave *c, int m_idx);
+
+int mon_spatial_count(struct cave *c, int y1, int x1, int y2, int x2);
+int mon_spatial_rect(struct cave *c, int y1, int x1, int y2, int x2,
+		s16b *list);
+int mon_spatial_count_near(struct cave *c, int y, int x, int r);
+int mon_spatial_near(struct cave *c, int y, int x, int r, s16b *list);
+
+#endif /* MONSTER_SPATIAL_H */
@@ -211,7 +211,7 @@ static void drain_mana(int m_idx, int rlev, bool seen)
 			m_ptr->hp = m_ptr->maxhp;
 
 		/* Redraw (later) if needed */
-		if (p_ptr->health_who == m_ptr)
+		if (health_tracked(p_ptr) == m_ptr)
 			p_ptr->redraw |= (PR_HEALTH);
 
 		/* Special message */
@@ -257,7 +257,7 @@ static void heal_self(int m_idx, int rlev, bool seen)
 	}
 
 	/* Redraw (later) if needed */
-	if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+	if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 	/* Cancel fear */
 	if (m_ptr->m_timed[MON_TMD_FEAR]) {
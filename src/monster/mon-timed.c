@@ -17,7 +17,9 @@
  */
 
 #include "angband.h"
+#include "cave.h"
 #include "monster/mon-msg.h"
+#include "monster/mon-sched.h"
 #include "monster/mon-spell.h"
 #include "monster/mon-timed.h"
 #include "monster/mon-util.h"
@@ -201,10 +203,16 @@ static bool mon_set_timed(monster_type *m_ptr, int ef_idx, int timer,
 
 	if (resisted)
 		m_note = MON_MSG_UNAFFECTED;
-	else
+	else if ((ef_idx == MON_TMD_SLOW || ef_idx == MON_TMD_FAST) &&
+			m_ptr->midx > 0) {
+		/* Bring the energy up to date before the speed changes */
+		int energy = mon_energy(m_ptr);
+		m_ptr->m_timed[ef_idx] = timer;
+		mon_set_energy(cave, m_ptr, energy);
+	} else
 		m_ptr->m_timed[ef_idx] = timer;
 
-	if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+	if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 	/* Update the visuals, as appropriate. */
 	p_ptr->redraw |= (PR_MONLIST);
@@ -19,6 +19,8 @@
 #include "angband.h"
 #include "monster/mon-make.h"
 #include "monster/mon-msg.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-spatial.h"
 #include "monster/mon-spell.h"
 #include "monster/mon-timed.h"
 #include "monster/mon-util.h"
@@ -791,6 +793,28 @@ void monster_desc(char *desc, size_t max, const monster_type *m_ptr, int mode)
 
 
 
+/**
+ * The approximate distance from the player to a grid, as kept in "cdis".
+ *
+ * Note the optimized "inline" version of the "distance()" function.
+ */
+static byte monster_cdis(int fy, int fx)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	/* Distance components */
+	int dy = (py > fy) ? (py - fy) : (fy - py);
+	int dx = (px > fx) ? (px - fx) : (fx - px);
+
+	/* Approximate distance */
+	int d = (dy > dx) ? (dy + (dx>>1)) : (dx + (dy>>1));
+
+	/* Restrict distance */
+	return (d > 255) ? 255 : d;
+}
+
+
 /**
  * This function updates the monster record of the given monster
  *
@@ -829,9 +853,8 @@ void monster_desc(char *desc, size_t max, const monster_type *m_ptr, int mode)
  * Note that this function is called once per monster every time the
  * player moves.  When the player is running, this function is one
  * of the primary bottlenecks, along with "update_view()" and the
- * "process_monsters()" code, so efficiency is important.
- *
- * Note the optimized "inline" version of the "distance()" function.
+ * "process_monsters()" code, so efficiency is important.  See
+ * "update_monsters()" for the monsters which can be passed over.
  *
  * A monster is "visible" to the player if (1) it has been detected
  * by the player, (2) it is close to the player and the player has
@@ -877,21 +900,8 @@ void update_mon(int m_idx, bool full)
 
 	/* Compute distance */
 	if (full) {
-		int py = p_ptr->py;
-		int px = p_ptr->px;
-
-		/* Distance components */
-		int dy = (py > fy) ? (py - fy) : (fy - py);
-		int dx = (px > fx) ? (px - fx) : (fx - px);
-
-		/* Approximate distance */
-		d = (dy > dx) ? (dy + (dx>>1)) : (dx + (dy>>1));
-
-		/* Restrict distance */
-		if (d > 255) d = 255;
-
 		/* Save the distance */
-		m_ptr->cdis = d;
+		d = m_ptr->cdis = monster_cdis(fy, fx);
 	}
 
 	/* Extract distance */
@@ -1002,7 +1012,7 @@ void update_mon(int m_idx, bool full)
 			cave_light_spot(cave, fy, fx);
 
 			/* Update health bar as needed */
-			if (p_ptr->health_who == m_ptr)
+			if (health_tracked(p_ptr) == m_ptr)
 				p_ptr->redraw |= (PR_HEALTH);
 
 			/* Hack -- Count "fresh" sightings */
@@ -1033,7 +1043,7 @@ void update_mon(int m_idx, bool full)
 				cave_light_spot(cave, fy, fx);
 
 				/* Update health bar as needed */
-				if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+				if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 				/* Disturb on disappearance */
 				if (OPT(disturb_move)) disturb(p_ptr, 1, 0);
@@ -1081,9 +1091,18 @@ void update_mon(int m_idx, bool full)
 
 /**
  * Updates all the (non-dead) monsters via update_mon().
+ *
+ * Every distance must be kept up to date, but update_mon() can only change
+ * a monster which is already seen, easily seen or detected, or one which
+ * is within "MAX_SIGHT" and either in view or in reach of telepathy.  Any
+ * other monster would be found unseen again with no side effects, so after
+ * its distance is saved it is passed over.  The monsters which are looked
+ * at are updated in the same order as before, so the redraws, disturbances
+ * and lore which follow are the same as updating every monster.
  */
 void update_monsters(bool full)
 {
+	bool esp = check_state(p_ptr, OF_TELEPATHY, p_ptr->state.flags);
 	int i;
 
 	/* Update each (live) monster */
@@ -1093,8 +1112,18 @@ void update_monsters(bool full)
 		/* Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
 
+		/* Save the distance */
+		if (full) m_ptr->cdis = monster_cdis(m_ptr->fy, m_ptr->fx);
+
+		/* Skip monsters which stay unseen */
+		if (!m_ptr->ml && !(m_ptr->mflag & (MFLAG_VIEW | MFLAG_MARK))) {
+			if (m_ptr->cdis > MAX_SIGHT) continue;
+			if (!esp && !player_has_los_bold(m_ptr->fy, m_ptr->fx))
+				continue;
+		}
+
 		/* Update the monster */
-		update_mon(i, full);
+		update_mon(i, FALSE);
 	}
 }
 
@@ -1183,6 +1212,8 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	/* Update grids */
 	cave->m_idx[y1][x1] = m2;
 	cave->m_idx[y2][x2] = m1;
+	cave_note_empty(cave, y1, x1);
+	cave_note_empty(cave, y2, x2);
 
 	/* Monster 1 */
 	if (m1 > 0) {
@@ -1191,6 +1222,7 @@ void monster_swap(int y1, int x1, int y2, int x2)
 		/* Move monster */
 		m_ptr->fy = y2;
 		m_ptr->fx = x2;
+		mon_spatial_relocate(cave, m1);
 
 		/* Update monster */
 		update_mon(m1, TRUE);
@@ -1232,6 +1264,7 @@ void monster_swap(int y1, int x1, int y2, int x2)
 		/* Move monster */
 		m_ptr->fy = y1;
 		m_ptr->fx = x1;
+		mon_spatial_relocate(cave, m2);
 
 		/* Update monster */
 		update_mon(m2, TRUE);
@@ -1413,7 +1446,7 @@ int summon_specific(int y1, int x1, int lev, int type, int delay)
 	/* If delay, try to let the player act before the summoned monsters,
 	 * including slowing down faster monsters for one turn */
 	if (delay) {
-		m_ptr->energy = 0;
+		mon_set_energy(cave, m_ptr, 0);
 		if (r_ptr->speed > p_ptr->state.speed)
 			mon_inc_timed(m_ptr, MON_TMD_SLOW, 1,
 				MON_TMD_FLG_NOMESSAGE, FALSE);
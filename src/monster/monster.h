@@ -235,8 +235,10 @@ typedef struct monster
 
 	byte mspeed;		/* Monster "speed" */
 	byte energy;		/* Monster "energy" */
+	s32b energy_turn;	/* Game turn "energy" was last brought up to date */
 
 	byte cdis;			/* Current dis from player */
+	byte lod_turns;		/* Turns owed to a distant update */
 
 	byte mflag;			/* Extra monster flags */
 
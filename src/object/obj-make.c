@@ -724,12 +724,13 @@ static bool kind_is_good(const object_kind *kind)
 }
 
 
-/** Arrays holding an index of objects to generate for a given level */
-static u32b obj_total[MAX_DEPTH];
-static byte *obj_alloc;
-
-static u32b obj_total_great[MAX_DEPTH];
-static byte *obj_alloc_great;
+/**
+ * Arrays holding, for each level, the running total of the chances of
+ * object kinds 1 to "item" at index [(level * k_max) + item].  The last
+ * entry of each level is the total for that level.
+ */
+static u32b *obj_alloc;
+static u32b *obj_alloc_great;
 
 /* Don't worry about probabilities for anything past dlev100 */
 #define MAX_O_DEPTH		100
@@ -744,42 +745,34 @@ bool init_obj_alloc(void)
 
 
 	/* Free obj_allocs if allocated */
-	FREE(obj_alloc);
+	free_obj_alloc();
 
 	/* Allocate and wipe */
-	obj_alloc = C_ZNEW((MAX_O_DEPTH + 1) * k_max, byte);
-	obj_alloc_great = C_ZNEW((MAX_O_DEPTH + 1) * k_max, byte);
-
-	/* Wipe the totals */
-	C_WIPE(obj_total, MAX_O_DEPTH + 1, u32b);
-	C_WIPE(obj_total_great, MAX_O_DEPTH + 1, u32b);
+	obj_alloc = C_ZNEW((MAX_O_DEPTH + 1) * k_max, u32b);
+	obj_alloc_great = C_ZNEW((MAX_O_DEPTH + 1) * k_max, u32b);
 
 
 	/* Init allocation data */
-	for (item = 1; item < k_max; item++)
+	for (lev = 0; lev <= MAX_O_DEPTH; lev++)
 	{
-		const object_kind *kind = &k_info[item];
+		u32b total = 0, total_great = 0;
 
-		int min = kind->alloc_min;
-		int max = kind->alloc_max;
-
-		/* If an item doesn't have a rarity, move on */
-		if (!kind->alloc_prob) continue;
-
-		/* Go through all the dungeon levels */
-		for (lev = 0; lev <= MAX_O_DEPTH; lev++)
+		/* Go through all the object kinds */
+		for (item = 1; item < k_max; item++)
 		{
+			const object_kind *kind = &k_info[item];
 			int rarity = kind->alloc_prob;
 
 			/* Save the probability in the standard table */
-			if ((lev < min) || (lev > max)) rarity = 0;
-			obj_total[lev] += rarity;
-			obj_alloc[(lev * k_max) + item] = rarity;
+			if ((lev < kind->alloc_min) || (lev > kind->alloc_max))
+				rarity = 0;
+			total += rarity;
+			obj_alloc[(lev * k_max) + item] = total;
 
 			/* Save the probability in the "great" table if relevant */
 			if (!kind_is_good(kind)) rarity = 0;
-			obj_total_great[lev] += rarity;
-			obj_alloc_great[(lev * k_max) + item] = rarity;
+			total_great += rarity;
+			obj_alloc_great[(lev * k_max) + item] = total_great;
 		}
 	}
 
@@ -797,13 +790,35 @@ void free_obj_alloc(void)
 }
 
 
+/*
+ * Find the object kind a random value falls on, in the running totals of
+ * one level.  This is the first kind whose running total is above the value,
+ * as subtracting each chance in turn would find.
+ */
+static size_t obj_alloc_search(const u32b *table, u32b value)
+{
+	size_t lo = 1, hi = z_info->k_max;
+
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+
+		if (value < table[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+
 /*
  * Choose an object kind given a dungeon level to choose it for.
  */
 object_kind *get_obj_num(int level, bool good)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	const u32b *table;
 	u32b value;
 
 	/* Occasional level boost */
@@ -817,37 +832,14 @@ object_kind *get_obj_num(int level, bool good)
 	level = MIN(level, MAX_O_DEPTH);
 	level = MAX(level, 0);
 
-	/* Pick an object */
-	ind = level * z_info->k_max;
-
-	if (!good)
-	{
-		value = randint0(obj_total[level]);
-		for (item = 1; item < z_info->k_max; item++)
-		{
-			/* Found it */
-			if (value < obj_alloc[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc[ind + item];
-		}
-	}
-	else
-	{
-		value = randint0(obj_total_great[level]);
-		for (item = 1; item < z_info->k_max; item++)
-		{
-			/* Found it */
-			if (value < obj_alloc_great[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc_great[ind + item];
-		}
-	}
+	/* This is the running totals for this dlev */
+	table = (good ? obj_alloc_great : obj_alloc) + level * z_info->k_max;
 
+	/* Pick an object */
+	value = randint0(table[z_info->k_max - 1]);
 
 	/* Return the item index */
-	return objkind_byid(item);
+	return objkind_byid(obj_alloc_search(table, value));
 }
 
 
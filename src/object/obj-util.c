@@ -34,6 +34,9 @@
 
 struct object *o_list;
 
+/* Free object slots, see o_pop() */
+static struct slot_list *o_slots;
+
 /*
  * Hold the titles of scrolls, 6 to 14 characters each, plus quotes.
  */
@@ -814,6 +817,7 @@ void excise_object_idx(int o_idx)
 				{
 					/* Remove from list */
 					cave->o_idx[y][x] = next_o_idx;
+					cave_note_empty(cave, y, x);
 				}
 
 				/* Real previous */
@@ -881,11 +885,8 @@ void delete_object_idx(int o_idx)
 		delete_monster_idx(j_ptr->mimicking_m_idx);
 	}
 
-	/* Wipe the object */
-	object_wipe(j_ptr);
-
-	/* Count objects */
-	o_cnt--;
+	/* Wipe the object, and free its slot */
+	o_push(o_idx);
 
 	/* Stop tracking deleted objects if necessary */
 	if (tracked_object_is(0 - o_idx))
@@ -931,15 +932,13 @@ void delete_object(int y, int x)
 			delete_monster_idx(o_ptr->mimicking_m_idx);
 		}
 
-		/* Wipe the object */
-		object_wipe(o_ptr);
-
-		/* Count objects */
-		o_cnt--;
+		/* Wipe the object, and free its slot */
+		o_push(this_o_idx);
 	}
 
 	/* Objects are gone */
 	cave->o_idx[y][x] = 0;
+	cave_note_empty(cave, y, x);
 
 	/* Visual update */
 	cave_light_spot(cave, y, x);
@@ -1038,6 +1037,9 @@ static void compact_objects_aux(int i1, int i2)
 
 	/* Hack -- wipe hole */
 	object_wipe(o_ptr);
+
+	/* Handles to the old index are stale */
+	slots_retire(o_slots, i1);
 }
 
 
@@ -1053,8 +1055,10 @@ static void compact_objects_aux(int i1, int i2)
  * When compacting other objects, we base the saving throw on a combination of
  * object level, distance from player, and current "desperation".
  *
- * After compacting, we "reorder" the objects into a more compact order, and we
- * reset the allocation info, and the "live" array.
+ * The slots of destroyed objects are left for o_pop() to reuse.  Only when not
+ * passed a size do we "reorder" the objects into a more compact order, which
+ * moves objects to new indices, so it is only done when asked for, before
+ * saving.
  */
 void compact_objects(int size)
 {
@@ -1082,6 +1086,9 @@ void compact_objects(int size)
 			o_max--;
 		}
 
+		/* There are no holes left */
+		slots_reset(o_slots);
+
 		return;
 	}
 
@@ -1180,10 +1187,19 @@ void compact_objects(int size)
 			size--;
 		}
 	}
+}
 
 
-	/* Reorder objects */
-	compact_objects(0);
+/*
+ * Whether an artifact on a level which is being wiped can be found again,
+ * rather than being lost.  Artifacts are kept if the level was never
+ * finished, in preserve mode, or if a monster was carrying them, as long
+ * as the player never saw them.
+ */
+bool wipe_keeps_artifact(const object_type *o_ptr)
+{
+	return (!character_dungeon || !OPT(birth_no_preserve) ||
+			o_ptr->held_m_idx) && !object_was_sensed(o_ptr);
 }
 
 
@@ -1210,10 +1226,7 @@ void wipe_o_list(struct cave *c)
 
 		/* Preserve artifacts or mark them as lost in the history */
 		if (o_ptr->artifact) {
-			/* Preserve if dungeon creation failed, or preserve mode, or items
-			 * carried by monsters, and only artifacts not seen */
-			if ((!character_dungeon || !OPT(birth_no_preserve) ||
-					o_ptr->held_m_idx) && !object_was_sensed(o_ptr))
+			if (wipe_keeps_artifact(o_ptr))
 				o_ptr->artifact->created = FALSE;
 			else
 				history_lose_artifact(o_ptr->artifact);
@@ -1240,12 +1253,19 @@ void wipe_o_list(struct cave *c)
 
 			/* Hack -- see above */
 			c->o_idx[y][x] = 0;
+			cave_note_empty(c, y, x);
 		}
 
 		/* Wipe the object */
 		(void)WIPE(o_ptr, object_type);
+
+		/* Handles to it are stale */
+		slots_retire(o_slots, i);
 	}
 
+	/* No slots are left to reuse */
+	slots_reset(o_slots);
+
 	/* Reset "o_max" */
 	o_max = 1;
 
@@ -1257,37 +1277,29 @@ void wipe_o_list(struct cave *c)
 /*
  * Get and return the index of a "free" object.
  *
+ * The slots of dead objects are kept on a free list, and reused (most
+ * recent first) before the object array is expanded.
+ *
  * This routine should almost never fail, but in case it does,
  * we must be sure to handle "failure" of this routine.
  */
 s16b o_pop(void)
 {
-	int i;
-
+	/* Recycle a dead object */
+	int i = slots_take(o_slots);
 
 	/* Initial allocation */
-	if (o_max < z_info->o_max)
+	if (!i && o_max < z_info->o_max)
 	{
 		/* Get next space */
 		i = o_max;
 
 		/* Expand object array */
 		o_max++;
-
-		/* Count objects */
-		o_cnt++;
-
-		/* Use this object */
-		return (i);
 	}
 
-
-	/* Recycle dead objects */
-	for (i = 1; i < o_max; i++)
+	if (i)
 	{
-		object_type *o_ptr = object_byid(i);
-		if (o_ptr->kind) continue;
-
 		/* Count objects */
 		o_cnt++;
 
@@ -1304,6 +1316,22 @@ s16b o_pop(void)
 }
 
 
+/*
+ * Wipe a dead object, and give its index back for o_pop() to reuse
+ */
+void o_push(s16b o_idx)
+{
+	/* Wipe the object */
+	object_wipe(object_byid(o_idx));
+
+	/* Count objects */
+	o_cnt--;
+
+	/* The slot can be reused */
+	slots_give(o_slots, o_idx);
+}
+
+
 /*
  * Get the first object at a dungeon location
  * or NULL if there isn't one.
@@ -1942,6 +1970,7 @@ s16b floor_carry(struct cave *c, int y, int x, object_type *j_ptr)
 
 		/* Link the floor to the object */
 		c->o_idx[y][x] = o_idx;
+		cave_note_empty(c, y, x);
 
 		cave_note_spot(c, y, x);
 		cave_light_spot(c, y, x);
@@ -3776,8 +3805,8 @@ void display_itemlist(void)
 	bool seen[MAX_ITEMLIST];
 	unsigned counter = 0;
 
-	int dungeon_hgt = p_ptr->depth == 0 ? TOWN_HGT : DUNGEON_HGT;
-	int dungeon_wid = p_ptr->depth == 0 ? TOWN_WID : DUNGEON_WID;
+	int dungeon_hgt = cave->height;
+	int dungeon_wid = cave->width;
 
 	byte attr;
 	char buf[80];
@@ -4380,12 +4409,89 @@ struct object *object_byid(s16b oidx)
 	return &o_list[oidx];
 }
 
+/*
+ * Get a handle for an object, which will not find another object once
+ * this one has been deleted or moved by compaction.
+ */
+slot_handle object_handle(s16b oidx)
+{
+	return slots_handle(o_slots, oidx);
+}
+
+/*
+ * Get an object by its handle, or NULL if it is gone.
+ */
+struct object *object_byhandle(slot_handle h)
+{
+	int oidx = slots_lookup(o_slots, h);
+
+	if (!oidx || oidx >= o_max) return NULL;
+	return object_byid(oidx);
+}
+
+/*
+ * An object list put aside, with its free slots, see objects_swap()
+ */
+struct object_list {
+	struct object *list;
+	s16b max;
+	s16b cnt;
+	struct slot_list *slots;
+};
+
+/*
+ * Make an empty object list, to be swapped with the one in use.
+ */
+struct object_list *object_list_new(void)
+{
+	struct object_list *l = ZNEW(struct object_list);
+
+	l->list = C_ZNEW(z_info->o_max, struct object);
+	l->max = 1;
+	l->slots = slots_new(z_info->o_max);
+
+	return l;
+}
+
+void object_list_free(struct object_list *l)
+{
+	if (!l) return;
+
+	mem_free(l->list);
+	slots_free(l->slots);
+	mem_free(l);
+}
+
+/*
+ * Swap the objects in use (o_list[] and its counts) with those put aside
+ * in `l`, so that a level can be made with objects of its own and the
+ * objects of the current level left as they were.
+ */
+void objects_swap(struct object_list *l)
+{
+	struct object *list = o_list;
+	s16b max = o_max, cnt = o_cnt;
+	struct slot_list *slots = o_slots;
+
+	o_list = l->list;
+	o_max = l->max;
+	o_cnt = l->cnt;
+	o_slots = l->slots;
+
+	l->list = list;
+	l->max = max;
+	l->cnt = cnt;
+	l->slots = slots;
+}
+
 void objects_init(void)
 {
 	o_list = C_ZNEW(z_info->o_max, struct object);
+	o_slots = slots_new(z_info->o_max);
 }
 
 void objects_destroy(void)
 {
 	mem_free(o_list);
+	slots_free(o_slots);
 }
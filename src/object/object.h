@@ -10,6 +10,7 @@
 #include "cave.h"
 
 struct player;
+struct object_list;
 
 /*** Constants ***/
 
@@ -631,8 +632,10 @@ void excise_object_idx(int o_idx);
 void delete_object_idx(int o_idx);
 void delete_object(int y, int x);
 void compact_objects(int size);
+bool wipe_keeps_artifact(const object_type *o_ptr);
 void wipe_o_list(struct cave *c);
 s16b o_pop(void);
+void o_push(s16b o_idx);
 object_type *get_first_object(int y, int x);
 object_type *get_next_object(const object_type *o_ptr);
 bool is_blessed(const object_type *o_ptr);
@@ -719,6 +722,11 @@ bool pack_is_overfull(void);
 void pack_overflow(void);
 
 extern struct object *object_byid(s16b oidx);
+extern slot_handle object_handle(s16b oidx);
+extern struct object *object_byhandle(slot_handle h);
+extern struct object_list *object_list_new(void);
+extern void object_list_free(struct object_list *l);
+extern void objects_swap(struct object_list *l);
 extern void objects_init(void);
 extern void objects_destroy(void);
 
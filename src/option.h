@@ -71,6 +71,7 @@ extern const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER];
 #define OPT_mouse_movement			21
 #define OPT_mouse_buttons			22
 #define OPT_notify_recharge			23
+#define OPT_pregen_levels			24
 
 #define OPT_cheat_hear				(OPT_CHEAT+1)
 #define OPT_cheat_room				(OPT_CHEAT+2)
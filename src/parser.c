@@ -77,10 +77,13 @@ struct parser_spec {
 	struct parser_spec *next;
 	int type;
 	const char *name;
+
+	/* The last name pointer this spec was fetched by */
+	const char *key;
 };
 
 struct parser_value {
-	struct parser_spec spec;
+	struct parser_spec *spec;
 	union {
 		wchar_t cval;
 		int ival;
@@ -96,16 +99,29 @@ struct parser_hook {
 	char *dir;
 	struct parser_spec *fhead;
 	struct parser_spec *ftail;
+	int nspecs;
 };
 
+/**
+ * Each line is copied into `line`, which is kept from line to line, and cut
+ * up there; the values of the current line are in `vals`, in the order of the
+ * hook's specs, and strings among them point into `line`.  Hooks are found
+ * through `index`, an open-addressed hash table of the newest hook for each
+ * directive.
+ */
 struct parser {
 	enum parser_error error;
 	unsigned int lineno;
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
-	struct parser_value *fhead;
-	struct parser_value *ftail;
+	struct parser_hook **index;
+	size_t index_size;
+	struct parser_value *vals;
+	int nvals;
+	int vals_size;
+	char *line;
+	size_t line_size;
 	void *priv;
 };
 
@@ -114,28 +130,86 @@ struct parser *parser_new(void) {
 	return p;
 }
 
+/* FNV-1a hash of a directive */
+static u32b hook_hash(const char *dir) {
+	u32b h = 2166136261U;
+	while (*dir)
+	{
+		h ^= (byte)*dir++;
+		h *= 16777619U;
+	}
+	return h;
+}
+
 static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h)
+	size_t i;
+	struct parser_hook *h;
+
+	if (!p->index_size)
+		return NULL;
+
+	i = hook_hash(dir) & (p->index_size - 1);
+	while ((h = p->index[i]) != NULL)
 	{
 		if (!strcmp(h->dir, dir))
 			break;
-		h = h->next;
+		i = (i + 1) & (p->index_size - 1);
 	}
 	return h;
 }
 
-static void parser_freeold(struct parser *p) {
-	struct parser_value *v;
-	while (p->fhead)
+/* Rebuild the hook index, at most half full, from the list of hooks; newer
+ * hooks come first in the list, so they supersede older ones */
+static void index_hooks(struct parser *p) {
+	struct parser_hook *h;
+	size_t count = 0;
+
+	for (h = p->hooks; h; h = h->next)
+		count++;
+
+	mem_free(p->index);
+	p->index_size = 8;
+	while (p->index_size < 2 * count)
+		p->index_size *= 2;
+	p->index = mem_zalloc(p->index_size * sizeof(*p->index));
+
+	for (h = p->hooks; h; h = h->next)
+	{
+		size_t i = hook_hash(h->dir) & (p->index_size - 1);
+		while (p->index[i] && strcmp(p->index[i]->dir, h->dir))
+			i = (i + 1) & (p->index_size - 1);
+		if (!p->index[i])
+			p->index[i] = h;
+	}
+}
+
+/* Cut the next field from `*sp`, like strtok(): fields delimited by ':' skip
+ * any empty ones, while a field with no delimiters takes the rest of the line.
+ * NULL is returned when the line is used up. */
+static char *next_field(char **sp, bool delimited) {
+	char *tok = *sp;
+	char *end;
+
+	if (!tok)
+		return NULL;
+	if (delimited)
+		while (*tok == ':')
+			tok++;
+	if (!*tok)
+	{
+		*sp = NULL;
+		return NULL;
+	}
+
+	end = delimited ? strchr(tok, ':') : NULL;
+	if (end)
 	{
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
-		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
-		p->fhead = v;
+		*end = '\0';
+		*sp = end + 1;
 	}
+	else
+		*sp = NULL;
+	return tok;
 }
 
 static bool parse_random(const char *str, random_value *bonus) {
@@ -240,22 +314,19 @@ static bool parse_random(const char *str, random_value *bonus) {
 
 /* This is a bit long and should probably be refactored a bit. */
 enum parser_error parser_parse(struct parser *p, const char *line) {
-	char *cline;
 	char *tok;
 	struct parser_hook *h;
 	struct parser_spec *s;
 	struct parser_value *v;
-	char *sp = NULL;
+	char *sp;
+	size_t len;
 
 	assert(p);
 	assert(line);
 
-	parser_freeold(p);
-
 	p->lineno++;
 	p->colno = 1;
-	p->fhead = NULL;
-	p->ftail = NULL;
+	p->nvals = 0;
 
 	/* Ignore empty lines and comments. */
 	while (*line && (isspace(*line)))
@@ -263,11 +334,17 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Copy the line to cut up, into the buffer kept for it */
+	len = strlen(line) + 1;
+	if (len > p->line_size) {
+		p->line_size = MAX(len, 2 * p->line_size);
+		p->line = mem_realloc(p->line, p->line_size);
+	}
+	memcpy(p->line, line, len);
+	sp = p->line;
 
-	tok = strtok(cline, ":");
+	tok = next_field(&sp, TRUE);
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -276,10 +353,14 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
 
+	if (h->nspecs > p->vals_size) {
+		p->vals_size = h->nspecs;
+		p->vals = mem_realloc(p->vals, p->vals_size * sizeof(*p->vals));
+	}
+
 	/* There's a little bit of trickiness here to account for optional
 	 * types. The optional flag has a bit assigned to it in the spec's type
 	 * tag; we compute a temporary type for the spec with that flag removed
@@ -291,41 +372,34 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		/* These types are tokenized on ':'; strings are not tokenized
 		 * at all (i.e., they consume the remainder of the line) */
 		if (t == PARSE_T_INT || t == PARSE_T_SYM || t == PARSE_T_RAND || t == PARSE_T_UINT) {
-			tok = strtok(sp, ":");
-			sp = NULL;
+			tok = next_field(&sp, TRUE);
 		} else if (t == PARSE_T_CHAR) {
-			tok = strtok(sp, "");
+			/* A character is followed by a ':' if anything */
+			tok = next_field(&sp, FALSE);
 			if (tok)
-				sp = tok + 2;
+				sp = tok[1] ? tok + 2 : NULL;
 		} else {
-			tok = strtok(sp, "");
-			sp = NULL;
+			tok = next_field(&sp, FALSE);
 		}
 		if (!tok)
 		{
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node, parse out its value, and link it into
-		 * the value list. */
-		v = mem_alloc(sizeof *v);
-		v->spec.next = NULL;
-		v->spec.type = s->type;
-		v->spec.name = s->name;
+		/* Parse out the value into the next slot. */
+		v = &p->vals[p->nvals];
+		v->spec = s;
 		if (t == PARSE_T_INT)
 		{
 			char *z = NULL;
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok)
 			{
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -337,8 +411,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-')
 			{
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -350,28 +422,20 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		}
 		else if (t == PARSE_T_SYM || t == PARSE_T_STR)
 		{
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		}
 		else if (t == PARSE_T_RAND)
 		{
 			if (!parse_random(tok, &v->u.rval))
 			{
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
 			}
 		}
-		if (!p->fhead)
-			p->fhead = v;
-		else
-			p->ftail->spec.next = &v->spec;
-		p->ftail = v;
+		p->nvals++;
 	}
 
-	mem_free(cline);
-
 	p->error = h->func(p);
 	return p->error;
 }
@@ -420,7 +484,9 @@ static void clean_specs(struct parser_hook *h) {
 
 void parser_destroy(struct parser *p) {
 	struct parser_hook *h;
-	parser_freeold(p);
+	mem_free(p->index);
+	mem_free(p->vals);
+	mem_free(p->line);
 	while (p->hooks)
 	{
 		h = p->hooks->next;
@@ -446,6 +512,7 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 	h->dir = string_make(name);
 	h->fhead = NULL;
 	h->ftail = NULL;
+	h->nspecs = 0;
 	while (name)
 	{
 		/* Lack of a type is legal; that means we're at the end of the
@@ -485,7 +552,9 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 		s = mem_alloc(sizeof *s);
 		s->type = type;
 		s->name = string_make(name);
+		s->key = NULL;
 		s->next = NULL;
+		h->nspecs++;
 		if (h->fhead)
 			h->ftail->next = s;
 		else
@@ -519,6 +588,7 @@ errr parser_reg(struct parser *p, const char *fmt,
 	}
 
 	p->hooks = h;
+	index_hooks(p);
 	mem_free(cfmt);
 	return 0;
 }
@@ -527,62 +597,74 @@ enum parser_error ignored(struct parser *p) {
 	return PARSE_ERROR_NONE;
 }
 
-bool parser_hasval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next)
-	{
-		if (!strcmp(v->spec.name, name))
-			return TRUE;
-	}
-	return FALSE;
-}
+/* Find a value by name.  Hooks fetch their values by the same string literals
+ * line after line, so each spec remembers the last pointer it was fetched by,
+ * and most lookups come down to comparing a pointer and then one string.  The
+ * string must still be checked, as a name which is not a literal may be kept
+ * at the same address as one used before, but hold something else. */
+static struct parser_value *parser_findval(struct parser *p, const char *name) {
+	int i;
 
-static struct parser_value *parser_getval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next)
+	for (i = 0; i < p->nvals; i++)
+		if (p->vals[i].spec->key == name && streq(p->vals[i].spec->name, name))
+			return &p->vals[i];
+
+	for (i = 0; i < p->nvals; i++)
 	{
-		if (!strcmp(v->spec.name, name))
+		if (!strcmp(p->vals[i].spec->name, name))
 		{
-			return v;
+			p->vals[i].spec->key = name;
+			return &p->vals[i];
 		}
 	}
+	return NULL;
+}
+
+bool parser_hasval(struct parser *p, const char *name) {
+	return parser_findval(p, name) ? TRUE : FALSE;
+}
+
+static struct parser_value *parser_getval(struct parser *p, const char *name) {
+	struct parser_value *v = parser_findval(p, name);
+	if (v)
+		return v;
 	quit_fmt("parser_getval error: name is %s\n", name);
 	return 0; /* Needed to avoid Windows compiler warning */
 }
 
 const char *parser_getsym(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_SYM);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_SYM);
 	return v->u.sval;
 }
 
 int parser_getint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_INT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_INT);
 	return v->u.ival;
 }
 
 unsigned int parser_getuint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_UINT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_UINT);
 	return v->u.uval;
 }
 
 const char *parser_getstr(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_STR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_STR);
 	return v->u.sval;
 }
 
 struct random parser_getrand(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_RAND);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_RAND);
 	return v->u.rval;
 }
 
 wchar_t parser_getchar(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_CHAR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_CHAR);
 	return v->u.cval;
 }
 
@@ -612,9 +694,96 @@ static void print_error(struct file_parser *fp, struct parser *p) {
 	quit_fmt("Parse error in %s line %d column %d.", fp->name, s.line, s.col);
 }
 
+/* Binary buffers for the edit file cache */
+static struct raw *raw_in;
+static struct raw *raw_out;
+
+void raw_put(struct raw *r, const void *data, size_t n) {
+	if (r->len + n > r->size) {
+		r->size = MAX(2 * r->size, r->len + n);
+		r->buf = mem_realloc(r->buf, MAX(r->size, 1));
+	}
+	memcpy(r->buf + r->len, data, n);
+	r->len += n;
+}
+
+void raw_put_u32(struct raw *r, u32b v) {
+	raw_put(r, &v, sizeof(v));
+}
+
+/* Strings are stored with their length plus one, so that NULL can be zero */
+void raw_put_str(struct raw *r, const char *s) {
+	size_t len = s ? strlen(s) : 0;
+	raw_put_u32(r, s ? len + 1 : 0);
+	if (s)
+		raw_put(r, s, len);
+}
+
+void raw_get(struct raw *r, void *data, size_t n) {
+	if (r->bad || n > r->len - r->pos) {
+		r->bad = TRUE;
+		memset(data, 0, n);
+		return;
+	}
+	memcpy(data, r->buf + r->pos, n);
+	r->pos += n;
+}
+
+u32b raw_get_u32(struct raw *r) {
+	u32b v;
+	raw_get(r, &v, sizeof(v));
+	return v;
+}
+
+/* References to array entries are stored as their index plus one, so that NULL
+ * can be zero; an index past `max` marks the buffer as bad */
+u32b raw_get_ref(struct raw *r, size_t max) {
+	u32b ref = raw_get_u32(r);
+	if (ref > max) {
+		r->bad = TRUE;
+		return 0;
+	}
+	return ref;
+}
+
+char *raw_get_str(struct raw *r) {
+	u32b len = raw_get_u32(r);
+	char *s;
+
+	if (!len || r->bad || len - 1 > r->len - r->pos) {
+		if (len) r->bad = TRUE;
+		return NULL;
+	}
+	s = mem_alloc(len);
+	raw_get(r, s, len - 1);
+	s[len - 1] = '\0';
+	return s;
+}
+
+void raw_free(struct raw *r) {
+	mem_free(r->buf);
+	memset(r, 0, sizeof(*r));
+}
+
+void parser_set_cache(struct raw *in, struct raw *out) {
+	raw_in = in;
+	raw_out = out;
+}
+
 errr run_parser(struct file_parser *fp) {
-	struct parser *p = fp->init();
+	struct parser *p;
 	errr r;
+
+	/* Take the arrays from the cache where we can.  If it turns out to be
+	 * bad, free whatever was loaded and parse the text instead. */
+	if (fp->load && raw_in && !raw_in->bad) {
+		fp->load(raw_in);
+		if (!raw_in->bad)
+			return 0;
+		fp->cleanup();
+	}
+
+	p = fp->init();
 	if (!p) {
 		return PARSE_ERROR_GENERIC;
 	}
@@ -626,6 +795,8 @@ errr run_parser(struct file_parser *fp) {
 	r = fp->finish(p);
 	if (r)
 		print_error(fp, p);
+	else if (fp->save && raw_out)
+		fp->save(raw_out);
 	return r;
 }
 
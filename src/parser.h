@@ -52,12 +52,29 @@ struct parser_state {
 	char *msg;
 };
 
+/** A buffer of parsed arrays in binary form, for the edit file cache.
+ *
+ * Values are appended with raw_put*() and read back in the same order with
+ * raw_get*(). Reading past the end sets `bad` rather than failing.
+ */
+struct raw {
+	byte *buf;
+	size_t len;
+	size_t size;
+	size_t pos;
+	bool bad;
+};
+
 struct file_parser {
 	const char *name;
 	struct parser *(*init)(void);
 	errr (*run)(struct parser *p);
 	errr (*finish)(struct parser *p);
 	void (*cleanup)(void);
+
+	/* Optional: write out the finished arrays, and read them back in */
+	void (*save)(struct raw *r);
+	void (*load)(struct raw *r);
 };
 
 extern const char *parser_error_str[PARSE_ERROR_MAX];
@@ -132,6 +149,20 @@ extern int parser_getstate(struct parser *p, struct parser_state *s);
 /** Sets the parser's detailed error description and field number. */
 extern void parser_setstate(struct parser *p, unsigned int col, const char *msg);
 
+extern void raw_put(struct raw *r, const void *data, size_t n);
+extern void raw_put_u32(struct raw *r, u32b v);
+extern void raw_put_str(struct raw *r, const char *s);
+extern void raw_get(struct raw *r, void *data, size_t n);
+extern u32b raw_get_u32(struct raw *r);
+extern u32b raw_get_ref(struct raw *r, size_t max);
+extern char *raw_get_str(struct raw *r);
+extern void raw_free(struct raw *r);
+
+/** Sets the cache that run_parser() loads arrays from, and the one it saves
+ * them to. Either may be NULL.
+ */
+extern void parser_set_cache(struct raw *in, struct raw *out);
+
 errr run_parser(struct file_parser *fp);
 errr parse_file(struct parser *p, const char *filename);
 void cleanup_parser(struct file_parser *fp);
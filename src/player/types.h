@@ -147,7 +147,7 @@ typedef struct player
 	s16b inven_cnt;			/* Number of items in inventory */
 	s16b equip_cnt;			/* Number of items in equipment */
 
-	struct monster *health_who;		/* Health bar trackee */
+	slot_handle health_who;		/* Health bar trackee */
 
 	s16b monster_race_idx;	/* Monster race trackee */
 
@@ -391,6 +391,8 @@ typedef struct
 	
 	byte delay_factor;		/* Delay factor (0 to 9) */
 	
+	byte distant_range;		/* Distant monster range (0 for none) */
+	
 	byte name_suffix;		/* numeric suffix for player name */
 } player_other;
 
@@ -20,6 +20,7 @@
 #include "cave.h"
 #include "history.h"
 #include "monster/mon-make.h"
+#include "monster/mon-sched.h"
 #include "monster/monster.h"
 #include "option.h"
 #include "savefile.h"
@@ -155,6 +156,7 @@ void wr_options(void)
 	wr_byte(op_ptr->delay_factor);
 	wr_byte(op_ptr->hitpoint_warn);
 	wr_u16b(lazymove_delay);
+	wr_byte(op_ptr->distant_range);
 
 	/* Normal options */
 	for (i = 0; i < OPT_MAX; i++) {
@@ -627,9 +629,9 @@ void wr_dungeon(void)
 	prev_char = 0;
 
 	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
 			/* Extract the important cave->info flags */
 			tmp8u = (cave->info[y][x] & (IMPORTANT_FLAGS));
@@ -665,9 +667,9 @@ void wr_dungeon(void)
 	prev_char = 0;
 
 	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
 			/* Keep all the information from info2 */
 			tmp8u = cave->info2[y][x];
@@ -704,9 +706,9 @@ void wr_dungeon(void)
 	prev_char = 0;
 
 	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
 			/* Extract a byte */
 			tmp8u = cave->feat[y][x];
@@ -790,7 +792,7 @@ void wr_monsters(void)
 		wr_s16b(m_ptr->hp);
 		wr_s16b(m_ptr->maxhp);
 		wr_byte(m_ptr->mspeed);
-		wr_byte(m_ptr->energy);
+		wr_byte(mon_energy(m_ptr));
 		wr_byte(MON_TMD_MAX);
 
 		for (j = 0; j < MON_TMD_MAX; j++)
@@ -803,7 +805,7 @@ void wr_monsters(void)
 			wr_byte(m_ptr->known_pflags[j]);
 		if (j < OF_BYTES) pad_bytes(OF_BYTES - j);
 		
-		wr_byte(0);
+		wr_byte(m_ptr->lod_turns);
 	}
 }
 
@@ -78,7 +78,7 @@ static const struct {
 	u32b version;	
 } savers[] = {
 	{ "rng", wr_randomizer, 1 },
-	{ "options", wr_options, 2 },
+	{ "options", wr_options, 3 },
 	{ "messages", wr_messages, 1 },
 	{ "monster memory", wr_monster_memory, 2 },
 	{ "object memory", wr_object_memory, 1 },
@@ -92,9 +92,9 @@ static const struct {
 	{ "randarts", wr_randarts, 3 },
 	{ "inventory", wr_inventory, 4 },
 	{ "stores", wr_stores, 4 },
-	{ "dungeon", wr_dungeon, 1 },
+	{ "dungeon", wr_dungeon, 2 },
 	{ "objects", wr_objects, 4 },
-	{ "monsters", wr_monsters, 6 },
+	{ "monsters", wr_monsters, 7 },
 	{ "ghost", wr_ghost, 1 },
 	{ "history", wr_history, 1 },
 };
@@ -108,6 +108,7 @@ static const struct {
 	{ "rng", rd_randomizer, 1 },
 	{ "options", rd_options_1, 1 },
 	{ "options", rd_options_2, 2 },
+	{ "options", rd_options_3, 3 },
 	{ "messages", rd_messages, 1 },
 	{ "monster memory", rd_monster_memory_1, 1 },
 	{ "monster memory", rd_monster_memory_2, 2 },
@@ -131,7 +132,8 @@ static const struct {
 	{ "stores", rd_stores_2, 2 },
 	{ "stores", rd_stores_3, 3 },
 	{ "stores", rd_stores_4, 4 },	
-	{ "dungeon", rd_dungeon, 1 },
+	{ "dungeon", rd_dungeon_1, 1 },
+	{ "dungeon", rd_dungeon_2, 2 },
 	{ "objects", rd_objects_1, 1 },
 	{ "objects", rd_objects_2, 2 },
 	{ "objects", rd_objects_3, 3 },
@@ -142,6 +144,7 @@ static const struct {
 	{ "monsters", rd_monsters_4, 4 },
 	{ "monsters", rd_monsters_5, 5 },
 	{ "monsters", rd_monsters_6, 6 },
+	{ "monsters", rd_monsters_6, 7 },
 	{ "ghost", rd_ghost, 1 },
 	{ "history", rd_history, 1 },
 };
@@ -46,6 +46,7 @@ void strip_bytes(int n);
 int rd_randomizer(void);
 int rd_options_1(void);
 int rd_options_2(void);
+int rd_options_3(void);
 int rd_messages(void);
 int rd_monster_memory_1(void);
 int rd_monster_memory_2(void);
@@ -69,7 +70,8 @@ int rd_stores_1(void);
 int rd_stores_2(void);
 int rd_stores_3(void);
 int rd_stores_4(void);
-int rd_dungeon(void);
+int rd_dungeon_1(void);
+int rd_dungeon_2(void);
 int rd_objects_1(void);
 int rd_objects_2(void);
 int rd_objects_3(void);
@@ -1332,6 +1332,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 		{
 			/* Turn on the light */
 			cave->info[y][x] |= (CAVE_GLOW);
+			cave_note_view_change(cave, y, x);
 
 			/* Grid is in line of sight */
 			if (player_has_los_bold(y, x))
@@ -1357,6 +1358,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			{
 				/* Turn off the light */
 				cave->info[y][x] &= ~(CAVE_GLOW);
+				cave_note_view_change(cave, y, x);
 
 				/* Hack -- Forget "boring" grids */
 				if (cave->feat[y][x] <= FEAT_INVIS)
@@ -2237,7 +2239,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ,
 			if (m_ptr->hp > m_ptr->maxhp) m_ptr->hp = m_ptr->maxhp;
 
 			/* Redraw (later) if needed */
-			if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+			if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 			/* Message */
 			else m_note = MON_MSG_HEALTHIER;
@@ -2725,7 +2727,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ,
 	if (who > 0)
 	{
 		/* Redraw (later) if needed */
-		if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
+		if (health_tracked(p_ptr) == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 		/* Wake the monster up */
 		mon_clear_timed(m_ptr, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, FALSE);
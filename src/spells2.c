@@ -22,6 +22,7 @@
 #include "history.h"
 #include "monster/mon-lore.h"
 #include "monster/mon-make.h"
+#include "monster/mon-spatial.h"
 #include "monster/mon-timed.h"
 #include "monster/mon-util.h"
 #include "monster/monster.h"
@@ -488,8 +489,8 @@ void map_area(void)
 	/* Drag the co-ordinates into the dungeon */
 	if (y1 < 0) y1 = 0;
 	if (x1 < 0) x1 = 0;
-	if (y2 > DUNGEON_HGT - 1) y2 = DUNGEON_HGT - 1;
-	if (x2 > DUNGEON_WID - 1) x2 = DUNGEON_WID - 1;
+	if (y2 > cave->height - 1) y2 = cave->height - 1;
+	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++)
@@ -944,8 +945,9 @@ bool detect_objects_magic(bool aware)
  */
 bool detect_monsters_normal(bool aware)
 {
-	int i, y, x;
+	int k, n;
 	int x1, x2, y1, y2;
+	s16b *list;
 
 	bool flag = FALSE;
 
@@ -956,27 +958,20 @@ bool detect_monsters_normal(bool aware)
 	x1 = p_ptr->px - DETECT_DIST_X;
 	x2 = p_ptr->px + DETECT_DIST_X;
 
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
+	/* Find the monsters there */
+	n = mon_spatial_count(cave, y1, x1, y2, x2);
+	list = C_RNEW(n + 1, s16b);
+	n = mon_spatial_rect(cave, y1, x1, y2, x2, list);
 
 
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++)
+	for (k = 0; k < n; k++)
 	{
+		int i = list[k];
 		monster_type *m_ptr = cave_monster(cave, i);
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect all non-invisible, obvious monsters */
 		if (!rf_has(r_ptr->flags, RF_INVISIBLE) && !m_ptr->unaware)
 		{
@@ -991,6 +986,8 @@ bool detect_monsters_normal(bool aware)
 		}
 	}
 
+	FREE(list);
+
 	if (flag)
 		msg("You sense the presence of monsters!");
 	else if (aware && !flag)
@@ -1006,8 +1003,9 @@ bool detect_monsters_normal(bool aware)
  */
 bool detect_monsters_invis(bool aware)
 {
-	int i, y, x;
+	int k, n;
 	int x1, x2, y1, y2;
+	s16b *list;
 
 	bool flag = FALSE;
 
@@ -1017,27 +1015,20 @@ bool detect_monsters_invis(bool aware)
 	x1 = p_ptr->px - DETECT_DIST_X;
 	x2 = p_ptr->px + DETECT_DIST_X;
 
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
+	/* Find the monsters there */
+	n = mon_spatial_count(cave, y1, x1, y2, x2);
+	list = C_RNEW(n + 1, s16b);
+	n = mon_spatial_rect(cave, y1, x1, y2, x2, list);
 
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++)
+	for (k = 0; k < n; k++)
 	{
+		int i = list[k];
 		monster_type *m_ptr = cave_monster(cave, i);
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 		monster_lore *l_ptr = &l_list[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby objects */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect invisible monsters */
 		if (rf_has(r_ptr->flags, RF_INVISIBLE))
 		{
@@ -1062,6 +1053,8 @@ bool detect_monsters_invis(bool aware)
 		}
 	}
 
+	FREE(list);
+
 	if (flag)
 		msg("You sense the presence of invisible creatures!");
 	else if (aware && !flag)
@@ -1077,8 +1070,9 @@ bool detect_monsters_invis(bool aware)
  */
 bool detect_monsters_evil(bool aware)
 {
-	int i, y, x;
+	int k, n;
 	int x1, x2, y1, y2;
+	s16b *list;
 
 	bool flag = FALSE;
 
@@ -1088,27 +1082,20 @@ bool detect_monsters_evil(bool aware)
 	x1 = p_ptr->px - DETECT_DIST_X;
 	x2 = p_ptr->px + DETECT_DIST_X;
 
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
+	/* Find the monsters there */
+	n = mon_spatial_count(cave, y1, x1, y2, x2);
+	list = C_RNEW(n + 1, s16b);
+	n = mon_spatial_rect(cave, y1, x1, y2, x2, list);
 
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++)
+	for (k = 0; k < n; k++)
 	{
+		int i = list[k];
 		monster_type *m_ptr = cave_monster(cave, i);
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 		monster_lore *l_ptr = &l_list[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby objects */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect evil monsters */
 		if (rf_has(r_ptr->flags, RF_EVIL))
 		{
@@ -1133,6 +1120,8 @@ bool detect_monsters_evil(bool aware)
 		}
 	}
 
+	FREE(list);
+
 	if (flag)
 		msg("You sense the presence of evil creatures!");
 	else if (aware && !flag)
@@ -1683,16 +1672,25 @@ bool recharge(int spell_strength)
  */
 bool project_los(int typ, int dam, bool obvious)
 {
-	int i, x, y;
+	int i, k, n, x, y;
+	s16b *list;
 
 	int flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
 
 	if (obvious) flg |= PROJECT_AWARE;
 
+	/* Only monsters within sight can be in view */
+	n = mon_spatial_count_near(cave, p_ptr->py, p_ptr->px, MAX_SIGHT);
+	list = C_RNEW(n + 1, s16b);
+	n = mon_spatial_near(cave, p_ptr->py, p_ptr->px, MAX_SIGHT, list);
+
 	/* Affect all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++)
+	for (k = 0; k < n; k++)
 	{
-		monster_type *m_ptr = cave_monster(cave, i);
+		monster_type *m_ptr;
+
+		i = list[k];
+		m_ptr = cave_monster(cave, i);
 
 		/* Paranoia -- Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -1708,6 +1706,8 @@ bool project_los(int typ, int dam, bool obvious)
 		if (project(-1, 0, y, x, dam, typ, flg)) obvious = TRUE;
 	}
 
+	FREE(list);
+
 	/* Result */
 	return (obvious);
 }
@@ -1797,17 +1797,23 @@ bool dispel_monsters(int dam)
  */
 void aggravate_monsters(int who)
 {
-	int i;
+	int i, k, n;
+	s16b *list;
 
 	bool sleep = FALSE;
 
+	/* Only monsters this close are woken, or can be in view */
+	n = mon_spatial_count_near(cave, p_ptr->py, p_ptr->px, MAX_SIGHT * 2);
+	list = C_RNEW(n + 1, s16b);
+	n = mon_spatial_near(cave, p_ptr->py, p_ptr->px, MAX_SIGHT * 2, list);
+
 	/* Aggravate everyone nearby */
-	for (i = 1; i < cave_monster_max(cave); i++)
+	for (k = 0; k < n; k++)
 	{
-		monster_type *m_ptr = cave_monster(cave, i);
+		monster_type *m_ptr;
 
-		/* Paranoia -- Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
+		i = list[k];
+		m_ptr = cave_monster(cave, i);
 
 		/* Skip aggravating monster (or player) */
 		if (i == who) continue;
@@ -1829,6 +1835,8 @@ void aggravate_monsters(int who)
 			mon_inc_timed(m_ptr, MON_TMD_FAST, 25, MON_TMD_FLG_NOTIFY, FALSE);
 	}
 
+	FREE(list);
+
 	/* Messages */
 	if (sleep) msg("You hear a sudden stirring in the distance!");
 }
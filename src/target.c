@@ -36,8 +36,8 @@
 /* Is the target set? */
 bool target_set;
 
-/* Current monster being tracked, or 0 */
-u16b target_who;
+/* Handle of the monster being tracked, or 0 */
+static slot_handle target_who;
 
 /* Target location */
 s16b target_x, target_y;
@@ -147,17 +147,18 @@ bool target_able(int m_idx)
  */
 bool target_okay(void)
 {
+	int m_idx;
+
 	/* No target */
 	if (!target_set) return (FALSE);
 
 	/* Accept "location" targets */
 	if (target_who == 0) return (TRUE);
 
-	/* Check "monster" targets */
-	if (target_who > 0)
+	/* Check "monster" targets, which may have gone */
+	m_idx = target_get_monster();
+	if (m_idx > 0)
 	{
-		int m_idx = target_who;
-
 		/* Accept reasonable targets */
 		if (target_able(m_idx))
 		{
@@ -189,7 +190,7 @@ void target_set_monster(int m_idx)
 
 		/* Save target info */
 		target_set = TRUE;
-		target_who = m_idx;
+		target_who = cave_monster_handle(cave, m_idx);
 		target_y = m_ptr->fy;
 		target_x = m_ptr->fx;
 	}
@@ -1638,8 +1639,8 @@ bool target_set_interactive(int mode, int x, int y)
 				/*if (press.mouse.button == 3) {
 				} else*/
 				{
-					int dungeon_hgt = (p_ptr->depth == 0) ? TOWN_HGT : DUNGEON_HGT;
-					int dungeon_wid = (p_ptr->depth == 0) ? TOWN_WID : DUNGEON_WID;
+					int dungeon_hgt = cave->height;
+					int dungeon_wid = cave->width;
 
 					y = KEY_GRID_Y(press);//.mouse.y;
 					x = KEY_GRID_X(press);//.mouse.x;
@@ -1800,8 +1801,8 @@ bool target_set_interactive(int mode, int x, int y)
 			/* Handle "direction" */
 			if (d)
 			{
-				int dungeon_hgt = (p_ptr->depth == 0) ? TOWN_HGT : DUNGEON_HGT;
-				int dungeon_wid = (p_ptr->depth == 0) ? TOWN_WID : DUNGEON_WID;
+				int dungeon_hgt = cave->height;
+				int dungeon_wid = cave->width;
 
 				/* Move */
 				x += ddx[d];
@@ -1880,5 +1881,36 @@ void target_get(s16b *col, s16b *row)
  */
 s16b target_get_monster(void)
 {
-	return target_who;
+	struct monster *m_ptr;
+
+	if (!target_who) return 0;
+
+	m_ptr = cave_monster_byhandle(cave, target_who);
+	return m_ptr ? m_ptr->midx : 0;
 }
+
+
+/**
+ * Keep the target as it is, for target_restore() to put back exactly,
+ * even if the monster has gone out of sight in the meantime.
+ */
+void target_save(struct target *t)
+{
+	t->set = target_set;
+	t->who = target_who;
+	t->x = target_x;
+	t->y = target_y;
+}
+
+
+/**
+ * Put back a target kept by target_save()
+ */
+void target_restore(const struct target *t)
+{
+	target_set = t->set;
+	target_who = t->who;
+	target_x = t->x;
+	target_y = t->y;
+}
+
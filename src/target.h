@@ -3,6 +3,17 @@
 #ifndef TARGET_H
 #define TARGET_H
 
+#include "z-slot.h"
+
+/*
+ * The whole of the target, as kept by target_save()
+ */
+struct target {
+	bool set;
+	slot_handle who;
+	s16b x, y;
+};
+
 bool target_able(int m_idx);
 bool target_okay(void);
 bool target_set_closest(int mode);
@@ -12,5 +23,7 @@ bool target_set_interactive(int mode, int x, int y);
 bool get_aim_dir(int *dp);
 void target_get(s16b *col, s16b *row);
 s16b target_get_monster(void);
+void target_save(struct target *t);
+void target_restore(const struct target *t);
 
 #endif /* !TARGET_H */
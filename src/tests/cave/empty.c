@@ -0,0 +1,232 @@
+/* cave/empty
+ *
+ * Tests for the set of empty squares kept by each cave
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-make.h"
+#include "monster/mon-util.h"
+#include "object/object.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Check the set holds exactly the empty squares, each once */
+static bool set_matches(void) {
+	int y, x, i, n = 0;
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++) {
+			int g = y * DUNGEON_WID + x;
+			int pos = cave->empty_pos[g];
+
+			if (!cave_in_bounds(cave, y, x) || !cave_isempty(cave, y, x)) {
+				if (pos != -1) return FALSE;
+				continue;
+			}
+
+			if (pos < 0 || pos >= cave->empty_n) return FALSE;
+			if (cave->empty[pos] != g) return FALSE;
+			n++;
+		}
+
+	for (i = 0; i < cave->empty_n; i++)
+		if (cave->empty_pos[cave->empty[i]] != i) return FALSE;
+
+	return n == cave->empty_n;
+}
+
+/* Some ordinary monster race */
+static int any_race(void) {
+	int r_idx;
+
+	do r_idx = randint1(z_info->r_max - 1);
+	while (!r_info[r_idx].name || rf_has(r_info[r_idx].flags, RF_UNIQUE));
+
+	return r_idx;
+}
+
+/* A random square of the level, away from the edge */
+static void any_square(int *y, int *x) {
+	*y = randint1(cave->height - 2);
+	*x = randint1(cave->width - 2);
+}
+
+int test_generate(void *state) {
+	int depth;
+
+	for (depth = 0; depth < 100; depth += 9) {
+		p_ptr->depth = depth;
+		cave_generate_seed(cave, p_ptr, depth + 1);
+		character_dungeon = FALSE;
+		eq(set_matches(), TRUE);
+		require(cave->empty_n > 0);
+	}
+
+	ok;
+}
+
+int test_changes(void *state) {
+	int i, y, x;
+
+	p_ptr->depth = 20;
+	cave_generate_seed(cave, p_ptr, 5);
+	character_dungeon = FALSE;
+	Rand_state_init(6);
+
+	for (i = 0; i < 5000; i++) {
+		int y2, x2;
+
+		any_square(&y, &x);
+
+		switch (randint0(6)) {
+			case 0:
+				if (cave_isempty(cave, y, x))
+					place_new_monster(cave, y, x, any_race(), TRUE,
+						FALSE, ORIGIN_DROP);
+				break;
+			case 1:
+				if (cave->m_idx[y][x] > 0) delete_monster(y, x);
+				break;
+			case 2:
+				if (cave_canputitem(cave, y, x))
+					place_object(cave, y, x, 20, FALSE, FALSE, ORIGIN_FLOOR);
+				break;
+			case 3:
+				delete_object(y, x);
+				break;
+			case 4:
+				if (!cave->m_idx[y][x] && !cave->o_idx[y][x])
+					cave_set_feat(cave, y, x,
+						one_in_(2) ? FEAT_FLOOR : FEAT_RUBBLE);
+				break;
+			case 5:
+				/* Walk a monster onto an empty square */
+				any_square(&y2, &x2);
+				if (cave->m_idx[y][x] > 0 && cave_isempty(cave, y2, x2))
+					monster_swap(y, x, y2, x2);
+				break;
+		}
+
+		if (i % 100 == 0) eq(set_matches(), TRUE);
+	}
+
+	eq(set_matches(), TRUE);
+	ok;
+}
+
+int test_find(void *state) {
+	int i, y, x, n = 0;
+
+	p_ptr->depth = 30;
+	cave_generate_seed(cave, p_ptr, 9);
+	character_dungeon = FALSE;
+
+	for (i = 0; i < 1000; i++) {
+		require(cave_pick_empty(cave, &y, &x));
+		require(cave_isempty(cave, y, x));
+
+		require(cave_find_empty(cave, &y, &x, cave_isroom) > 0);
+		require(cave_isempty(cave, y, x) && cave_isroom(cave, y, x));
+	}
+
+	/* Searching doesn't lose track of anything */
+	eq(set_matches(), TRUE);
+
+	/* Every square is tried before giving up */
+	for (i = 0; i < cave->empty_n; i++) {
+		int g = cave->empty[i];
+
+		if (cave_isvault(cave, g / DUNGEON_WID, g % DUNGEON_WID)) n++;
+	}
+	if (!n) eq(cave_find_empty(cave, &y, &x, cave_isvault), 0);
+
+	/* Starting again from scratch finds the same squares */
+	cave_reset_empty(cave);
+	eq(set_matches(), TRUE);
+
+	ok;
+}
+
+static byte first[DUNGEON_HGT][DUNGEON_WID];
+
+/* Check the level's terrain against first[], in the given rectangle */
+static bool same_feat(int h, int w) {
+	int y, x;
+
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			if (cave->feat[y][x] != first[y][x]) return FALSE;
+
+	return TRUE;
+}
+
+int test_resize(void *state) {
+	int y, x, walls = 0;
+	int h = DUNGEON_HGT / 2, w = DUNGEON_WID / 3;
+
+	p_ptr->depth = 10;
+	cave_generate_seed(cave, p_ptr, 12);
+	character_dungeon = FALSE;
+	eq(cave->height, DUNGEON_HGT);
+	eq(cave->width, DUNGEON_WID);
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			first[y][x] = cave->feat[y][x];
+
+	/* Shrinking keeps the squares that are left, and only those */
+	wipe_o_list(cave);
+	wipe_mon_list(cave, p_ptr);
+	cave_set_dimensions(cave, h, w);
+	eq(cave->height, h);
+	eq(cave->width, w);
+	eq(same_feat(h, w), TRUE);
+	eq(set_matches(), TRUE);
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			if (cave_iswall(cave, y, x)) walls++;
+	eq(cave_count_walls(cave, 0, 0, h - 1, w - 1), walls);
+
+	/* Growing again leaves the new squares blank */
+	cave_set_dimensions(cave, DUNGEON_HGT, DUNGEON_WID);
+	eq(same_feat(h, w), TRUE);
+	eq(set_matches(), TRUE);
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++) {
+			if (y < h && x < w) continue;
+			require(!cave->feat[y][x] && !cave->info[y][x] &&
+				!cave->m_idx[y][x] && !cave->o_idx[y][x]);
+		}
+
+	/* A level comes out the same whatever size the last one was */
+	cave_set_dimensions(cave, h, w);
+	cave_generate_seed(cave, p_ptr, 12);
+	character_dungeon = FALSE;
+	eq(same_feat(DUNGEON_HGT, DUNGEON_WID), TRUE);
+	eq(set_matches(), TRUE);
+	ok;
+}
+
+const char *suite_name = "cave/empty";
+struct test tests[] = {
+	{ "generate", test_generate },
+	{ "changes", test_changes },
+	{ "find", test_find },
+	{ "resize", test_resize },
+	{ NULL, NULL }
+};
@@ -0,0 +1,129 @@
+/* cave/feature
+ *
+ * Tests for the feature predicates and the wall plane
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(3);
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Each predicate as it used to be written, by the FEAT_ numbering */
+static bool in(int f, int lo, int hi) {
+	return f >= lo && f <= hi;
+}
+
+static int check_feat(int f) {
+	struct cave *c = cave;
+	bool rock = in(f, FEAT_WALL_EXTRA, FEAT_WALL_SOLID);
+	bool magma = f == FEAT_MAGMA || f == FEAT_MAGMA_H || f == FEAT_MAGMA_K;
+	bool quartz = f == FEAT_QUARTZ || f == FEAT_QUARTZ_H ||
+		f == FEAT_QUARTZ_K;
+	bool perm = in(f, FEAT_PERM_EXTRA, FEAT_PERM_SOLID);
+	bool closed = in(f, FEAT_DOOR_HEAD, FEAT_DOOR_TAIL);
+
+	c->feat[1][1] = f;
+
+	if (cave_isfloor(c, 1, 1) != (f == FEAT_FLOOR)) return 1;
+	if (cave_isrock(c, 1, 1) != rock) return 2;
+	if (cave_isperm(c, 1, 1) != perm) return 3;
+	if (cave_ismagma(c, 1, 1) != magma) return 4;
+	if (cave_isquartz(c, 1, 1) != quartz) return 5;
+	if (cave_ismineral(c, 1, 1) != (rock || magma || quartz)) return 6;
+	if (cave_isrubble(c, 1, 1) != (f == FEAT_RUBBLE)) return 7;
+	if (cave_issecretdoor(c, 1, 1) != (f == FEAT_SECRET)) return 8;
+	if (cave_isopendoor(c, 1, 1) != (f == FEAT_OPEN)) return 9;
+	if (cave_iscloseddoor(c, 1, 1) != closed) return 10;
+	if (cave_islockeddoor(c, 1, 1) !=
+			in(f, FEAT_DOOR_HEAD + 0x01, FEAT_DOOR_TAIL)) return 11;
+	if (cave_isjammeddoor(c, 1, 1) !=
+			in(f, FEAT_DOOR_HEAD + 0x08, FEAT_DOOR_TAIL)) return 12;
+	if (cave_isdoor(c, 1, 1) !=
+			(f == FEAT_OPEN || f == FEAT_SECRET || closed)) return 13;
+	if (cave_issecrettrap(c, 1, 1) != (f == FEAT_INVIS)) return 14;
+	if (cave_isknowntrap(c, 1, 1) !=
+			in(f, FEAT_TRAP_HEAD, FEAT_TRAP_TAIL)) return 15;
+	if (cave_istrap(c, 1, 1) != (f == FEAT_INVIS ||
+			in(f, FEAT_TRAP_HEAD, FEAT_TRAP_TAIL))) return 16;
+	if (cave_isdiggable(c, 1, 1) != (rock || magma || quartz ||
+			f == FEAT_SECRET || f == FEAT_RUBBLE)) return 17;
+	if (cave_isstrongwall(c, 1, 1) != (rock || magma || quartz || perm))
+		return 18;
+
+	return 0;
+}
+
+int test_predicates(void *state) {
+	int f;
+
+	for (f = 0; f < 256; f++)
+		eq(check_feat(f), 0);
+
+	ok;
+}
+
+/* Count walls one square at a time */
+static int ref_count_walls(int y1, int x1, int y2, int x2) {
+	int y, x, n = 0;
+
+	for (y = y1; y <= y2; y++)
+		for (x = x1; x <= x2; x++)
+			if (cave_iswall(cave, y, x)) n++;
+
+	return n;
+}
+
+int test_wall_plane(void *state) {
+	int i;
+
+	for (i = 0; i < 20000; i++) {
+		int y = randint0(DUNGEON_HGT), x = randint0(DUNGEON_WID);
+
+		cave_set_feat(cave, y, x, one_in_(2) ? FEAT_FLOOR :
+			randint0(FEAT_PERM_SOLID + 1));
+	}
+
+	eq(cave_count_walls(cave, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1),
+		ref_count_walls(0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1));
+
+	/* Rectangles with ends inside words, and on their edges */
+	for (i = 0; i < 2000; i++) {
+		int y1 = randint0(DUNGEON_HGT), y2 = randint0(DUNGEON_HGT);
+		int x1 = randint0(DUNGEON_WID), x2 = randint0(DUNGEON_WID);
+
+		if (i % 4 == 0) x1 = 32 * randint0(DUNGEON_WID / 32);
+		if (i % 4 == 1) x2 = MIN(32 * randint1(DUNGEON_WID / 32) - 1,
+			DUNGEON_WID - 1);
+		if (y1 > y2 || x1 > x2) continue;
+
+		eq(cave_count_walls(cave, y1, x1, y2, x2),
+			ref_count_walls(y1, x1, y2, x2));
+	}
+
+	/* Wiping the level clears the plane too */
+	cave_wipe(cave);
+	eq(cave_count_walls(cave, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1), 0);
+	ok;
+}
+
+const char *suite_name = "cave/feature";
+struct test tests[] = {
+	{ "predicates", test_predicates },
+	{ "wall-plane", test_wall_plane },
+	{ NULL, NULL }
+};
@@ -0,0 +1,201 @@
+/* cave/flow
+ *
+ * Tests for the distance fields in flow.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "flow.h"
+#include "monster/constants.h"
+
+#define FLOW_TEST_STEPS 2000
+
+static s16b ref_dist[DUNGEON_HGT][DUNGEON_WID];
+static u16b ref_queue[DUNGEON_HGT * DUNGEON_WID];
+
+int setup_tests(void **state) {
+	int y, x;
+
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(42);
+	Rand_quick = FALSE;
+
+	/* An open level with scattered rubble and walls */
+	for (y = 0; y < DUNGEON_HGT; y++) {
+		for (x = 0; x < DUNGEON_WID; x++) {
+			int feat = FEAT_FLOOR;
+
+			if (!cave_in_bounds_fully(cave, y, x))
+				feat = FEAT_PERM_SOLID;
+			else if (one_in_(4))
+				feat = FEAT_WALL_EXTRA;
+			else if (one_in_(20))
+				feat = FEAT_RUBBLE;
+
+			cave_set_feat(cave, y, x, feat);
+		}
+	}
+
+	p_ptr->py = DUNGEON_HGT / 2;
+	p_ptr->px = DUNGEON_WID / 2;
+	cave_set_feat(cave, p_ptr->py, p_ptr->px, FEAT_FLOOR);
+
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* A plain breadth-first flood from the player, as a reference */
+static void reference_flow(void) {
+	int head = 0, tail = 0;
+	int y, x;
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			ref_dist[y][x] = -1;
+
+	ref_dist[p_ptr->py][p_ptr->px] = 0;
+	ref_queue[tail++] = p_ptr->py * DUNGEON_WID + p_ptr->px;
+
+	while (head != tail) {
+		int ty = ref_queue[head] / DUNGEON_WID;
+		int tx = ref_queue[head++] % DUNGEON_WID;
+		int n = ref_dist[ty][tx] + 1;
+		int d;
+
+		if (n >= MONSTER_FLOW_DEPTH) continue;
+
+		for (d = 0; d < 8; d++) {
+			y = ty + ddy_ddd[d];
+			x = tx + ddx_ddd[d];
+
+			if (!cave_in_bounds(cave, y, x)) continue;
+			if (ref_dist[y][x] >= 0) continue;
+			if (cave->feat[y][x] >= FEAT_RUBBLE) continue;
+
+			ref_dist[y][x] = n;
+			ref_queue[tail++] = y * DUNGEON_WID + x;
+		}
+	}
+}
+
+/* Count the grids where the noise field disagrees with the reference */
+static int flow_mismatches(void) {
+	int y, x, bad = 0;
+
+	reference_flow();
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			if (flow_dist(cave, FLOW_NOISE, y, x) != ref_dist[y][x])
+				bad++;
+
+	return bad;
+}
+
+static void random_step(void) {
+	int d = randint0(8);
+	int y = p_ptr->py + ddy_ddd[d];
+	int x = p_ptr->px + ddx_ddd[d];
+
+	if (!cave_in_bounds_fully(cave, y, x)) return;
+	if (cave->feat[y][x] >= FEAT_RUBBLE) return;
+
+	p_ptr->py = y;
+	p_ptr->px = x;
+}
+
+static void random_change(void) {
+	int y = rand_spread(p_ptr->py, 10);
+	int x = rand_spread(p_ptr->px, 10);
+
+	if (!cave_in_bounds_fully(cave, y, x)) return;
+	if (y == p_ptr->py && x == p_ptr->px) return;
+
+	switch (randint0(3)) {
+		case 0:
+			cave_set_feat(cave, y, x, FEAT_FLOOR);
+			break;
+		case 1:
+			cave_set_feat(cave, y, x, FEAT_RUBBLE);
+			break;
+		case 2:
+			cave_set_feat(cave, y, x, FEAT_DOOR_HEAD);
+			break;
+	}
+}
+
+int test_incremental(void *state) {
+	int i;
+
+	cave_update_flow(cave);
+	eq(flow_mismatches(), 0);
+
+	for (i = 0; i < FLOW_TEST_STEPS; i++) {
+		int j, n = randint0(4);
+
+		if (one_in_(3)) random_step();
+		for (j = 0; j < n; j++) random_change();
+
+		cave_update_flow(cave);
+		eq(flow_mismatches(), 0);
+	}
+
+	ok;
+}
+
+int test_scent(void *state) {
+	int oy, ox;
+
+	cave_update_flow(cave);
+	oy = p_ptr->py;
+	ox = p_ptr->px;
+
+	/* Teleport away; the old position is still remembered */
+	p_ptr->py = 2;
+	p_ptr->px = 2;
+	cave_set_feat(cave, 2, 2, FEAT_FLOOR);
+	cave_update_flow(cave);
+
+	eq(flow_dist(cave, FLOW_NOISE, oy, ox), -1);
+	eq(flow_when(cave, FLOW_NOISE, oy, ox) > 0, 1);
+	eq(flow_when(cave, FLOW_NOISE, oy, ox) <
+			flow_when(cave, FLOW_NOISE, 2, 2), 1);
+
+	/* Forgetting drops the history but keeps nothing stale around */
+	cave_forget_flow(cave);
+	cave_update_flow(cave);
+	eq(flow_when(cave, FLOW_NOISE, oy, ox), 0);
+	eq(flow_dist(cave, FLOW_NOISE, 2, 2), 0);
+	ok;
+}
+
+int test_stairs(void *state) {
+	int y = p_ptr->py, x = p_ptr->px + 3;
+
+	cave_set_feat(cave, y, x - 1, FEAT_FLOOR);
+	cave_set_feat(cave, y, x - 2, FEAT_FLOOR);
+	cave_set_feat(cave, y, x, FEAT_MORE);
+	eq(flow_dist(cave, FLOW_STAIRS, y, x), 0);
+	eq(flow_dist(cave, FLOW_STAIRS, y, x - 2), 2);
+
+	cave_set_feat(cave, y, x, FEAT_FLOOR);
+	eq(flow_dist(cave, FLOW_STAIRS, y, x) != 0, 1);
+	ok;
+}
+
+const char *suite_name = "cave/flow";
+struct test tests[] = {
+	{ "incremental", test_incremental },
+	{ "scent", test_scent },
+	{ "stairs", test_stairs },
+	{ NULL, NULL }
+};
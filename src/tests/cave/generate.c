@@ -0,0 +1,134 @@
+/* cave/generate
+ *
+ * Tests for generating levels from their own random number streams
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+
+static byte first[DUNGEON_HGT][DUNGEON_WID];
+static int first_hgt, first_wid;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(42);
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Generate a level at the given depth from a seed */
+static void generate(int depth, u32b seed) {
+	p_ptr->depth = depth;
+	cave_generate_seed(cave, p_ptr, seed);
+	character_dungeon = FALSE;
+}
+
+/* Save the level's terrain in first[] */
+static void save_level(void) {
+	int y;
+
+	first_hgt = cave->height;
+	first_wid = cave->width;
+	for (y = 0; y < cave->height; y++)
+		memcpy(first[y], cave->feat[y], cave->width);
+}
+
+/* Compare the level with the one saved in first[] */
+static int same_level(void) {
+	int y, x;
+
+	if (cave->height != first_hgt || cave->width != first_wid) return FALSE;
+
+	for (y = 0; y < cave->height; y++)
+		for (x = 0; x < cave->width; x++)
+			if (cave->feat[y][x] != first[y][x]) return FALSE;
+
+	return TRUE;
+}
+
+int test_repeat(void *state) {
+	int depth;
+
+	for (depth = 1; depth < 100; depth += 7) {
+		int py, px, mons;
+
+		generate(depth, depth * 1000);
+		save_level();
+		py = p_ptr->py;
+		px = p_ptr->px;
+		mons = cave_monster_count(cave);
+
+		generate(depth, depth * 1000 + 1);
+		eq(same_level(), FALSE);
+
+		generate(depth, depth * 1000);
+		eq(same_level(), TRUE);
+		eq(p_ptr->py, py);
+		eq(p_ptr->px, px);
+		eq(cave_monster_count(cave), mons);
+	}
+
+	ok;
+}
+
+int test_game_stream(void *state) {
+	struct rand_state before, after;
+
+	/* Clear any padding, so the states can be compared whole */
+	WIPE(&before, struct rand_state);
+	WIPE(&after, struct rand_state);
+
+	Rand_state_save(&before);
+	generate(10, 7);
+	Rand_state_save(&after);
+	eq(memcmp(&before, &after, sizeof(before)), 0);
+
+	ok;
+}
+
+int test_stats(void *state) {
+	struct gen_stats stats;
+	int i, tries = 0;
+
+	generate(30, 99);
+	save_level();
+
+	/* Counting must not change the level */
+	WIPE(&stats, struct gen_stats);
+	gen_stats = &stats;
+	generate(30, 99);
+	gen_stats = NULL;
+	eq(same_level(), TRUE);
+
+	eq(stats.levels, 1);
+	require(stats.time >= 0.0);
+	require(stats.find_calls > 0);
+	require(stats.find_probes >= stats.find_calls);
+	require(stats.alloc_probes >= stats.alloc_calls);
+
+	/* One level was built for each try, after any failed profiles */
+	for (i = 0; i < GEN_STATS_BUILDERS && stats.profiles[i].name; i++)
+		tries += stats.profiles[i].tries - stats.profiles[i].fails;
+	eq(tries, 1 + stats.too_many_objects + stats.too_many_monsters);
+
+	ok;
+}
+
+const char *suite_name = "cave/generate";
+struct test tests[] = {
+	{ "repeat", test_repeat },
+	{ "game-stream", test_game_stream },
+	{ "stats", test_stats },
+	{ NULL, NULL }
+};
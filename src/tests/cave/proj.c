@@ -0,0 +1,108 @@
+/* cave/proj
+ *
+ * Tests for the cached projectable() checks to and from the player
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(5);
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* projectable() as it was, following the path every time */
+static bool ref_projectable(int y1, int x1, int y2, int x2) {
+	u16b grid_g[512];
+	int n = project_path(grid_g, MAX_RANGE, y1, x1, y2, x2, PROJECT_NONE);
+	int y, x;
+
+	if (!n) return FALSE;
+
+	y = GRID_Y(grid_g[n - 1]);
+	x = GRID_X(grid_g[n - 1]);
+	return cave_floor_bold(y, x) && y == y2 && x == x2;
+}
+
+/* Check every grid near the player, both ways, twice over */
+static int check_player(void) {
+	int py = p_ptr->py, px = p_ptr->px;
+	int pass, y, x;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (y = py - 20; y <= py + 20; y++) {
+			for (x = px - 20; x <= px + 20; x++) {
+				if (!in_bounds(y, x)) continue;
+				if (projectable(y, x, py, px, PROJECT_NONE) !=
+						ref_projectable(y, x, py, px))
+					return 1;
+				if (projectable(py, px, y, x, PROJECT_NONE) !=
+						ref_projectable(py, px, y, x))
+					return 2;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int test_cache(void *state) {
+	int i, j;
+
+	cave_set_dimensions(cave, DUNGEON_HGT, DUNGEON_WID);
+
+	for (i = 0; i < 100; i++) {
+		/* Scatter some walls, and sometimes clear them away */
+		for (j = 0; j < 300; j++)
+			cave_set_feat(cave, randint1(DUNGEON_HGT - 2),
+				randint1(DUNGEON_WID - 2),
+				one_in_(3) ? FEAT_WALL_SOLID : FEAT_FLOOR);
+
+		p_ptr->py = randint1(DUNGEON_HGT - 2);
+		p_ptr->px = randint1(DUNGEON_WID - 2);
+		eq(check_player(), 0);
+
+		/* A single wall next to the player, where the player stays */
+		cave_set_feat(cave, p_ptr->py, p_ptr->px + 1, FEAT_WALL_SOLID);
+		eq(check_player(), 0);
+		cave_set_feat(cave, p_ptr->py, p_ptr->px + 1, FEAT_FLOOR);
+		eq(check_player(), 0);
+	}
+
+	ok;
+}
+
+int test_other(void *state) {
+	int i;
+
+	/* Checks that do not involve the player, or stop at monsters */
+	for (i = 0; i < 2000; i++) {
+		int y1 = randint1(DUNGEON_HGT - 2), x1 = randint1(DUNGEON_WID - 2);
+		int y2 = y1 + rand_range(-10, 10), x2 = x1 + rand_range(-10, 10);
+
+		if (!in_bounds(y2, x2)) continue;
+		eq(projectable(y1, x1, y2, x2, PROJECT_NONE),
+			ref_projectable(y1, x1, y2, x2));
+	}
+
+	ok;
+}
+
+const char *suite_name = "cave/proj";
+struct test tests[] = {
+	{ "cache", test_cache },
+	{ "other", test_other },
+	{ NULL, NULL }
+};
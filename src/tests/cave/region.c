@@ -0,0 +1,257 @@
+/* cave/region
+ *
+ * Tests for the region labelling in generate.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+
+#define REGION_TEST_LEVELS 20
+
+static int ref_colors[DUNGEON_HGT * DUNGEON_WID];
+static int ref_counts[DUNGEON_HGT * DUNGEON_WID];
+static int ref_queue[DUNGEON_HGT * DUNGEON_WID];
+static int ref_prev[DUNGEON_HGT * DUNGEON_WID];
+
+static int xds[] = {0, 0, 1, -1, -1, -1, 1, 1};
+static int yds[] = {1, -1, 0, 0, -1, 1, -1, 1};
+
+static struct cave *other;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	other = cave_new();
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave_free(other);
+	cave = NULL;
+	return 0;
+}
+
+/* Restart the generator from a seed, so runs can be repeated */
+static void reseed(u32b seed) {
+	state_i = 0;
+	Rand_state_init(seed);
+}
+
+/* A cavern-like level of scattered floor, with the odd door and vault */
+static void random_level(struct cave *c, int h, int w, int open) {
+	int y, x;
+
+	cave_set_dimensions(c, h, w);
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			int feat = FEAT_WALL_SOLID;
+
+			c->info[y][x] = 0;
+			if (y == 0 || x == 0 || y >= h - 1 || x >= w - 1)
+				feat = FEAT_PERM_SOLID;
+			else if (randint0(100) < open)
+				feat = FEAT_FLOOR;
+			else if (one_in_(50))
+				feat = FEAT_DOOR_HEAD;
+			else if (one_in_(100))
+				c->info[y][x] |= CAVE_ICKY;
+
+			cave_set_feat(c, y, x, feat);
+		}
+	}
+}
+
+static bool ref_colorable(struct cave *c, int y, int x) {
+	if (y < 0 || x < 0 || y >= c->height || x >= c->width) return FALSE;
+	if (ref_colors[y * c->width + x]) return FALSE;
+	return cave_isvault(c, y, x) || cave_ispassable(c, y, x) ||
+		cave_isdoor(c, y, x);
+}
+
+/* The old coloring, flooding each region in turn */
+static int ref_build_colors(struct cave *c, bool diagonal) {
+	int w = c->width, size = c->height * w;
+	int y, x, color = 1;
+
+	memset(ref_colors, 0, sizeof(ref_colors));
+	memset(ref_counts, 0, sizeof(ref_counts));
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < w; x++) {
+			int head = 0, tail = 0;
+
+			if (!ref_colorable(c, y, x)) continue;
+
+			memset(ref_prev, 0, size * sizeof(int));
+			ref_queue[tail++] = y * w + x;
+			while (head < tail) {
+				int n = ref_queue[head++], i;
+				int y2 = n / w, x2 = n % w;
+
+				if (!ref_colorable(c, y2, x2)) continue;
+				ref_colors[n] = color;
+				ref_counts[color]++;
+
+				for (i = 0; i < (diagonal ? 8 : 4); i++) {
+					int y3 = y2 + yds[i], x3 = x2 + xds[i];
+
+					if (!ref_colorable(c, y3, x3)) continue;
+					if (ref_prev[y3 * w + x3]) continue;
+					ref_queue[tail++] = y3 * w + x3;
+					ref_prev[y3 * w + x3] = 1;
+				}
+			}
+			color++;
+		}
+	}
+
+	return color - 1;
+}
+
+/* The old joining, repainting each region as it is joined */
+static void ref_join_regions(struct cave *c) {
+	int w = c->width, size = c->height * w;
+	int i, color = 0, num = 0;
+
+	for (i = 0; i < size; i++) {
+		if (ref_counts[i] <= 0) continue;
+		if (!color) color = i;
+		num++;
+	}
+
+	for (; num > 1; num--) {
+		int head = 0, tail = 0;
+
+		for (i = 0; i < size; i++) {
+			ref_prev[i] = -1;
+			if (ref_colors[i] == color) {
+				ref_queue[tail++] = i;
+				ref_prev[i] = i;
+			}
+		}
+
+		while (head < tail) {
+			int n = ref_queue[head++];
+			int color2 = ref_colors[n];
+
+			if (color2 && color2 != color) {
+				while (ref_colors[n] != color) {
+					int y = n / w, x = n % w;
+
+					ref_colors[n] = color;
+					if (!cave_isperm(c, y, x) && !cave_isvault(c, y, x))
+						cave_set_feat(c, y, x, FEAT_FLOOR);
+					n = ref_prev[n];
+				}
+				for (i = 0; i < size; i++)
+					if (ref_colors[i] == color2) ref_colors[i] = color;
+				ref_counts[color] += ref_counts[color2];
+				ref_counts[color2] = 0;
+				break;
+			}
+
+			for (i = 0; i < 4; i++) {
+				int y = n / w + yds[i], x = n % w + xds[i];
+
+				if (y < 0 || y >= c->height || x < 0 || x >= w) continue;
+				if (ref_prev[y * w + x] >= 0) continue;
+				ref_queue[tail++] = y * w + x;
+				ref_prev[y * w + x] = n;
+			}
+		}
+	}
+}
+
+/* Check a labelling against the old coloring, and its sizes and boxes */
+static int compare_labels(struct region_map *m, struct cave *c, bool diagonal) {
+	int num = ref_build_colors(c, diagonal);
+	int w = c->width, size = c->height * w;
+	int i, r;
+
+	if (region_label(m, c, diagonal) != num) return -1;
+	for (i = 0; i < size; i++)
+		if (m->label[i] != ref_colors[i]) return i + 1;
+
+	for (r = 1; r <= num; r++) {
+		struct region_box *b = &m->box[r];
+
+		if (m->size[r] != ref_counts[r]) return -2;
+		for (i = 0; i < size; i++) {
+			int y = i / w, x = i % w;
+
+			if (m->label[i] != r) continue;
+			if (y < b->y1 || y > b->y2 || x < b->x1 || x > b->x2) return -3;
+		}
+		if (m->label[b->y1 * w + b->x1] != r &&
+				m->label[b->y1 * w + b->x2] != r &&
+				m->label[b->y2 * w + b->x1] != r &&
+				m->label[b->y2 * w + b->x2] != r) {
+			/* Each edge of a tight box must touch the region */
+			bool top = FALSE, bottom = FALSE;
+			for (i = b->x1; i <= b->x2; i++) {
+				if (m->label[b->y1 * w + i] == r) top = TRUE;
+				if (m->label[b->y2 * w + i] == r) bottom = TRUE;
+			}
+			if (!top || !bottom) return -4;
+		}
+	}
+
+	return 0;
+}
+
+int test_labels(void *state) {
+	struct region_map *m = region_map_new();
+	int i;
+
+	for (i = 0; i < REGION_TEST_LEVELS; i++) {
+		reseed(i + 1);
+		random_level(cave, DUNGEON_HGT / 2 + randint0(DUNGEON_HGT / 2),
+			DUNGEON_WID / 2 + randint0(DUNGEON_WID / 2), 30 + i);
+		eq(compare_labels(m, cave, FALSE), 0);
+		eq(compare_labels(m, cave, TRUE), 0);
+	}
+
+	/* A map is reused for a larger level after a smaller one */
+	random_level(cave, 10, 20, 50);
+	eq(compare_labels(m, cave, TRUE), 0);
+	random_level(cave, DUNGEON_HGT, DUNGEON_WID, 50);
+	eq(compare_labels(m, cave, TRUE), 0);
+
+	region_map_free(m);
+	ok;
+}
+
+int test_join(void *state) {
+	int i, y, x;
+
+	for (i = 0; i < REGION_TEST_LEVELS; i++) {
+		reseed(i + 100);
+		random_level(cave, DUNGEON_HGT, DUNGEON_WID, 25 + i);
+		reseed(i + 100);
+		random_level(other, DUNGEON_HGT, DUNGEON_WID, 25 + i);
+
+		ensure_connectedness(cave);
+		ref_build_colors(other, TRUE);
+		ref_join_regions(other);
+
+		eq(cave_is_connected(cave), TRUE);
+		for (y = 0; y < DUNGEON_HGT; y++)
+			for (x = 0; x < DUNGEON_WID; x++)
+				eq(cave->feat[y][x], other->feat[y][x]);
+	}
+
+	ok;
+}
+
+const char *suite_name = "cave/region";
+struct test tests[] = {
+	{ "labels", test_labels },
+	{ "join", test_join },
+	{ NULL, NULL }
+};
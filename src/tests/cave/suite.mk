@@ -0,0 +1,8 @@
+TESTPROGS += cave/view
+TESTPROGS += cave/flow
+TESTPROGS += cave/region
+TESTPROGS += cave/generate
+TESTPROGS += cave/vault
+TESTPROGS += cave/empty
+TESTPROGS += cave/feature
+TESTPROGS += cave/proj
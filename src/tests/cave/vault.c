@@ -0,0 +1,221 @@
+/* cave/vault
+ *
+ * Tests for building vaults from their compiled plans
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-make.h"
+#include "trap.h"
+
+/* What a square ended up with, to compare two builds of a vault */
+struct square {
+	byte feat;
+	byte info;
+	s16b r_idx;
+	const object_kind *kind;
+};
+
+static struct square first[DUNGEON_HGT][DUNGEON_WID];
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_quick = FALSE;
+	p_ptr->depth = cave->depth = 50;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Restart the generator from a seed, so runs can be repeated */
+static void reseed(u32b seed) {
+	state_i = 0;
+	Rand_state_init(seed);
+}
+
+/* Empty the level, leaving solid granite */
+static void clear_level(void) {
+	int y, x;
+
+	wipe_o_list(cave);
+	wipe_mon_list(cave, p_ptr);
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++) {
+			cave->feat[y][x] = FEAT_WALL_EXTRA;
+			cave->info[y][x] = CAVE_WALL;
+		}
+	cave_reset_empty(cave);
+}
+
+/* The old builder, reading the text square by square */
+static void ref_build_vault(struct cave *c, int y0, int x0, int ymax,
+		int xmax, const char *data) {
+	int dx, dy, x, y;
+	const char *t;
+	bool icky;
+
+	for (t = data, dy = 0; dy < ymax && *t; dy++) {
+		for (dx = 0; dx < xmax && *t; dx++, t++) {
+			x = x0 - (xmax / 2) + dx;
+			y = y0 - (ymax / 2) + dy;
+			if (*t == ' ') continue;
+
+			cave_set_feat(c, y, x, FEAT_FLOOR);
+			icky = TRUE;
+
+			switch (*t) {
+				case '%': cave_set_feat(c, y, x, FEAT_WALL_OUTER);
+					icky = FALSE; break;
+				case '#': cave_set_feat(c, y, x, FEAT_WALL_INNER); break;
+				case 'X': cave_set_feat(c, y, x, FEAT_PERM_INNER); break;
+				case '+': place_secret_door(c, y, x); break;
+				case '^': place_trap(c, y, x); break;
+				case '*': {
+					if (randint0(100) < 75)
+						place_object(c, y, x, c->depth, FALSE, FALSE,
+							ORIGIN_VAULT);
+					else
+						place_trap(c, y, x);
+					break;
+				}
+			}
+
+			c->info[y][x] |= CAVE_ROOM;
+			if (icky) c->info[y][x] |= CAVE_ICKY;
+		}
+	}
+
+	for (t = data, dy = 0; dy < ymax && *t; dy++) {
+		for (dx = 0; dx < xmax && *t; dx++, t++) {
+			x = x0 - (xmax / 2) + dx;
+			y = y0 - (ymax / 2) + dy;
+			if (*t == ' ') continue;
+
+			switch (*t) {
+				case '&': pick_and_place_monster(c, y, x, c->depth + 5,
+					TRUE, TRUE, ORIGIN_DROP_VAULT); break;
+				case '@': pick_and_place_monster(c, y, x, c->depth + 11,
+					TRUE, TRUE, ORIGIN_DROP_VAULT); break;
+				case '9': {
+					pick_and_place_monster(c, y, x, c->depth + 9, TRUE, TRUE,
+						ORIGIN_DROP_VAULT);
+					place_object(c, y, x, c->depth + 7, TRUE, FALSE,
+						ORIGIN_VAULT);
+					break;
+				}
+				case '8': {
+					pick_and_place_monster(c, y, x, c->depth + 40, TRUE, TRUE,
+						ORIGIN_DROP_VAULT);
+					place_object(c, y, x, c->depth + 20, TRUE, TRUE,
+						ORIGIN_VAULT);
+					break;
+				}
+				case ',': {
+					if (randint0(100) < 50)
+						pick_and_place_monster(c, y, x, c->depth + 3, TRUE,
+							TRUE, ORIGIN_DROP_VAULT);
+					if (randint0(100) < 50)
+						place_object(c, y, x, c->depth + 7, FALSE, FALSE,
+							ORIGIN_VAULT);
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void read_square(struct square *s, int y, int x) {
+	s->feat = cave->feat[y][x];
+	s->info = cave->info[y][x];
+	s->r_idx = cave->m_idx[y][x] > 0 ?
+		cave_monster(cave, cave->m_idx[y][x])->r_idx : 0;
+	s->kind = cave->o_idx[y][x] ? object_byid(cave->o_idx[y][x])->kind : NULL;
+}
+
+/* Build a vault both ways from the same seed, and count the differences */
+static int compare_vault(struct vault *v, u32b seed) {
+	int y0 = DUNGEON_HGT / 2, x0 = DUNGEON_WID / 2;
+	int y, x, diffs = 0;
+
+	clear_level();
+	reseed(seed);
+	build_vault(cave, y0, x0, v);
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			read_square(&first[y][x], y, x);
+
+	clear_level();
+	reseed(seed);
+	ref_build_vault(cave, y0, x0, v->hgt, v->wid, v->text);
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++) {
+			struct square s;
+
+			read_square(&s, y, x);
+			if (s.feat != first[y][x].feat || s.info != first[y][x].info ||
+					s.r_idx != first[y][x].r_idx ||
+					s.kind != first[y][x].kind)
+				diffs++;
+		}
+
+	return diffs;
+}
+
+int test_same_vaults(void *state) {
+	struct vault *v;
+	int n = 0;
+
+	for (v = vaults; v; v = v->next) {
+		eq(compare_vault(v, v->vidx + 1), 0);
+		n++;
+	}
+
+	require(n > 0);
+	ok;
+}
+
+int test_random_vault(void *state) {
+	struct vault *picked[2000];
+	struct vault *v;
+	int typ, i;
+
+	eq(random_vault(0) == NULL, TRUE);
+	eq(random_vault(300) == NULL, TRUE);
+
+	/* Every vault of a type turns up, and nothing of another type */
+	for (typ = 6; typ <= 8; typ++) {
+		reseed(typ);
+		for (i = 0; i < 2000; i++) {
+			picked[i] = random_vault(typ);
+			require(picked[i] && picked[i]->typ == typ);
+		}
+
+		for (v = vaults; v; v = v->next) {
+			bool found = FALSE;
+
+			if (v->typ != typ) continue;
+			for (i = 0; i < 2000 && !found; i++)
+				found = (picked[i] == v);
+			eq(found, TRUE);
+		}
+	}
+
+	ok;
+}
+
+const char *suite_name = "cave/vault";
+struct test tests[] = {
+	{ "same-vaults", test_same_vaults },
+	{ "random-vault", test_random_vault },
+	{ NULL, NULL }
+};
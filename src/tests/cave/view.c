@@ -0,0 +1,205 @@
+/* cave/view
+ *
+ * Tests for the incremental field of view in cave.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "monster/monster.h"
+
+#define VIEW_TEST_STEPS 2000
+
+static byte old_flags[DUNGEON_HGT][256];
+
+int setup_tests(void **state) {
+	int y, x;
+
+	read_edit_files();
+	vinfo_init();
+	cave = cave_new();
+	Rand_state_init(42);
+	Rand_quick = FALSE;
+
+	/* A lit arena with scattered pillars and doors */
+	for (y = 0; y < DUNGEON_HGT; y++) {
+		for (x = 0; x < DUNGEON_WID; x++) {
+			int feat = FEAT_FLOOR;
+
+			if (!cave_in_bounds_fully(cave, y, x))
+				feat = FEAT_PERM_SOLID;
+			else if (one_in_(6))
+				feat = FEAT_WALL_EXTRA;
+			else if (one_in_(20))
+				feat = FEAT_DOOR_HEAD;
+
+			cave_set_feat(cave, y, x, feat);
+			if (x > DUNGEON_WID / 2) cave->info[y][x] |= CAVE_GLOW;
+		}
+	}
+
+	p_ptr->py = DUNGEON_HGT / 2;
+	p_ptr->px = DUNGEON_WID / 2;
+	cave_set_feat(cave, p_ptr->py, p_ptr->px, FEAT_FLOOR);
+	p_ptr->cur_light = 1;
+
+	character_dungeon = TRUE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	character_dungeon = FALSE;
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static void save_flags(void) {
+	int y, x;
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < 256; x++)
+			old_flags[y][x] = cave->info[y][x] & (CAVE_VIEW | CAVE_SEEN);
+}
+
+/* Count the grids whose flags changed, checking each is in the delta */
+static int changed_flags(const u16b *delta, int n) {
+	int y, x, i, changed = 0;
+
+	for (y = 0; y < DUNGEON_HGT; y++) {
+		for (x = 0; x < 256; x++) {
+			if ((cave->info[y][x] & (CAVE_VIEW | CAVE_SEEN)) == old_flags[y][x])
+				continue;
+
+			for (i = 0; i < n; i++)
+				if (delta[i] == GRID(y, x)) break;
+			if (i == n) return -1;
+
+			changed++;
+		}
+	}
+
+	return changed;
+}
+
+static void random_step(void) {
+	int d = randint0(8);
+	int y = p_ptr->py + ddy_ddd[d];
+	int x = p_ptr->px + ddx_ddd[d];
+
+	if (!cave_in_bounds_fully(cave, y, x)) return;
+	if (!cave_floor_bold(y, x)) return;
+
+	p_ptr->py = y;
+	p_ptr->px = x;
+}
+
+static void random_change(void) {
+	int y = rand_spread(p_ptr->py, 8);
+	int x = rand_spread(p_ptr->px, 8);
+
+	if (!cave_in_bounds_fully(cave, y, x)) return;
+	if (y == p_ptr->py && x == p_ptr->px) return;
+
+	switch (randint0(4)) {
+		case 0:
+			cave_set_feat(cave, y, x, FEAT_FLOOR);
+			break;
+		case 1:
+			cave_set_feat(cave, y, x, FEAT_DOOR_HEAD);
+			break;
+		case 2:
+			cave->info[y][x] ^= CAVE_GLOW;
+			cave_note_view_change(cave, y, x);
+			break;
+		case 3:
+			p_ptr->cur_light = randint0(4);
+			break;
+	}
+}
+
+int test_incremental(void *state) {
+	const u16b *delta;
+	int i, n;
+
+	view_mode = VIEW_INCREMENTAL;
+	update_view();
+	eq(view_verify(), 0);
+
+	for (i = 0; i < VIEW_TEST_STEPS; i++) {
+		if (one_in_(3))
+			random_step();
+		else
+			random_change();
+
+		save_flags();
+		update_view();
+		eq(view_verify(), 0);
+
+		n = view_delta(&delta);
+		eq(changed_flags(delta, n), n);
+	}
+
+	ok;
+}
+
+int test_monster_light(void *state) {
+	struct monster *m_ptr = cave_monster(cave, 1);
+	int i, r_idx;
+
+	for (r_idx = 1; r_idx < z_info->r_max; r_idx++)
+		if (rf_has(r_info[r_idx].flags, RF_HAS_LIGHT)) break;
+	require(r_idx < z_info->r_max);
+
+	m_ptr->r_idx = r_idx;
+	cave->mon_max = 2;
+
+	for (i = 0; i < VIEW_TEST_STEPS; i++) {
+		int y = rand_spread(p_ptr->py, 6);
+		int x = rand_spread(p_ptr->px, 6);
+
+		if (cave_in_bounds_fully(cave, y, x)) {
+			m_ptr->fy = y;
+			m_ptr->fx = x;
+		}
+
+		if (one_in_(2))
+			random_step();
+		else
+			random_change();
+
+		update_view();
+		eq(view_verify(), 0);
+	}
+
+	m_ptr->r_idx = 0;
+	cave->mon_max = 1;
+	ok;
+}
+
+int test_forget(void *state) {
+	const u16b *delta;
+	int y, x;
+
+	update_view();
+	forget_view();
+	eq(view_delta(&delta) > 0, 1);
+
+	for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 0; x < DUNGEON_WID; x++)
+			eq(cave->info[y][x] & (CAVE_VIEW | CAVE_SEEN), 0);
+
+	update_view();
+	eq(view_verify(), 0);
+	ok;
+}
+
+const char *suite_name = "cave/view";
+struct test tests[] = {
+	{ "incremental", test_incremental },
+	{ "monster-light", test_monster_light },
+	{ "forget", test_forget },
+	{ NULL, NULL }
+};
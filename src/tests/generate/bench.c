@@ -0,0 +1,82 @@
+/* generate/bench
+ *
+ * Throughput of cave_generate() over a spread of depths, by the profile
+ * which built each level, timed when running verbosely.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include <time.h>
+
+#define BENCH_LEVELS 300
+
+/* Levels built by each profile, and the time taken over them */
+struct bench_profile {
+	const char *name;
+	int levels;
+	clock_t time;
+};
+
+static struct gen_stats stats;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_quick = FALSE;
+	gen_stats = &stats;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	gen_stats = NULL;
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+int test_throughput(void *state) {
+	struct bench_profile profiles[GEN_STATS_BUILDERS];
+	int i, j, levels = 0;
+
+	memset(profiles, 0, sizeof(profiles));
+
+	for (i = 0; i < BENCH_LEVELS; i++) {
+		clock_t start = clock();
+
+		p_ptr->depth = 1 + i % 99;
+		cave_generate_seed(cave, p_ptr, i + 1);
+		character_dungeon = FALSE;
+
+		/* Find the profile's entry, or the first free one */
+		for (j = 0; j < GEN_STATS_BUILDERS - 1; j++)
+			if (!profiles[j].name || streq(profiles[j].name, stats.profile))
+				break;
+
+		profiles[j].name = stats.profile;
+		profiles[j].levels++;
+		profiles[j].time += clock() - start;
+	}
+
+	for (j = 0; j < GEN_STATS_BUILDERS && profiles[j].name; j++) {
+		double secs = (double)profiles[j].time / CLOCKS_PER_SEC;
+
+		levels += profiles[j].levels;
+		if (verbose)
+			printf("(%s: %d levels, %.0f/s) ", profiles[j].name,
+				profiles[j].levels, secs > 0 ? profiles[j].levels / secs : 0.0);
+	}
+
+	eq(levels, BENCH_LEVELS);
+	eq((int)stats.levels, BENCH_LEVELS);
+	ok;
+}
+
+const char *suite_name = "generate/bench";
+struct test tests[] = {
+	{ "throughput", test_throughput },
+	{ NULL, NULL }
+};
@@ -0,0 +1,143 @@
+/* generate/golden
+ *
+ * Generates levels from fixed seeds and checks them against hashes taken
+ * when the generator was known to be right.  Any change to the levels made,
+ * however small, shows up here; if it was meant, run this verbosely and
+ * paste in the new table it prints.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "object/object.h"
+
+struct golden {
+	u32b seed;
+	int depth;
+	const char *profile;
+	u32b hash;
+};
+
+static const struct golden golden[] = {
+	{ 1, 0, "town-default", 0xf25bfc23 },
+	{ 2, 2, "default", 0xebae60f0 },
+	{ 10, 10, "default", 0xecf21661 },
+	{ 20, 20, "default", 0x3cad6948 },
+	{ 30, 30, "default", 0x418e8fd0 },
+	{ 40, 40, "default", 0x5fba3533 },
+	{ 50, 50, "default", 0x172372f8 },
+	{ 64, 64, "default", 0x793ef77f },
+	{ 80, 80, "default", 0xc6ad1080 },
+	{ 97, 97, "default", 0xb6362c2a },
+	{ 99, 99, "default", 0x97ba1e85 },
+	{ 16, 16, "cavern", 0x84b3e38a },
+	{ 61, 61, "cavern", 0xfd9e8a0a },
+	{ 150, 51, "cavern", 0xb03139ab },
+	{ 113, 14, "labyrinth", 0x5303ccde },
+	{ 185, 86, "labyrinth", 0xecaa20c0 },
+	{ 247, 49, "labyrinth", 0x1b8a2197 }
+};
+
+static struct gen_stats stats;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_quick = FALSE;
+	gen_stats = &stats;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	gen_stats = NULL;
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static u32b hash_add(u32b h, u32b value) {
+	int i;
+
+	/* FNV-1a, a byte at a time */
+	for (i = 0; i < 4; i++) {
+		h ^= (value >> (8 * i)) & 0xFF;
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+/*
+ * Hash the terrain and flags of every square, the race of every monster,
+ * the kind and number of every object on the floor, and the player.
+ */
+static u32b level_hash(void) {
+	u32b h = 2166136261UL;
+	int y, x;
+
+	h = hash_add(h, cave->height);
+	h = hash_add(h, cave->width);
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			s16b o_idx;
+
+			h = hash_add(h, cave->feat[y][x]);
+			h = hash_add(h, cave->info[y][x]);
+
+			if (cave->m_idx[y][x] > 0)
+				h = hash_add(h, cave_monster_at(cave, y, x)->r_idx);
+
+			for (o_idx = cave->o_idx[y][x]; o_idx;
+					o_idx = object_byid(o_idx)->next_o_idx) {
+				object_type *o_ptr = object_byid(o_idx);
+
+				h = hash_add(h, o_ptr->kind->kidx);
+				h = hash_add(h, o_ptr->number);
+			}
+		}
+	}
+
+	h = hash_add(h, p_ptr->py);
+	h = hash_add(h, p_ptr->px);
+
+	return h;
+}
+
+int test_golden(void *state) {
+	size_t i;
+	int wrong = 0;
+
+	for (i = 0; i < N_ELEMENTS(golden); i++) {
+		const struct golden *g = &golden[i];
+		u32b hash;
+
+		p_ptr->depth = g->depth;
+		cave_generate_seed(cave, p_ptr, g->seed);
+		character_dungeon = FALSE;
+		hash = level_hash();
+
+		if (hash == g->hash && g->profile &&
+				streq(stats.profile, g->profile))
+			continue;
+
+		/* Print the line as it should be now */
+		if (verbose)
+			printf("\n\t{ %lu, %d, \"%s\", 0x%08lx },", (unsigned long)g->seed,
+				g->depth, stats.profile, (unsigned long)hash);
+		wrong++;
+	}
+
+	if (wrong && verbose) printf("\n");
+	eq(wrong, 0);
+	ok;
+}
+
+const char *suite_name = "generate/golden";
+struct test tests[] = {
+	{ "golden", test_golden },
+	{ NULL, NULL }
+};
@@ -0,0 +1,177 @@
+/* generate/pregen
+ *
+ * Tests that a level made ahead of time by cave_pregen() is just the level
+ * which would have been made when the player got there, and that making it
+ * leaves the level the player is on alone.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-sched.h"
+#include "object/object.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_quick = FALSE;
+	turn = 1000;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_pregen_forget();
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static u32b hash_add(u32b h, u32b value) {
+	int i;
+
+	/* FNV-1a, a byte at a time */
+	for (i = 0; i < 4; i++) {
+		h ^= (value >> (8 * i)) & 0xFF;
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+/*
+ * Hash the level, its monsters and objects, the player, and the parts of
+ * the rest of the game which making a level changes.
+ */
+static u32b game_hash(void) {
+	u32b h = 2166136261UL;
+	int y, x, i;
+
+	h = hash_add(h, cave->height);
+	h = hash_add(h, cave->width);
+	h = hash_add(h, cave->created_at);
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			h = hash_add(h, cave->feat[y][x]);
+			h = hash_add(h, cave->info[y][x]);
+			h = hash_add(h, cave->m_idx[y][x]);
+			h = hash_add(h, cave->o_idx[y][x]);
+		}
+	}
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *m_ptr = cave_monster(cave, i);
+
+		h = hash_add(h, m_ptr->r_idx);
+		h = hash_add(h, m_ptr->hp);
+		h = hash_add(h, m_ptr->hold_o_idx);
+		if (m_ptr->r_idx) h = hash_add(h, mon_energy(m_ptr));
+	}
+
+	for (i = 1; i < o_max; i++) {
+		struct object *o_ptr = object_byid(i);
+
+		h = hash_add(h, o_ptr->kind ? o_ptr->kind->kidx : 0);
+		h = hash_add(h, o_ptr->number);
+		h = hash_add(h, o_ptr->next_o_idx);
+		h = hash_add(h, o_ptr->artifact ? o_ptr->artifact->aidx : 0);
+	}
+
+	for (i = 0; i < z_info->r_max; i++)
+		h = hash_add(h, r_info[i].cur_num);
+	for (i = 0; i < z_info->a_max; i++)
+		h = hash_add(h, a_info[i].created);
+
+	h = hash_add(h, o_max);
+	h = hash_add(h, o_cnt);
+	h = hash_add(h, num_repro);
+	h = hash_add(h, p_ptr->depth);
+	h = hash_add(h, p_ptr->py);
+	h = hash_add(h, p_ptr->px);
+	h = hash_add(h, p_ptr->create_up_stair);
+	h = hash_add(h, p_ptr->create_down_stair);
+
+	return h;
+}
+
+/* Make the level the player starts on, the same every time */
+static void start(int depth) {
+	p_ptr->depth = depth;
+	cave_generate_seed(cave, p_ptr, depth * 100 + 7);
+}
+
+/* Take the stairs, some turns later, as do_cmd_go_down() and up would */
+static bool take_stairs(bool down) {
+	turn += 50;
+	p_ptr->depth += down ? 1 : -1;
+	p_ptr->create_up_stair = down;
+	p_ptr->create_down_stair = !down;
+	return cave_generate_next(cave, p_ptr);
+}
+
+int test_same(void *state) {
+	int depth, made;
+
+	for (depth = 2; depth < 100; depth += 11) {
+		int down;
+
+		for (down = 0; down < 2; down++) {
+			s32b then = turn;
+			u32b direct, ahead, here;
+
+			/* Without levels made ahead of time */
+			start(depth);
+			eq(take_stairs(down), FALSE);
+			direct = game_hash();
+
+			/* Making them must leave this level as it is */
+			turn = then;
+			start(depth);
+			here = game_hash();
+			made = 0;
+			while (cave_pregen(p_ptr)) made++;
+			eq(made, 2);
+			eq(game_hash(), here);
+
+			/* And the one taken must be the one made before */
+			eq(take_stairs(down), TRUE);
+			ahead = game_hash();
+			eq(ahead, direct);
+		}
+	}
+
+	ok;
+}
+
+int test_stale(void *state) {
+	s32b then = turn;
+	u32b direct;
+
+	/* Falling through a trapdoor leaves no stairs back */
+	start(30);
+	p_ptr->depth++;
+	p_ptr->create_up_stair = FALSE;
+	eq(cave_generate_next(cave, p_ptr), FALSE);
+	direct = game_hash();
+
+	/* So the level made for the stairs down is not used */
+	turn = then;
+	start(30);
+	while (cave_pregen(p_ptr)) ;
+	p_ptr->depth++;
+	p_ptr->create_up_stair = FALSE;
+	eq(cave_generate_next(cave, p_ptr), FALSE);
+	eq(game_hash(), direct);
+
+	ok;
+}
+
+const char *suite_name = "generate/pregen";
+struct test tests[] = {
+	{ "same", test_same },
+	{ "stale", test_stale },
+	{ NULL, NULL }
+};
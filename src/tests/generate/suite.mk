@@ -0,0 +1 @@
+TESTPROGS += generate/golden generate/bench generate/pregen
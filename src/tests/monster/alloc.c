@@ -0,0 +1,194 @@
+/* monster/alloc
+ *
+ * Tests for the cached monster allocation in get_mon_num()
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "monster/mon-make.h"
+#include "monster/monster.h"
+
+#define ALLOC_TEST_PICKS 2000
+#define ALLOC_TEST_SAMPLES 200000
+
+static long ref_prob[2048];
+
+int setup_tests(void **state) {
+	read_edit_files();
+	Rand_quick = FALSE;
+	p_ptr->depth = 30;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+/* Restart the generator from a seed, so runs can be repeated */
+static void reseed(u32b seed) {
+	state_i = 0;
+	Rand_state_init(seed);
+}
+
+/* The old linear-scan pick, recomputing every chance on every call */
+static int ref_pick(long total) {
+	long value = randint0(total);
+	int i;
+
+	for (i = 0; i < alloc_race_size; i++) {
+		if (value < ref_prob[i]) break;
+		value -= ref_prob[i];
+	}
+
+	return i;
+}
+
+static s16b ref_get_mon_num(int level) {
+	alloc_entry *table = alloc_race_table;
+	long total = 0L;
+	int i, j, p;
+
+	if (level > 0 && one_in_(NASTY_MON))
+		level += MIN(level / 4 + 2, MON_OOD_MAX);
+
+	for (i = 0; i < alloc_race_size; i++) {
+		monster_race *r_ptr = &r_info[table[i].index];
+
+		if (table[i].level > level) break;
+
+		ref_prob[i] = 0;
+
+		if ((level > 0) && (table[i].level <= 0)) continue;
+		if (rf_has(r_ptr->flags, RF_UNIQUE) &&
+				r_ptr->cur_num >= r_ptr->max_num)
+			continue;
+		if (rf_has(r_ptr->flags, RF_FORCE_DEPTH) &&
+				r_ptr->level > p_ptr->depth)
+			continue;
+
+		ref_prob[i] = table[i].prob2;
+		total += ref_prob[i];
+	}
+
+	if (total <= 0) return (0);
+
+	i = ref_pick(total);
+	p = randint0(100);
+	if (p < 60) {
+		j = i;
+		i = ref_pick(total);
+		if (table[i].level < table[j].level) i = j;
+	}
+	if (p < 10) {
+		j = i;
+		i = ref_pick(total);
+		if (table[i].level < table[j].level) i = j;
+	}
+
+	return table[i].index;
+}
+
+/* Check a run of picks against the old code, from the same seed */
+static int compare_picks(u32b seed, int level) {
+	s16b picks[ALLOC_TEST_PICKS];
+	int i;
+
+	reseed(seed);
+	for (i = 0; i < ALLOC_TEST_PICKS; i++)
+		picks[i] = get_mon_num(level);
+
+	reseed(seed);
+	for (i = 0; i < ALLOC_TEST_PICKS; i++)
+		if (ref_get_mon_num(level) != picks[i]) return i + 1;
+
+	return 0;
+}
+
+static bool no_uniques_hook(int r_idx) {
+	return !rf_has(r_info[r_idx].flags, RF_UNIQUE);
+}
+
+int test_same_picks(void *state) {
+	int level;
+
+	for (level = -1; level < 110; level += 3)
+		eq(compare_picks(level + 100, level), 0);
+
+	ok;
+}
+
+int test_unique_state(void *state) {
+	int i;
+
+	/* Kill off every other unique up to level 40 */
+	for (i = 1; i < z_info->r_max; i++) {
+		monster_race *r_ptr = &r_info[i];
+
+		if (!rf_has(r_ptr->flags, RF_UNIQUE) || r_ptr->level > 40) continue;
+		if (i % 2) r_ptr->max_num = 0;
+	}
+	get_mon_num_invalidate();
+	eq(compare_picks(7, 40), 0);
+
+	/* Change of depth changes which FORCE_DEPTH monsters may appear */
+	p_ptr->depth = 5;
+	eq(compare_picks(8, 40), 0);
+	p_ptr->depth = 30;
+	eq(compare_picks(9, 40), 0);
+
+	/* A restriction, and lifting it again */
+	get_mon_num_hook = no_uniques_hook;
+	get_mon_num_prep();
+	eq(compare_picks(10, 40), 0);
+	get_mon_num_hook = NULL;
+	get_mon_num_prep();
+	eq(compare_picks(11, 40), 0);
+
+	for (i = 1; i < z_info->r_max; i++)
+		if (rf_has(r_info[i].flags, RF_UNIQUE)) r_info[i].max_num = 1;
+	get_mon_num_invalidate();
+	eq(compare_picks(12, 40), 0);
+	ok;
+}
+
+/*
+ * Sample both implementations from different seeds, and check the two
+ * histograms could have come from the same distribution.
+ */
+int test_distribution(void *state) {
+	static long count[2][1024];
+	double chi2 = 0.0;
+	int i, bins = 0;
+
+	require(z_info->r_max <= 1024);
+
+	reseed(1);
+	for (i = 0; i < ALLOC_TEST_SAMPLES; i++)
+		count[0][get_mon_num(25)]++;
+
+	reseed(2);
+	for (i = 0; i < ALLOC_TEST_SAMPLES; i++)
+		count[1][ref_get_mon_num(25)]++;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		long a = count[0][i], b = count[1][i];
+
+		if (a + b < 10) continue;
+		chi2 += (double)(a - b) * (a - b) / (a + b);
+		bins++;
+	}
+
+	/* Far beyond any plausible chi-squared value for these many bins */
+	require(bins > 10);
+	require(chi2 < 2.0 * bins);
+	ok;
+}
+
+const char *suite_name = "monster/alloc";
+struct test tests[] = {
+	{ "same-picks", test_same_picks },
+	{ "unique-state", test_unique_state },
+	{ "distribution", test_distribution },
+	{ NULL, NULL }
+};
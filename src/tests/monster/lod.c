@@ -0,0 +1,123 @@
+/* monster/lod
+ *
+ * Tests for the distant updates of far away monsters in process_monsters()
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-make.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-timed.h"
+#include "monster/monster.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(17);
+	Rand_quick = FALSE;
+	p_ptr->depth = 10;
+	cave_generate_seed(cave, p_ptr, 17);
+	wipe_mon_list(cave, p_ptr);
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	op_ptr->distant_range = 0;
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Some ordinary race which moves, and only senses the player close by */
+static int any_race(void) {
+	int r_idx;
+	monster_race *r_ptr;
+
+	do {
+		r_idx = randint1(z_info->r_max - 1);
+		r_ptr = &r_info[r_idx];
+	} while (!r_ptr->name || rf_has(r_ptr->flags, RF_UNIQUE) ||
+		rf_has(r_ptr->flags, RF_NEVER_MOVE) ||
+		rf_has(r_ptr->flags, RF_MULTIPLY) || r_ptr->aaf > 30);
+
+	return r_idx;
+}
+
+/* Put a hurt, hasted monster somewhere far from the player */
+static struct monster *place_far_monster(void) {
+	struct monster *m_ptr;
+	int y, x;
+
+	do cave_pick_empty(cave, &y, &x);
+	while (distance(p_ptr->py, p_ptr->px, y, x) <= 40);
+
+	place_new_monster(cave, y, x, any_race(), FALSE, FALSE, ORIGIN_DROP);
+	m_ptr = cave_monster(cave, cave->m_idx[y][x]);
+	m_ptr->hp = m_ptr->maxhp - 1;
+	mon_clear_timed(m_ptr, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, FALSE);
+	mon_inc_timed(m_ptr, MON_TMD_FAST, 40, MON_TMD_FLG_NOMESSAGE, FALSE);
+
+	return m_ptr;
+}
+
+/* Give one monster a turn */
+static void take_turn(struct monster *m_ptr) {
+	mon_set_energy(cave, m_ptr, 100);
+	process_monsters(cave, 100);
+}
+
+int test_distant(void *state) {
+	struct monster *m_ptr = place_far_monster();
+	int fast = m_ptr->m_timed[MON_TMD_FAST];
+	int i, y = m_ptr->fy, x = m_ptr->fx;
+
+	op_ptr->distant_range = 40;
+
+	/* Turns are saved up, then taken together */
+	for (i = 1; i < 4; i++) {
+		take_turn(m_ptr);
+		eq(m_ptr->m_timed[MON_TMD_FAST], fast);
+		eq(m_ptr->lod_turns, i);
+	}
+
+	take_turn(m_ptr);
+	eq(m_ptr->m_timed[MON_TMD_FAST], fast - 4);
+	eq(m_ptr->lod_turns, 0);
+	require(distance(y, x, m_ptr->fy, m_ptr->fx) <= 1);
+
+	/* Turning distant updates off catches up on the saved turns */
+	take_turn(m_ptr);
+	take_turn(m_ptr);
+	op_ptr->distant_range = 0;
+	take_turn(m_ptr);
+	eq(m_ptr->m_timed[MON_TMD_FAST], fast - 7);
+	eq(m_ptr->lod_turns, 0);
+	ok;
+}
+
+int test_unhurt(void *state) {
+	struct monster *m_ptr = place_far_monster();
+	int fast = m_ptr->m_timed[MON_TMD_FAST];
+
+	/* Unhurt monsters far away do nothing, as before */
+	op_ptr->distant_range = 40;
+	m_ptr->hp = m_ptr->maxhp;
+	take_turn(m_ptr);
+	take_turn(m_ptr);
+	take_turn(m_ptr);
+	take_turn(m_ptr);
+	eq(m_ptr->m_timed[MON_TMD_FAST], fast);
+	eq(m_ptr->lod_turns, 0);
+	ok;
+}
+
+const char *suite_name = "monster/lod";
+struct test tests[] = {
+	{ "distant", test_distant },
+	{ "unhurt", test_unhurt },
+	{ NULL, NULL }
+};
@@ -0,0 +1,160 @@
+/* monster/sched
+ *
+ * Tests for the monster energy scheduler in monster/mon-sched.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "monster/mon-sched.h"
+#include "monster/mon-timed.h"
+
+#define SCHED_TEST_MONSTERS 200
+#define SCHED_TEST_TURNS 5000
+
+/* Energy each monster would have under the old turn-by-turn scheme */
+static int ref_energy[SCHED_TEST_MONSTERS + 1];
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(42);
+	Rand_quick = FALSE;
+	turn = 1;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static void add_monster(int m_idx) {
+	struct monster *m_ptr = cave_monster(cave, m_idx);
+
+	WIPE(m_ptr, struct monster);
+	m_ptr->r_idx = 1;
+	m_ptr->midx = m_idx;
+	m_ptr->mspeed = 100 + randint0(31);
+	m_ptr->energy = randint0(50);
+	mon_sched_add(cave, m_idx);
+
+	ref_energy[m_idx] = m_ptr->energy;
+}
+
+static void remove_monster(int m_idx) {
+	mon_sched_remove(cave, m_idx);
+	WIPE(cave_monster(cave, m_idx), struct monster);
+}
+
+static void move_monster(int i1, int i2) {
+	COPY(cave_monster(cave, i2), cave_monster(cave, i1), struct monster);
+	cave_monster(cave, i2)->midx = i2;
+	mon_sched_move(cave, i1, i2);
+	WIPE(cave_monster(cave, i1), struct monster);
+
+	ref_energy[i2] = ref_energy[i1];
+}
+
+/* One game turn of the old scheme, checked against the scheduler */
+static int run_turn(void) {
+	int i, next;
+
+	mon_sched_update(cave);
+	next = mon_sched_next(cave, cave_monster_max(cave));
+
+	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
+		struct monster *m_ptr = cave_monster(cave, i);
+
+		if (!m_ptr->r_idx) continue;
+		if (mon_energy(m_ptr) != ref_energy[i]) return -i;
+		if (ref_energy[i] < 100) continue;
+
+		/* The scheduler must offer the same monster next */
+		if (next != i) return i;
+		next = mon_sched_next(cave, i);
+
+		ref_energy[i] -= 100;
+		mon_set_energy(cave, m_ptr, ref_energy[i]);
+
+		/* Acting monsters sometimes change speed */
+		if (one_in_(10))
+			mon_inc_timed(m_ptr, one_in_(2) ? MON_TMD_FAST : MON_TMD_SLOW,
+				10, MON_TMD_FLG_NOMESSAGE | MON_TMD_FLG_NOFAIL, FALSE);
+		else if (one_in_(10))
+			mon_clear_timed(m_ptr, one_in_(2) ? MON_TMD_FAST : MON_TMD_SLOW,
+				MON_TMD_FLG_NOMESSAGE, FALSE);
+	}
+
+	/* Nobody else may be ready */
+	if (next) return next;
+
+	/* Give energy to all monsters */
+	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
+		struct monster *m_ptr = cave_monster(cave, i);
+		int mspeed = m_ptr->mspeed;
+
+		if (!m_ptr->r_idx) continue;
+
+		if (m_ptr->m_timed[MON_TMD_FAST]) mspeed += 10;
+		if (m_ptr->m_timed[MON_TMD_SLOW]) mspeed -= 10;
+		ref_energy[i] += extract_energy[mspeed];
+	}
+
+	turn++;
+	return 0;
+}
+
+int test_order(void *state) {
+	int i, t;
+
+	for (i = 1; i <= SCHED_TEST_MONSTERS; i++)
+		add_monster(i);
+	cave->mon_max = SCHED_TEST_MONSTERS + 1;
+
+	for (t = 0; t < SCHED_TEST_TURNS; t++) {
+		int m_idx = randint1(SCHED_TEST_MONSTERS);
+
+		eq(run_turn(), 0);
+
+		/* Deaths, births and compaction */
+		if (one_in_(5)) {
+			if (cave_monster(cave, m_idx)->r_idx)
+				remove_monster(m_idx);
+			else
+				add_monster(m_idx);
+		}
+
+		if (one_in_(50)) {
+			int last = cave_monster_max(cave) - 1;
+
+			if (!cave_monster(cave, m_idx)->r_idx &&
+					cave_monster(cave, last)->r_idx)
+				move_monster(last, m_idx);
+		}
+	}
+
+	ok;
+}
+
+int test_reset(void *state) {
+	int i;
+
+	mon_sched_reset(cave);
+	for (i = 1; i < cave_monster_max(cave); i++)
+		WIPE(cave_monster(cave, i), struct monster);
+
+	turn += 1000;
+	mon_sched_update(cave);
+	eq(mon_sched_next(cave, cave_monster_max(cave)), 0);
+	ok;
+}
+
+const char *suite_name = "monster/sched";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "reset", test_reset },
+	{ NULL, NULL }
+};
@@ -0,0 +1,173 @@
+/* monster/slots
+ *
+ * Tests for the reuse of monster and object slots, and their handles
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-make.h"
+#include "monster/monster.h"
+#include "object/tvalsval.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(29);
+	Rand_quick = FALSE;
+	p_ptr->depth = 10;
+	cave_generate_seed(cave, p_ptr, 29);
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+/* Some ordinary race */
+static int any_race(void) {
+	int r_idx;
+
+	do r_idx = randint1(z_info->r_max - 1);
+	while (!r_info[r_idx].name || rf_has(r_info[r_idx].flags, RF_UNIQUE));
+
+	return r_idx;
+}
+
+/* Place a single monster, and return its index */
+static int add_monster(void) {
+	int y, x;
+
+	cave_pick_empty(cave, &y, &x);
+	if (!place_new_monster(cave, y, x, any_race(), FALSE, FALSE, ORIGIN_DROP))
+		return 0;
+
+	return cave->m_idx[y][x];
+}
+
+/* Check every monster and the grid it stands on agree */
+static bool monsters_consistent(void) {
+	int i, live = 0;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *m_ptr = cave_monster(cave, i);
+
+		if (!m_ptr->r_idx) continue;
+		if (m_ptr->midx != i) return FALSE;
+		if (cave->m_idx[m_ptr->fy][m_ptr->fx] != i) return FALSE;
+		live++;
+	}
+
+	return live == cave_monster_count(cave);
+}
+
+int test_monsters(void *state) {
+	slot_handle h[3], keep;
+	int gone[3], i, max, m_idx;
+
+	require(cave_monster_count(cave) > 10);
+	require(monsters_consistent());
+
+	/* Kill some monsters */
+	for (i = 0; i < 3; i++) {
+		gone[i] = 3 + 2 * i;
+		require(cave_monster(cave, gone[i])->r_idx);
+		h[i] = cave_monster_handle(cave, gone[i]);
+		delete_monster_idx(gone[i]);
+		require(!cave_monster_byhandle(cave, h[i]));
+	}
+	keep = cave_monster_handle(cave, 1);
+	max = cave_monster_max(cave);
+
+	/* New monsters fill the holes, most recent first */
+	for (i = 2; i >= 0; i--) {
+		m_idx = add_monster();
+		eq(m_idx, gone[i]);
+		require(!cave_monster_byhandle(cave, h[i]));
+	}
+	eq(cave_monster_max(cave), max);
+	require(monsters_consistent());
+
+	/* Then the array grows again */
+	m_idx = add_monster();
+	eq(m_idx, max);
+	require(cave_monster_byhandle(cave, keep) == cave_monster(cave, 1));
+
+	/* Culling leaves holes, and reordering closes them */
+	require(cave_monster(cave, 2)->r_idx);
+	require(cave_monster(cave, max - 1)->r_idx);
+	delete_monster_idx(2);
+	delete_monster_idx(max - 1);
+	eq(cave_monster_max(cave), max + 1);
+	compact_monsters(0);
+	eq(cave_monster_count(cave) + 1, cave_monster_max(cave));
+	require(monsters_consistent());
+	require(cave_monster_byhandle(cave, keep) == cave_monster(cave, 1));
+	ok;
+}
+
+int test_tracking(void *state) {
+	struct monster *m_ptr;
+	int max = cave_monster_max(cave), m_idx, y, x;
+
+	/* Track the last monster, and make a hole for it to move into */
+	m_ptr = cave_monster(cave, max - 1);
+	require(m_ptr->r_idx);
+	y = m_ptr->fy;
+	x = m_ptr->fx;
+	health_track(p_ptr, m_ptr);
+	require(health_tracked(p_ptr) == m_ptr);
+	delete_monster_idx(2);
+
+	/* Reordering keeps the same monster tracked */
+	compact_monsters(0);
+	m_ptr = health_tracked(p_ptr);
+	require(m_ptr);
+	require(m_ptr->midx < max - 1);
+	eq(m_ptr->fy, y);
+	eq(m_ptr->fx, x);
+
+	/* Once it is gone, nothing is, even when its slot is reused */
+	m_idx = m_ptr->midx;
+	delete_monster_idx(m_idx);
+	require(!health_tracked(p_ptr));
+	eq(add_monster(), m_idx);
+	require(!health_tracked(p_ptr));
+	ok;
+}
+
+int test_objects(void *state) {
+	object_type *o_ptr;
+	slot_handle h;
+	int o_idx, max;
+
+	o_idx = o_pop();
+	require(o_idx);
+	o_ptr = object_byid(o_idx);
+	object_prep(o_ptr, objkind_get(TV_FOOD, SV_FOOD_RATION), 0, RANDOMISE);
+	h = object_handle(o_idx);
+	require(object_byhandle(h) == o_ptr);
+	max = o_max;
+
+	/* A deleted object's slot is the next one given out */
+	o_push(o_idx);
+	require(!object_byhandle(h));
+	eq(o_pop(), o_idx);
+	eq(o_max, max);
+	require(!object_byhandle(h));
+	o_push(o_idx);
+	ok;
+}
+
+const char *suite_name = "monster/slots";
+struct test tests[] = {
+	{ "monsters", test_monsters },
+	{ "tracking", test_tracking },
+	{ "objects", test_objects },
+	{ NULL, NULL }
+};
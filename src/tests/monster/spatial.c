@@ -0,0 +1,140 @@
+/* monster/spatial
+ *
+ * Tests for the monster spatial index in monster/mon-spatial.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "monster/mon-spatial.h"
+
+#define SPATIAL_TEST_MONSTERS 300
+#define SPATIAL_TEST_STEPS 5000
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(11);
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static void add_monster(int m_idx) {
+	struct monster *m_ptr = cave_monster(cave, m_idx);
+
+	WIPE(m_ptr, struct monster);
+	m_ptr->r_idx = 1;
+	m_ptr->midx = m_idx;
+	m_ptr->fy = randint0(DUNGEON_HGT);
+	m_ptr->fx = randint0(DUNGEON_WID);
+	mon_spatial_add(cave, m_idx);
+}
+
+static void remove_monster(int m_idx) {
+	mon_spatial_remove(cave, m_idx);
+	WIPE(cave_monster(cave, m_idx), struct monster);
+}
+
+static void move_monster(int i1, int i2) {
+	COPY(cave_monster(cave, i2), cave_monster(cave, i1), struct monster);
+	cave_monster(cave, i2)->midx = i2;
+	mon_spatial_move(cave, i1, i2);
+	WIPE(cave_monster(cave, i1), struct monster);
+}
+
+/* Step a monster to a nearby grid, or far away */
+static void walk_monster(int m_idx) {
+	struct monster *m_ptr = cave_monster(cave, m_idx);
+	int d = one_in_(10) ? 40 : 1;
+	int y = m_ptr->fy + rand_range(-d, d);
+	int x = m_ptr->fx + rand_range(-d, d);
+
+	m_ptr->fy = MAX(0, MIN(DUNGEON_HGT - 1, y));
+	m_ptr->fx = MAX(0, MIN(DUNGEON_WID - 1, x));
+	mon_spatial_relocate(cave, m_idx);
+}
+
+/* Compare a query against a scan of every monster */
+static int check_near(int y, int x, int r) {
+	s16b list[SPATIAL_TEST_MONSTERS + 1];
+	int n = mon_spatial_near(cave, y, x, r, list);
+	int i, k = 0;
+
+	for (i = 1; i <= SPATIAL_TEST_MONSTERS; i++) {
+		struct monster *m_ptr = cave_monster(cave, i);
+
+		if (!m_ptr->r_idx) continue;
+		if (distance(y, x, m_ptr->fy, m_ptr->fx) > r) continue;
+		if (k >= n || list[k] != i) return i;
+		k++;
+	}
+	if (k != n) return -1;
+
+	/* The count for sizing the list covers the square around the circle */
+	if (mon_spatial_count_near(cave, y, x, r) !=
+			mon_spatial_rect(cave, y - r, x - r, y + r, x + r, list))
+		return -2;
+
+	return 0;
+}
+
+int test_queries(void *state) {
+	int i, t;
+
+	for (i = 1; i <= SPATIAL_TEST_MONSTERS; i++)
+		add_monster(i);
+
+	for (t = 0; t < SPATIAL_TEST_STEPS; t++) {
+		int m_idx = randint1(SPATIAL_TEST_MONSTERS);
+
+		if (cave_monster(cave, m_idx)->r_idx)
+			walk_monster(m_idx);
+
+		/* Deaths, births and compaction */
+		if (one_in_(5)) {
+			if (cave_monster(cave, m_idx)->r_idx)
+				remove_monster(m_idx);
+			else
+				add_monster(m_idx);
+		}
+
+		if (one_in_(20)) {
+			int other = randint1(SPATIAL_TEST_MONSTERS);
+
+			if (!cave_monster(cave, m_idx)->r_idx &&
+					cave_monster(cave, other)->r_idx)
+				move_monster(other, m_idx);
+		}
+
+		if (one_in_(10))
+			eq(check_near(randint0(DUNGEON_HGT), randint0(DUNGEON_WID),
+				randint0(30)), 0);
+	}
+
+	/* The whole level, from a corner */
+	eq(check_near(0, 0, 2 * DUNGEON_WID), 0);
+	ok;
+}
+
+int test_reset(void *state) {
+	s16b list[SPATIAL_TEST_MONSTERS + 1];
+
+	mon_spatial_reset(cave);
+	eq(mon_spatial_rect(cave, 0, 0, DUNGEON_HGT - 1, DUNGEON_WID - 1, list),
+		0);
+	ok;
+}
+
+const char *suite_name = "monster/spatial";
+struct test tests[] = {
+	{ "queries", test_queries },
+	{ "reset", test_reset },
+	{ NULL, NULL }
+};
@@ -1 +1 @@
-TESTPROGS += monster/attack monster/monster
+TESTPROGS += monster/attack monster/monster monster/sched monster/alloc monster/spatial monster/lod monster/vis monster/slots
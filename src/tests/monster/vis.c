@@ -0,0 +1,172 @@
+/* monster/vis
+ *
+ * Tests that update_monsters() passes over only monsters which stay unseen
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "monster/mon-util.h"
+#include "monster/monster.h"
+
+#define VIS_TEST_MOVES 60
+#define VIS_TEST_MONSTERS 1024
+
+struct vis_state {
+	byte cdis[VIS_TEST_MONSTERS];
+	byte ml[VIS_TEST_MONSTERS];
+	byte mflag[VIS_TEST_MONSTERS];
+	u32b redraw;
+};
+
+static monster_lore *lore;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	cave = cave_new();
+	Rand_state_init(23);
+	Rand_quick = FALSE;
+	p_ptr->depth = 15;
+	cave_generate_seed(cave, p_ptr, 23);
+	lore = C_ZNEW(2 * z_info->r_max, monster_lore);
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	FREE(lore);
+	cave_free(cave);
+	cave = NULL;
+	return 0;
+}
+
+static void save_state(struct vis_state *s) {
+	int i;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		monster_type *m_ptr = cave_monster(cave, i);
+
+		s->cdis[i] = m_ptr->cdis;
+		s->ml[i] = m_ptr->ml;
+		s->mflag[i] = m_ptr->mflag;
+	}
+	s->redraw = p_ptr->redraw;
+}
+
+static void load_state(const struct vis_state *s) {
+	int i;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		monster_type *m_ptr = cave_monster(cave, i);
+
+		m_ptr->cdis = s->cdis[i];
+		m_ptr->ml = s->ml[i];
+		m_ptr->mflag = s->mflag[i];
+	}
+	p_ptr->redraw = s->redraw;
+}
+
+static bool same_state(const struct vis_state *a, const struct vis_state *b) {
+	int i;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		if (!cave_monster(cave, i)->r_idx) continue;
+		if (a->cdis[i] != b->cdis[i] || a->ml[i] != b->ml[i] ||
+				a->mflag[i] != b->mflag[i])
+			return FALSE;
+	}
+
+	return a->redraw == b->redraw;
+}
+
+/*
+ * Update every monster both ways from the same start, and check the
+ * monsters, redraw flags and lore all come out the same.
+ */
+static bool check_update(bool full) {
+	static struct vis_state before, fast, slow;
+	size_t size = z_info->r_max * sizeof(monster_lore);
+	int i;
+
+	save_state(&before);
+	memcpy(lore, l_list, size);
+
+	update_monsters(full);
+	save_state(&fast);
+	memcpy(&lore[z_info->r_max], l_list, size);
+
+	load_state(&before);
+	memcpy(l_list, lore, size);
+	for (i = 1; i < cave_monster_max(cave); i++)
+		if (cave_monster(cave, i)->r_idx) update_mon(i, full);
+	save_state(&slow);
+
+	return same_state(&fast, &slow) &&
+		!memcmp(&lore[z_info->r_max], l_list, size);
+}
+
+/* Move the player to some empty square, and look around */
+static void relocate_player(void) {
+	int y, x;
+
+	cave_pick_empty(cave, &y, &x);
+	monster_swap(p_ptr->py, p_ptr->px, y, x);
+	update_view();
+}
+
+int test_moves(void *state) {
+	int i, seen = 0;
+
+	require(cave_monster_count(cave) > 10);
+	require(cave_monster_max(cave) <= VIS_TEST_MONSTERS);
+
+	for (i = 0; i < VIS_TEST_MOVES; i++) {
+		relocate_player();
+		require(check_update(TRUE));
+		seen += p_ptr->redraw & PR_MONLIST ? 1 : 0;
+		p_ptr->redraw = 0;
+	}
+
+	/* Some monsters came into sight along the way */
+	require(seen > 0);
+	ok;
+}
+
+int test_state(void *state) {
+	int i;
+
+	/* Detect some monsters far away */
+	for (i = 1; i < cave_monster_max(cave); i += 3)
+		if (cave_monster(cave, i)->r_idx)
+			cave_monster(cave, i)->mflag |= MFLAG_MARK;
+	require(check_update(FALSE));
+
+	for (i = 1; i < cave_monster_max(cave); i++)
+		cave_monster(cave, i)->mflag &= ~(MFLAG_MARK);
+	require(check_update(FALSE));
+
+	/* Telepathy, and losing it again */
+	of_on(p_ptr->state.flags, OF_TELEPATHY);
+	for (i = 0; i < VIS_TEST_MOVES / 4; i++) {
+		relocate_player();
+		require(check_update(TRUE));
+	}
+	of_off(p_ptr->state.flags, OF_TELEPATHY);
+	require(check_update(FALSE));
+
+	/* Blindness */
+	p_ptr->timed[TMD_BLIND] = 10;
+	require(check_update(FALSE));
+	p_ptr->timed[TMD_BLIND] = 0;
+	require(check_update(FALSE));
+	ok;
+}
+
+const char *suite_name = "monster/vis";
+struct test tests[] = {
+	{ "moves", test_moves },
+	{ "state", test_state },
+	{ NULL, NULL }
+};
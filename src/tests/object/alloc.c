@@ -0,0 +1,95 @@
+/* object/alloc
+ *
+ * Tests for object kind selection in get_obj_num()
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "object/object.h"
+
+#define ALLOC_TEST_PICKS 2000
+
+int setup_tests(void **state) {
+	read_edit_files();
+	Rand_quick = FALSE;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+/* Restart the generator from a seed, so runs can be repeated */
+static void reseed(u32b seed) {
+	state_i = 0;
+	Rand_state_init(seed);
+}
+
+static int kind_chance(const object_kind *kind, int level) {
+	if (level < kind->alloc_min || level > kind->alloc_max) return 0;
+	return kind->alloc_prob;
+}
+
+/* The old pick, subtracting each chance in turn */
+static object_kind *ref_get_obj_num(int level) {
+	u32b total = 0, value;
+	int item;
+
+	/* The occasional level boost of obj-make.c, one in 20 */
+	if ((level > 0) && one_in_(20))
+		level = 1 + (level * 100 / randint1(100));
+
+	level = MIN(level, 100);
+	level = MAX(level, 0);
+
+	for (item = 1; item < z_info->k_max; item++)
+		total += kind_chance(&k_info[item], level);
+
+	value = randint0(total);
+	for (item = 1; item < z_info->k_max; item++) {
+		if (value < (u32b)kind_chance(&k_info[item], level)) break;
+		value -= kind_chance(&k_info[item], level);
+	}
+
+	return objkind_byid(item);
+}
+
+int test_same_picks(void *state) {
+	object_kind *picks[ALLOC_TEST_PICKS];
+	int level, i;
+
+	for (level = 0; level <= 110; level += 5) {
+		reseed(level + 1);
+		for (i = 0; i < ALLOC_TEST_PICKS; i++)
+			picks[i] = get_obj_num(level, FALSE);
+
+		reseed(level + 1);
+		for (i = 0; i < ALLOC_TEST_PICKS; i++)
+			eq(ref_get_obj_num(level) == picks[i], TRUE);
+	}
+
+	ok;
+}
+
+int test_good_picks(void *state) {
+	int i;
+
+	reseed(42);
+	for (i = 0; i < ALLOC_TEST_PICKS; i++) {
+		object_kind *kind = get_obj_num(30, TRUE);
+
+		require(kind);
+		require(kind->alloc_prob > 0);
+	}
+
+	ok;
+}
+
+const char *suite_name = "object/alloc";
+struct test tests[] = {
+	{ "same-picks", test_same_picks },
+	{ "good-picks", test_good_picks },
+	{ NULL, NULL }
+};
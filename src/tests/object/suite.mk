@@ -1 +1 @@
-TESTPROGS += object/attack
+TESTPROGS += object/attack object/alloc
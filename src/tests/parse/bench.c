@@ -0,0 +1,108 @@
+/* parse/bench
+ *
+ * Throughput of parser_parse() on lines like those of the pref files,
+ * timed when running verbosely.
+ */
+
+#include "unit-test.h"
+#include "parser.h"
+#include "z-form.h"
+#include <time.h>
+
+#define BENCH_LINES 200000
+
+struct bench_counts {
+	long values;
+	long sum;
+};
+
+int setup_tests(void **state) {
+	*state = mem_zalloc(sizeof(struct bench_counts));
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	mem_free(state);
+	return 0;
+}
+
+static enum parser_error bench_k(struct parser *p) {
+	struct bench_counts *c = parser_priv(p);
+	c->sum += parser_getint(p, "attr") + parser_getchar(p, "glyph");
+	c->sum += strlen(parser_getsym(p, "tval")) + strlen(parser_getsym(p, "sval"));
+	c->values += 4;
+	return PARSE_ERROR_NONE;
+}
+
+static enum parser_error bench_m(struct parser *p) {
+	struct bench_counts *c = parser_priv(p);
+	c->sum += parser_getuint(p, "index") + parser_getint(p, "attr");
+	c->values += 2;
+	if (parser_hasval(p, "glyph")) {
+		c->sum += parser_getchar(p, "glyph");
+		c->values++;
+	}
+	return PARSE_ERROR_NONE;
+}
+
+static enum parser_error bench_s(struct parser *p) {
+	struct bench_counts *c = parser_priv(p);
+	c->sum += strlen(parser_getstr(p, "text"));
+	c->values++;
+	return PARSE_ERROR_NONE;
+}
+
+/* Register a good number of directives, as the pref file parser does */
+static struct parser *bench_parser(struct bench_counts *c) {
+	struct parser *p = parser_new();
+	int i;
+
+	for (i = 0; i < 20; i++) {
+		char fmt[64];
+		strnfmt(fmt, sizeof(fmt), "unused%d sym a ?int b", i);
+		parser_reg(p, fmt, ignored);
+	}
+	parser_reg(p, "K sym tval sym sval int attr char glyph", bench_k);
+	parser_reg(p, "M uint index int attr ?char glyph", bench_m);
+	parser_reg(p, "S str text", bench_s);
+	parser_setpriv(p, c);
+	return p;
+}
+
+int test_throughput(void *state) {
+	static const char *lines[] = {
+		"K:light:Wooden Torch:14:~",
+		"M:123:11:r",
+		"M:456:3",
+		"S:A message of some length: with colons",
+		"# a comment",
+		"",
+	};
+	struct bench_counts *c = state;
+	struct parser *p = bench_parser(c);
+	clock_t start = clock();
+	long expected = 0;
+	int i;
+
+	for (i = 0; i < BENCH_LINES; i++) {
+		int n = i % N_ELEMENTS(lines);
+		eq(parser_parse(p, lines[n]), PARSE_ERROR_NONE);
+		expected += (n == 0) ? 4 : (n == 1) ? 3 : (n == 2) ? 2 : (n == 3) ? 1 : 0;
+	}
+
+	eq(c->values, expected);
+	require(c->sum > 0);
+
+	if (verbose)
+		printf("(%d lines in %ld ms) ", BENCH_LINES,
+		       (long)((clock() - start) * 1000 / CLOCKS_PER_SEC));
+
+	parser_destroy(p);
+	ok;
+}
+
+const char *suite_name = "parse/bench";
+struct test tests[] = {
+	{ "throughput", test_throughput },
+	{ NULL, NULL }
+};
@@ -0,0 +1,123 @@
+/* parse/cache
+ *
+ * Tests for the edit cache: arrays saved by run_parser() must load back
+ * exactly as they were parsed.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "monster/init.h"
+#include "monster/mon-power.h"
+#include "parser.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+static bool same_str(const char *a, const char *b) {
+	if (!a || !b) return a == b;
+	return streq(a, b);
+}
+
+/* Compare two races, pointers by what they point to and the rest bytewise */
+static bool same_race(const struct monster_race *r1, const struct monster_race *r2,
+		const struct monster_race *info1, const struct monster_race *info2) {
+	struct monster_race c1 = *r1, c2 = *r2;
+	struct monster_drop *d1, *d2;
+	struct monster_mimic *m1, *m2;
+
+	if (!same_str(r1->name, r2->name) || !same_str(r1->text, r2->text))
+		return FALSE;
+	if (r1->base != r2->base) return FALSE;
+	if ((r1->next ? r1->next - info1 : -1) != (r2->next ? r2->next - info2 : -1))
+		return FALSE;
+
+	for (d1 = r1->drops, d2 = r2->drops; d1 && d2; d1 = d1->next, d2 = d2->next)
+		if (d1->kind != d2->kind || d1->artifact != d2->artifact ||
+				d1->percent_chance != d2->percent_chance ||
+				d1->min != d2->min || d1->max != d2->max)
+			return FALSE;
+	if (d1 || d2) return FALSE;
+
+	for (m1 = r1->mimic_kinds, m2 = r2->mimic_kinds; m1 && m2;
+			m1 = m1->next, m2 = m2->next)
+		if (m1->kind != m2->kind) return FALSE;
+	if (m1 || m2) return FALSE;
+
+	c1.next = c2.next = NULL;
+	c1.name = c2.name = c1.text = c2.text = NULL;
+	c1.base = c2.base = NULL;
+	c1.drops = c2.drops = NULL;
+	c1.mimic_kinds = c2.mimic_kinds = NULL;
+	return !memcmp(&c1, &c2, sizeof(c1));
+}
+
+int test_round_trip(void *state) {
+	struct raw raw;
+	struct monster_race *parsed, *loaded;
+	s32b power;
+	int i;
+
+	/* Parse the monsters, saving them */
+	memset(&raw, 0, sizeof(raw));
+	parser_set_cache(NULL, &raw);
+	eq(run_parser(&r_parser), 0);
+	parsed = r_info;
+	power = tot_mon_power;
+	require(raw.len > 0);
+
+	/* Load them back */
+	parser_set_cache(&raw, NULL);
+	tot_mon_power = 0;
+	eq(run_parser(&r_parser), 0);
+	loaded = r_info;
+	require(!raw.bad);
+	eq(raw.pos, raw.len);
+	require(loaded != parsed);
+
+	eq(tot_mon_power, power);
+	for (i = 0; i < z_info->r_max; i++)
+		require(same_race(&parsed[i], &loaded[i], parsed, loaded));
+
+	parser_set_cache(NULL, NULL);
+	raw_free(&raw);
+	ok;
+}
+
+int test_fallback(void *state) {
+	struct raw raw;
+	struct monster_race *parsed;
+
+	memset(&raw, 0, sizeof(raw));
+	parser_set_cache(NULL, &raw);
+	eq(run_parser(&r_parser), 0);
+	parsed = r_info;
+
+	/* A cache cut short is noticed, and the text is parsed instead */
+	raw.len /= 2;
+	parser_set_cache(&raw, NULL);
+	eq(run_parser(&r_parser), 0);
+	require(raw.bad);
+	require(r_info != parsed);
+	require(same_race(&parsed[1], &r_info[1], parsed, r_info));
+	require(same_race(&parsed[z_info->r_max - 1], &r_info[z_info->r_max - 1],
+		parsed, r_info));
+
+	parser_set_cache(NULL, NULL);
+	raw_free(&raw);
+	ok;
+}
+
+const char *suite_name = "parse/cache";
+struct test tests[] = {
+	{ "round-trip", test_round_trip },
+	{ "fallback", test_fallback },
+	{ NULL, NULL }
+};
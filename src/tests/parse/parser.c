@@ -394,6 +394,73 @@ int test_char1(void *state) {
 	ok;
 }
 
+static enum parser_error helper_supersede(struct parser *p) {
+	int *wasok = parser_priv(p);
+	*wasok = parser_getint(p, "i0");
+	return PARSE_ERROR_NONE;
+}
+
+int test_supersede(void *state) {
+	int wasok = 0, i;
+	errr r = parser_reg(state, "test-supersede0 sym s0", ignored);
+	enum parser_error e;
+	eq(r, 0);
+
+	/* Enough hooks for the table to grow, then one replacing an old one */
+	for (i = 0; i < 40; i++) {
+		char fmt[64];
+		strnfmt(fmt, sizeof(fmt), "test-supersede%d int i0", i + 1);
+		eq(parser_reg(state, fmt, helper_supersede), 0);
+	}
+	r = parser_reg(state, "test-supersede0 int i0", helper_supersede);
+	eq(r, 0);
+
+	parser_setpriv(state, &wasok);
+	e = parser_parse(state, "test-supersede0:7");
+	eq(e, PARSE_ERROR_NONE);
+	eq(wasok, 7);
+	e = parser_parse(state, "test-supersede33:9");
+	eq(e, PARSE_ERROR_NONE);
+	eq(wasok, 9);
+	ok;
+}
+
+static enum parser_error helper_names(struct parser *p) {
+	char name[8];
+	int *wasok = parser_priv(p);
+
+	/* The same name from somewhere other than a literal */
+	my_strcpy(name, "s1", sizeof(name));
+	if (!streq(parser_getsym(p, "s0"), "a") || !streq(parser_getsym(p, name), "b"))
+		return PARSE_ERROR_GENERIC;
+
+	/* The same buffer, now holding another name */
+	my_strcpy(name, "s0", sizeof(name));
+	if (!streq(parser_getsym(p, name), "a"))
+		return PARSE_ERROR_GENERIC;
+
+	if (!streq(parser_getsym(p, "s1"), "b") || parser_hasval(p, "s2"))
+		return PARSE_ERROR_GENERIC;
+	*wasok = 1;
+	return PARSE_ERROR_NONE;
+}
+
+int test_names(void *state) {
+	int wasok = 0;
+	errr r = parser_reg(state, "test-names sym s0 sym s1 ?sym s2", helper_names);
+	enum parser_error e;
+	eq(r, 0);
+	parser_setpriv(state, &wasok);
+	e = parser_parse(state, "test-names:a:b");
+	eq(e, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	wasok = 0;
+	e = parser_parse(state, "test-names::a::b:");
+	eq(e, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	ok;
+}
+
 const char *suite_name = "parse/parser";
 struct test tests[] = {
 	{ "priv", test_priv },
@@ -437,5 +504,8 @@ struct test tests[] = {
 
 	{ "baddir", test_baddir },
 
+	{ "supersede", test_supersede },
+	{ "names", test_names },
+
 	{ NULL, NULL }
 };
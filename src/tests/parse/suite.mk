@@ -1,5 +1,7 @@
 TESTPROGS += parse/a-info \
+             parse/bench \
              parse/c-info \
+             parse/cache \
              parse/e-info \
 	     parse/f-info \
 	     parse/flavor \
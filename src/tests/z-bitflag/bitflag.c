@@ -0,0 +1,152 @@
+/* z-bitflag/bitflag.c */
+
+#include "unit-test.h"
+#include "z-bitflag.h"
+#include "z-rand.h"
+
+#define BITFLAG_TEST_SIZE 37
+#define BITFLAG_TEST_RUNS 2000
+
+int setup_tests(void **state) {
+	Rand_state_init(42);
+	Rand_quick = FALSE;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+/* Random bitfields, sparse ones often, so that the tests see empty words */
+static void random_flags(bitflag *flags, size_t size) {
+	int sparse = one_in_(2);
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		flags[i] = (sparse && !one_in_(8)) ? 0 : randint0(256);
+}
+
+static int ref_count(const bitflag *flags, size_t size) {
+	int f, count = 0;
+
+	for (f = FLAG_START; f < FLAG_MAX(size); f++)
+		if (flag_has(flags, size, f)) count++;
+
+	return count;
+}
+
+int test_next(void *state) {
+	bitflag flags[BITFLAG_TEST_SIZE];
+	int run;
+
+	for (run = 0; run < BITFLAG_TEST_RUNS; run++) {
+		size_t size = randint1(BITFLAG_TEST_SIZE);
+		int f, g, list[BITFLAG_TEST_SIZE * FLAG_WIDTH], n;
+
+		random_flags(flags, size);
+
+		/* Every flag from every starting point */
+		for (f = FLAG_START; f <= FLAG_MAX(size); f++) {
+			for (g = f; g < FLAG_MAX(size); g++)
+				if (flag_has(flags, size, g)) break;
+			if (g == FLAG_MAX(size)) g = FLAG_END;
+
+			eq(flag_next(flags, size, f), g);
+		}
+		eq(flag_next(flags, size, FLAG_END), flag_next(flags, size, FLAG_START));
+
+		eq(flag_count(flags, size), ref_count(flags, size));
+
+		n = flag_list(flags, size, list);
+		eq(n, flag_count(flags, size));
+		for (f = 0; f < n; f++) {
+			require(flag_has(flags, size, list[f]));
+			if (f) require(list[f] > list[f - 1]);
+		}
+	}
+
+	ok;
+}
+
+int test_tests(void *state) {
+	bitflag f1[BITFLAG_TEST_SIZE], f2[BITFLAG_TEST_SIZE];
+	int run;
+
+	for (run = 0; run < BITFLAG_TEST_RUNS; run++) {
+		size_t size = randint1(BITFLAG_TEST_SIZE), i;
+		bool empty = TRUE, full = TRUE, inter = FALSE, subset = TRUE;
+
+		random_flags(f1, size);
+		random_flags(f2, size);
+		if (one_in_(4)) flag_setall(f1, size);
+		if (one_in_(4)) flag_union(f1, f2, size);
+
+		for (i = 0; i < size; i++) {
+			if (f1[i]) empty = FALSE;
+			if (f1[i] != 255) full = FALSE;
+			if (f1[i] & f2[i]) inter = TRUE;
+			if (~f1[i] & f2[i]) subset = FALSE;
+		}
+
+		eq(flag_is_empty(f1, size), empty);
+		eq(flag_is_full(f1, size), full);
+		eq(flag_is_inter(f1, f2, size), inter);
+		eq(flag_is_subset(f1, f2, size), subset);
+	}
+
+	ok;
+}
+
+int test_ops(void *state) {
+	bitflag f1[BITFLAG_TEST_SIZE + 1], f2[BITFLAG_TEST_SIZE];
+	bitflag ref[BITFLAG_TEST_SIZE + 1];
+	int run;
+
+	for (run = 0; run < BITFLAG_TEST_RUNS; run++) {
+		size_t size = randint1(BITFLAG_TEST_SIZE), i;
+		int op = randint0(5);
+		bool delta = FALSE;
+
+		random_flags(f1, size);
+		random_flags(f2, size);
+		if (one_in_(4)) memcpy(f2, f1, size);
+		if (one_in_(4)) flag_negate(f2, size);
+
+		/* Guard byte, which must never be touched */
+		f1[size] = 0xA5;
+		memcpy(ref, f1, size + 1);
+
+		switch (op) {
+			case 0: delta = flag_union(f1, f2, size); break;
+			case 1: delta = flag_comp_union(f1, f2, size); break;
+			case 2: delta = flag_inter(f1, f2, size); break;
+			case 3: delta = flag_diff(f1, f2, size); break;
+			case 4: flag_negate(f1, size); break;
+		}
+
+		/* A change must be reported exactly when one is made */
+		if (op < 4) eq(delta, memcmp(f1, ref, size) != 0);
+
+		for (i = 0; i < size; i++) {
+			switch (op) {
+				case 0: ref[i] |= f2[i]; break;
+				case 1: ref[i] |= ~f2[i]; break;
+				case 2: ref[i] &= f2[i]; break;
+				case 3: ref[i] &= ~f2[i]; break;
+				case 4: ref[i] = ~ref[i]; break;
+			}
+		}
+
+		require(!memcmp(f1, ref, size + 1));
+	}
+
+	ok;
+}
+
+const char *suite_name = "z-bitflag/bitflag";
+struct test tests[] = {
+	{ "next", test_next },
+	{ "tests", test_tests },
+	{ "ops", test_ops },
+	{ NULL, NULL }
+};
@@ -0,0 +1,81 @@
+/* z-msg/msg.c */
+
+#include "unit-test.h"
+#include "z-msg.h"
+#include "z-form.h"
+#include "z-rand.h"
+
+#define MSG_TEST_MESSAGES 20000
+
+/* Every message added, newest last */
+static char sent[MSG_TEST_MESSAGES][200];
+
+int setup_tests(void **state) {
+	messages_init();
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	messages_free();
+	return 0;
+}
+
+int test_empty(void *state) {
+	eq(messages_num(), 0);
+	require(!strcmp(message_str(0), ""));
+	eq(message_count(0), 0);
+	ok;
+}
+
+int test_coalesce(void *state) {
+	message_add("You hit the kobold.", MSG_GENERIC);
+	message_add("You hit the kobold.", MSG_GENERIC);
+	message_add("You hit the kobold.", MSG_GENERIC);
+	eq(messages_num(), 1);
+	eq(message_count(0), 3);
+
+	/* A different type is a different message */
+	message_add("You hit the kobold.", MSG_HIT);
+	eq(messages_num(), 2);
+	eq(message_count(0), 1);
+	eq(message_type(0), MSG_HIT);
+	eq(message_type(1), MSG_GENERIC);
+	ok;
+}
+
+int test_history(void *state) {
+	int i, age;
+
+	Rand_value = 42;
+	Rand_quick = TRUE;
+
+	for (i = 0; i < MSG_TEST_MESSAGES; i++) {
+		int len = randint0(sizeof(sent[i]) - 20);
+
+		strnfmt(sent[i], sizeof(sent[i]), "%d:", i);
+		while ((int)strlen(sent[i]) < len)
+			my_strcat(sent[i], "x", sizeof(sent[i]));
+
+		message_add(sent[i], MSG_GENERIC);
+
+		/* Long messages can push out more than the count limit does */
+		require(messages_num() >= MIN(i + 1, 100));
+		require(messages_num() <= 2048);
+
+		/* Every message kept is the right one */
+		if (i % 1000 == 0 || i == MSG_TEST_MESSAGES - 1) {
+			for (age = 0; age < MIN(messages_num(), i + 1); age++)
+				require(!strcmp(message_str(age), sent[i - age]));
+		}
+	}
+
+	ok;
+}
+
+const char *suite_name = "z-msg/msg";
+struct test tests[] = {
+	{ "empty", test_empty },
+	{ "coalesce", test_coalesce },
+	{ "history", test_history },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+TESTPROGS += z-msg/msg
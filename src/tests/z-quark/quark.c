@@ -2,6 +2,10 @@
 
 #include "unit-test.h"
 #include "z-quark.h"
+#include "z-form.h"
+#include <time.h>
+
+#define QUARK_TEST_STRINGS 100000
 
 int setup_tests(void **state) {
 	quarks_init();
@@ -46,9 +50,44 @@ int test_dedup(void *state) {
 	ok;
 }
 
+/* Intern many strings twice, and time it when running verbosely */
+int test_many(void *state) {
+	static quark_t q[QUARK_TEST_STRINGS];
+	struct quark_stats stats;
+	char buf[32];
+	clock_t start = clock();
+	int i;
+
+	for (i = 0; i < QUARK_TEST_STRINGS; i++) {
+		strnfmt(buf, sizeof(buf), "2-inscription-%d", i);
+		q[i] = quark_add(buf);
+	}
+
+	for (i = 0; i < QUARK_TEST_STRINGS; i++) {
+		strnfmt(buf, sizeof(buf), "2-inscription-%d", i);
+		eq(quark_add(buf), q[i]);
+		require(!strcmp(quark_str(q[i]), buf));
+	}
+
+	quarks_stats(&stats);
+	require(stats.count >= QUARK_TEST_STRINGS);
+	require(stats.load > 0.0 && stats.load <= 0.5);
+	require(stats.block_bytes >= stats.string_bytes);
+
+	if (verbose)
+		printf("(%d strings in %ld ms, %lu bytes in %lu, load %.2f) ",
+		       QUARK_TEST_STRINGS,
+		       (long)((clock() - start) * 1000 / CLOCKS_PER_SEC),
+		       (unsigned long)stats.string_bytes,
+		       (unsigned long)stats.block_bytes, stats.load);
+
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "many", test_many },
 	{ NULL, NULL }
 };
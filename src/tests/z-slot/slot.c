@@ -0,0 +1,76 @@
+/* z-slot/slot.c */
+
+#include "unit-test.h"
+#include "z-slot.h"
+
+#define SLOT_TEST_SIZE 64
+
+int setup_tests(void **state) {
+	*state = slots_new(SLOT_TEST_SIZE);
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	slots_free(state);
+	return 0;
+}
+
+int test_take(void *state) {
+	struct slot_list *s = state;
+
+	/* Nothing has been given back yet */
+	eq(slots_take(s), 0);
+
+	/* Slots come back most recent first */
+	slots_give(s, 5);
+	slots_give(s, 9);
+	slots_give(s, 2);
+	eq(slots_count(s), 3);
+	eq(slots_take(s), 2);
+	eq(slots_take(s), 9);
+	eq(slots_take(s), 5);
+	eq(slots_take(s), 0);
+	eq(slots_count(s), 0);
+
+	/* Resetting forgets the free slots */
+	slots_give(s, 7);
+	slots_give(s, 8);
+	slots_reset(s);
+	eq(slots_count(s), 0);
+	eq(slots_take(s), 0);
+	ok;
+}
+
+int test_handles(void *state) {
+	struct slot_list *s = state;
+	slot_handle h1, h2;
+
+	h1 = slots_handle(s, 12);
+	require(h1 != 0);
+	eq(slots_lookup(s, h1), 12);
+
+	/* Giving the slot back makes its handle stale, even after reuse */
+	slots_give(s, 12);
+	eq(slots_lookup(s, h1), 0);
+	eq(slots_take(s), 12);
+	eq(slots_lookup(s, h1), 0);
+	h2 = slots_handle(s, 12);
+	require(h2 != h1);
+	eq(slots_lookup(s, h2), 12);
+
+	/* As does moving its entry elsewhere */
+	slots_retire(s, 12);
+	eq(slots_lookup(s, h2), 0);
+
+	/* Nonsense handles find nothing */
+	eq(slots_lookup(s, 0), 0);
+	eq(slots_lookup(s, SLOT_TEST_SIZE), 0);
+	ok;
+}
+
+const char *suite_name = "z-slot/slot";
+struct test tests[] = {
+	{ "take", test_take },
+	{ "handles", test_handles },
+	{ NULL, NULL }
+};
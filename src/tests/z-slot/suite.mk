@@ -0,0 +1 @@
+TESTPROGS += z-slot/slot
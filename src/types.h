@@ -116,6 +116,8 @@ typedef struct vault {
 
 	byte hgt;			/* Vault height */
 	byte wid;			/* Vault width */
+
+	struct vault_plan *plan;	/* Compiled text, see vault_plans_init() */
 } vault_type;
 
 
@@ -927,6 +927,46 @@ static void do_cmd_hp_warn(const char *name, int row)
 }
 
 
+/*
+ * Set the range beyond which hurt monsters only get distant updates
+ */
+static void do_cmd_distant_range(const char *name, int row)
+{
+	bool res;
+	char tmp[4] = "";
+	int range;
+
+	strnfmt(tmp, sizeof(tmp), "%i", op_ptr->distant_range);
+
+	screen_save();
+
+	/* Prompt */
+	prt("Command: Distant Monster Range", 20, 0);
+
+	prt(format("Current distant monster range: %d", op_ptr->distant_range),
+			22, 0);
+	prt(format("New distant monster range (0 for none, %d-255): ", MAX_SIGHT),
+			21, 0);
+
+	/* Ask the user for a string */
+	res = askfor_aux(tmp, sizeof(tmp), askfor_aux_numbers);
+
+	/* Process input */
+	if (res)
+	{
+		range = (int) strtoul(tmp, NULL, 0);
+
+		/* Never cut short monsters the player might see */
+		if (range > 0 && range < MAX_SIGHT)
+			range = MAX_SIGHT;
+
+		op_ptr->distant_range = MIN(range, 255);
+	}
+
+	screen_load();
+}
+
+
 /*
  * Set "lazy-movement" delay
  */
@@ -1519,6 +1559,7 @@ static menu_action option_actions[] =
 	{ 0, 'd', "Set base delay factor", do_cmd_delay },
 	{ 0, 'h', "Set hitpoint warning", do_cmd_hp_warn },
 	{ 0, 'i', "Set movement delay", do_cmd_lazymove_delay },
+	{ 0, 'r', "Set distant monster range", do_cmd_distant_range },
 	{ 0, 'l', "Load a user pref file", options_load_pref_file },
 	{ 0, 'o', "Save options", do_dump_options }, 
 	{0, 0, 0, 0}, /* Interact with */	
@@ -1462,7 +1462,10 @@ static bool stats_monster(monster_type *m_ptr, int i)
 		uniq_total[lvl] += addval;
 	
 		/* kill the unique if we're in clearing mode */
-		if (clearing) r_ptr->max_num = 0;
+		if (clearing) {
+			r_ptr->max_num = 0;
+			get_mon_num_invalidate();
+		}
 		
 		//debugging print that we killed it
 		//msg_format("Killed %s",r_ptr->name);
@@ -1510,20 +1513,11 @@ static bool stats_monster(monster_type *m_ptr, int i)
  */
 static void delete_object_stat(int o_idx)
 {
-	object_type *j_ptr;
-
 	/* Excise */
 	excise_object_idx(o_idx);
 
-	/* Object */
-	j_ptr = object_byid(o_idx);
-
-	
-	/* Wipe the object */
-	object_wipe(j_ptr);
-
-	/* Count objects */
-	o_cnt--;
+	/* Wipe the object, and free its slot */
+	o_push(o_idx);
 }
 
 
@@ -2028,8 +2022,8 @@ static void scan_for_objects(void)
 { 
 	int y, x;
 
-	for (y = 1; y < DUNGEON_HGT - 1; y++) {
-		for (x = 1; x < DUNGEON_WID - 1; x++) {
+	for (y = 1; y < cave->height - 1; y++) {
+		for (x = 1; x < cave->width - 1; x++) {
 			const object_type *o_ptr;
 
 			
@@ -2119,6 +2113,8 @@ static void revive_uniques(void)
 		if (rf_has(r_ptr->flags, RF_UNIQUE)) r_ptr->max_num = 1;
 
 	}
+
+	get_mon_num_invalidate();
 		
 }	
 /* 
@@ -2581,9 +2577,9 @@ void disconnect_stats(void)
 		calc_cave_distances();
 		
 		/*Cycle through the dungeon */
-		for (y = 1; y < DUNGEON_HGT - 1; y++){
+		for (y = 1; y < cave->height - 1; y++){
 		
-			for (x = 1; x < DUNGEON_WID - 1; x++){
+			for (x = 1; x < cave->width - 1; x++){
 			
 				/* don't care about walls */
 				if (cave->feat[y][x] > FEAT_RUBBLE) continue;
@@ -124,10 +124,11 @@ static void do_cmd_wiz_hack_ben(void)
 				if (!in_bounds_fully(y, x)) continue;
 
 				/* Display proper cost */
-				if (cave->cost[y][x] != i) continue;
+				if (!flow_when(cave, FLOW_NOISE, y, x)) continue;
+				if (flow_cost(cave, FLOW_NOISE, y, x) != i) continue;
 
 				/* Reliability in yellow */
-				if (cave->when[y][x] == cave->when[py][px])
+				if (flow_dist(cave, FLOW_NOISE, y, x) >= 0)
 					a = TERM_YELLOW;
 
 				/* Display player/floors/walls */
@@ -326,7 +326,7 @@ static void prt_sp(int row, int col)
  */
 byte monster_health_attr(void)
 {
-	struct monster *mon = p_ptr->health_who;
+	struct monster *mon = health_tracked(p_ptr);
 	byte attr;
 
 	if (!mon) {
@@ -387,7 +387,7 @@ byte monster_health_attr(void)
 static void prt_health(int row, int col)
 {
 	byte attr = monster_health_attr();
-	struct monster *mon = p_ptr->health_who;
+	struct monster *mon = health_tracked(p_ptr);
 
 	/* Not tracking */
 	if (!mon)
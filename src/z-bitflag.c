@@ -18,6 +18,77 @@
 
 #include "z-bitflag.h"
 
+/*
+ * Most of the routines below work a machine word at a time rather than a
+ * byte at a time.  Words are loaded and stored with memcpy() so that the
+ * bitfields need no particular alignment, and a short final word is padded
+ * with zeroes; the flag sets are only a few words long, so there is little to
+ * be gained from anything wider.
+ */
+typedef unsigned long flag_word;
+
+#define FLAG_WORD_SIZE    sizeof(flag_word)
+
+/*
+ * Loads `n` bytes (at most one word) of a bitfield into a word
+ */
+static flag_word flag_load(const bitflag *flags, size_t n)
+{
+	flag_word w = 0;
+
+	if (n == FLAG_WORD_SIZE)
+		memcpy(&w, flags, FLAG_WORD_SIZE);
+	else
+		memcpy(&w, flags, n);
+
+	return w;
+}
+
+/*
+ * Stores `n` bytes (at most one word) of a word back into a bitfield
+ */
+static void flag_store(bitflag *flags, flag_word w, size_t n)
+{
+	if (n == FLAG_WORD_SIZE)
+		memcpy(flags, &w, FLAG_WORD_SIZE);
+	else
+		memcpy(flags, &w, n);
+}
+
+/*
+ * Returns the number of bytes in the word of a bitfield starting at `i`
+ */
+static size_t flag_chunk(const size_t size, size_t i)
+{
+	return (size - i < FLAG_WORD_SIZE ? size - i : FLAG_WORD_SIZE);
+}
+
+/*
+ * Counts the set bits in a word
+ */
+static int flag_word_count(flag_word w)
+{
+	w = w - ((w >> 1) & (~0UL / 3));
+	w = (w & (~0UL / 15 * 3)) + ((w >> 2) & (~0UL / 15 * 3));
+	w = (w + (w >> 4)) & (~0UL / 255 * 15);
+
+	return (int)((w * (~0UL / 255)) >> ((FLAG_WORD_SIZE - 1) * 8));
+}
+
+/*
+ * Returns the position of the lowest set bit in a non-zero byte
+ */
+static int flag_byte_lowest(bitflag b)
+{
+	int n = 0;
+
+	if (!(b & 0x0F)) { n += 4; b >>= 4; }
+	if (!(b & 0x03)) { n += 2; b >>= 2; }
+	if (!(b & 0x01)) n += 1;
+
+	return n;
+}
+
 
 /**
  * Tests if a flag is "on" in a bitflag set.
@@ -70,18 +141,67 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const
  */
 int flag_next(const bitflag *flags, const size_t size, const int flag)
 {
-	const int max_flags = FLAG_MAX(size);
-	int f, flag_offset, flag_binary;
+	const int start = (flag < FLAG_START) ? FLAG_START : flag;
+	size_t i = FLAG_OFFSET(start);
+	bitflag b;
+
+	if (start >= FLAG_MAX(size)) return FLAG_END;
 
-	for (f = flag; f < max_flags; f++)
+	/* Drop the flags before the start from its byte */
+	b = flags[i] & (bitflag)(~0U << ((start - FLAG_START) % FLAG_WIDTH));
+
+	/* Skip whole empty bytes, then whole empty words */
+	while (!b)
 	{
-		flag_offset = FLAG_OFFSET(f);
-		flag_binary = FLAG_BINARY(f);
+		if (++i >= size) return FLAG_END;
 
-		if (flags[flag_offset] & flag_binary) return f;
+		while ((i % FLAG_WORD_SIZE) == 0 && size - i >= FLAG_WORD_SIZE &&
+				!flag_load(flags + i, FLAG_WORD_SIZE))
+			i += FLAG_WORD_SIZE;
+
+		if (i >= size) return FLAG_END;
+		b = flags[i];
 	}
 
-	return FLAG_END;
+	/* Find the lowest set bit */
+	return FLAG_START + (int)(i * FLAG_WIDTH) + flag_byte_lowest(b);
+}
+
+
+/**
+ * Counts the flags which are "on" in a bitflag set.
+ *
+ * The number of set flags in `flags` is returned. The bitfield size is
+ * supplied in `size`.
+ */
+int flag_count(const bitflag *flags, const size_t size)
+{
+	size_t i;
+	int count = 0;
+
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+		count += flag_word_count(flag_load(flags + i, flag_chunk(size, i)));
+
+	return count;
+}
+
+
+/**
+ * Lists the flags which are "on" in a bitflag set.
+ *
+ * Every set flag in `flags` is written, in order, to `list`, which must have
+ * room for as many flags as are set. The number of flags written is returned.
+ * The bitfield size is supplied in `size`.
+ */
+int flag_list(const bitflag *flags, const size_t size, int *list)
+{
+	int f, n = 0;
+
+	for (f = flag_next(flags, size, FLAG_START); f != FLAG_END;
+			f = flag_next(flags, size, f + 1))
+		list[n++] = f;
+
+	return n;
 }
 
 
@@ -95,8 +215,8 @@ bool flag_is_empty(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
-		if (flags[i] > 0) return FALSE;
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+		if (flag_load(flags + i, flag_chunk(size, i))) return FALSE;
 
 	return TRUE;
 }
@@ -112,8 +232,14 @@ bool flag_is_full(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
-		if (flags[i] != (bitflag) -1) return FALSE;
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+	{
+		const size_t n = flag_chunk(size, i);
+		const flag_word w = ~flag_load(flags + i, n);
+
+		/* Ignore the padding of a short word */
+		if (flag_load((const bitflag *)&w, n)) return FALSE;
+	}
 
 	return TRUE;
 }
@@ -129,8 +255,12 @@ bool flag_is_inter(const bitflag *flags1, const bitflag *flags2, const size_t si
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
-		if (flags1[i] & flags2[i]) return TRUE;
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+	{
+		const size_t n = flag_chunk(size, i);
+
+		if (flag_load(flags1 + i, n) & flag_load(flags2 + i, n)) return TRUE;
+	}
 
 	return FALSE;
 }
@@ -146,8 +276,12 @@ bool flag_is_subset(const bitflag *flags1, const bitflag *flags2, const size_t s
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
-		if (~flags1[i] & flags2[i]) return FALSE;
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+	{
+		const size_t n = flag_chunk(size, i);
+
+		if (~flag_load(flags1 + i, n) & flag_load(flags2 + i, n)) return FALSE;
+	}
 
 	return TRUE;
 }
@@ -259,9 +393,13 @@ void flag_setall(bitflag *flags, const size_t size)
 void flag_negate(bitflag *flags, const size_t size)
 {
 	size_t i;
-	
-	for (i = 0; i < size; i++)
-		flags[i] = ~flags[i];
+
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
+	{
+		const size_t n = flag_chunk(size, i);
+
+		flag_store(flags + i, ~flag_load(flags + i, n), n);
+	}
 }
 
 
@@ -289,12 +427,18 @@ bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
 	{
-		/* !flag_is_subset() */
-		if (~flags1[i] & flags2[i]) delta = TRUE;
+		const size_t n = flag_chunk(size, i);
+		const flag_word w1 = flag_load(flags1 + i, n);
+		const flag_word w2 = flag_load(flags2 + i, n);
 
-		flags1[i] |= flags2[i];
+		/* !flag_is_subset() */
+		if (~w1 & w2)
+		{
+			delta = TRUE;
+			flag_store(flags1 + i, w1 | w2, n);
+		}
 	}
 
 	return delta;
@@ -313,12 +457,20 @@ bool flag_comp_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
 	{
-		/* no equivalent fn */
-		if (!(~flags1[i] & ~flags2[i])) delta = TRUE;
+		const size_t n = flag_chunk(size, i);
+		const flag_word w1 = flag_load(flags1 + i, n);
+		const flag_word w2 = flag_load(flags2 + i, n);
+
+		const flag_word w = w1 | ~w2;
 
-		flags1[i] |= ~flags2[i];
+		/* Ignore the padding of a short word */
+		if (flag_load((const bitflag *)&w, n) != w1)
+		{
+			delta = TRUE;
+			flag_store(flags1 + i, w, n);
+		}
 	}
 
 	return delta;
@@ -337,12 +489,18 @@ bool flag_inter(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
 	{
-		/* !flag_is_equal() */
-		if (!(flags1[i] == flags2[i])) delta = TRUE;
+		const size_t n = flag_chunk(size, i);
+		const flag_word w1 = flag_load(flags1 + i, n);
+		const flag_word w2 = flag_load(flags2 + i, n);
 
-		flags1[i] &= flags2[i];
+		/* !flag_is_subset() */
+		if (w1 & ~w2)
+		{
+			delta = TRUE;
+			flag_store(flags1 + i, w1 & w2, n);
+		}
 	}
 
 	return delta;
@@ -362,12 +520,18 @@ bool flag_diff(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i < size; i += FLAG_WORD_SIZE)
 	{
-		/* flag_is_inter() */
-		if (flags1[i] & flags2[i]) delta = TRUE;
+		const size_t n = flag_chunk(size, i);
+		const flag_word w1 = flag_load(flags1 + i, n);
+		const flag_word w2 = flag_load(flags2 + i, n);
 
-		flags1[i] &= ~flags2[i];
+		/* flag_is_inter() */
+		if (w1 & w2)
+		{
+			delta = TRUE;
+			flag_store(flags1 + i, w1 & ~w2, n);
+		}
 	}
 
 	return delta;
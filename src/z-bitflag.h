@@ -52,6 +52,8 @@ typedef byte bitflag;
 bool flag_has       (const bitflag *flags, const size_t size, const int flag);
 bool flag_has_dbg   (const bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl);
 int  flag_next      (const bitflag *flags, const size_t size, const int flag);
+int  flag_count     (const bitflag *flags, const size_t size);
+int  flag_list      (const bitflag *flags, const size_t size, int *list);
 bool flag_is_empty  (const bitflag *flags, const size_t size);
 bool flag_is_full   (const bitflag *flags, const size_t size);
 bool flag_is_inter  (const bitflag *flags1, const bitflag *flags2, const size_t size);
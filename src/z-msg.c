@@ -18,11 +18,16 @@
 #include "z-term.h"
 #include "z-msg.h"
 
+/*
+ * Messages are kept in a ring of fixed-size records, oldest first, and
+ * their text in a ring of bytes, also oldest first.  Each new message's
+ * text goes after the newest one's, or back at the start of the text ring
+ * if it would not fit before the end.  Whatever old messages are in the way
+ * are dropped, so a long run of long messages keeps fewer of them.
+ */
 typedef struct _message_t
 {
-	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	u32b text;
 	u16b type;
 	u16b count;
 } message_t;
@@ -36,11 +41,16 @@ typedef struct _msgcolor_t
 
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
-	msgcolor_t *colors;
+	message_t *ring;
+	u32b oldest;
 	u32b count;
 	u32b max;
+
+	char *text;
+	u32b text_head;
+	u32b text_size;
+
+	msgcolor_t *colors;
 } msgqueue_t;
 
 static msgqueue_t *messages = NULL;
@@ -50,6 +60,9 @@ errr messages_init(void)
 {
 	messages = ZNEW(msgqueue_t);
 	messages->max = 2048;
+	messages->ring = C_ZNEW(messages->max, message_t);
+	messages->text_size = messages->max * 64;
+	messages->text = C_ZNEW(messages->text_size, char);
 	return 0;
 }
 
@@ -57,16 +70,6 @@ void messages_free(void)
 {
 	msgcolor_t *c = messages->colors;
 	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m)
-	{
-		nextm = m->older;
-		FREE(m->str);
-		FREE(m);
-		m = nextm;
-	}
 
 	while (c)
 	{
@@ -75,6 +78,8 @@ void messages_free(void)
 		c = nextc;
 	}
 
+	FREE(messages->ring);
+	FREE(messages->text);
 	FREE(messages);
 }
 
@@ -85,60 +90,86 @@ u16b messages_num(void)
 
 /* Functions for individual messages */
 
-void message_add(const char *str, u16b type)
+static message_t *message_get(u16b age)
 {
-	message_t *m;
-
-	if (messages->head &&
-	    messages->head->type == type &&
-	    !strcmp(messages->head->str, str))
-	{
-		messages->head->count++;
-		return;
-	}
+	if (age >= messages->count) return NULL;
 
-	m = ZNEW(message_t);
-	m->str = string_make(str);
-	m->type = type;
-	m->count = 1;
-	m->older = messages->head;
+	return &messages->ring[(messages->oldest + messages->count - 1 - age) %
+			messages->max];
+}
 
-	if (messages->head)
-		messages->head->newer = m;
+/*
+ * Forget the oldest message
+ */
+static void message_drop(void)
+{
+	messages->oldest = (messages->oldest + 1) % messages->max;
+	messages->count--;
+}
 
-	messages->head = m;
-	messages->count++;
+/*
+ * Find room for "len" bytes of text, dropping the oldest messages whose
+ * text is in the way.
+ */
+static u32b message_text_alloc(u32b len)
+{
+	u32b size = messages->text_size;
+	u32b pos = messages->text_head;
+	u32b span = len;
 
-	if (!messages->tail)
-		messages->tail = m;
+	/* Go back to the start, skipping the end of the ring */
+	if (pos + len > size)
+	{
+		span += size - pos;
+		pos = 0;
+	}
 
-	if (messages->count > messages->max)
+	/* Drop messages starting between the old head and the end of the new text */
+	while (messages->count)
 	{
-		message_t *old_tail = messages->tail;
+		u32b start = messages->ring[messages->oldest].text;
 
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		FREE(old_tail->str);
-		FREE(old_tail);
-		messages->count--;
+		if ((start + size - messages->text_head) % size >= span) break;
+		message_drop();
 	}
+
+	messages->text_head = pos + len;
+	return pos;
 }
 
-static message_t *message_get(u16b age)
+void message_add(const char *str, u16b type)
 {
-	message_t *m = messages->head;
+	message_t *m = message_get(0);
+	u32b len = strlen(str) + 1;
+
+	if (m && m->type == type && !strcmp(messages->text + m->text, str))
+	{
+		m->count++;
+		return;
+	}
 
-	while (m && age--)
-		m = m->older;
+	/* Hack -- keep the text of any message within reason */
+	if (len > messages->text_size / 4)
+		len = messages->text_size / 4;
+
+	if (messages->count == messages->max)
+		message_drop();
+
+	m = &messages->ring[(messages->oldest + messages->count) % messages->max];
+	m->text = message_text_alloc(len);
+	m->type = type;
+	m->count = 1;
+	messages->count++;
 
-	return m;
+	memcpy(messages->text + m->text, str, len - 1);
+	messages->text[m->text + len - 1] = '\0';
 }
 
 
 const char *message_str(u16b age)
 {
 	message_t *m = message_get(age);
-	return (m ? m->str : "");
+	return (m ? messages->text + m->text : "");
 }
 
 u16b message_count(u16b age)
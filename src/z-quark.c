@@ -20,30 +20,137 @@
 #include "z-virt.h"
 #include "z-quark.h"
 
-static char **quarks;
+/*
+ * The strings themselves are packed one after another into large blocks,
+ * which are only freed all together by quarks_free().  Quarks are found by
+ * an open-addressed hash table of quark numbers, which is kept at most half
+ * full so that a lookup only compares a string or two.
+ */
+struct quark_block {
+	struct quark_block *next;
+	size_t size;
+	size_t used;
+};
+
+static const char **quarks;
+static u32b *quark_hashes;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+static quark_t *quark_index;
+static size_t index_size = 0;
+
+static struct quark_block *blocks;
+static size_t block_bytes = 0;
+static size_t string_bytes = 0;
+
 #define QUARKS_INIT	16
+#define QUARK_INDEX_INIT	32
+#define QUARK_BLOCK_SIZE	4096
 
-quark_t quark_add(const char *str)
+/*
+ * FNV-1a hash of a string
+ */
+static u32b quark_hash(const char *str)
+{
+	u32b h = 2166136261U;
+
+	while (*str)
+	{
+		h ^= (byte)*str++;
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+/*
+ * Copy a string into the current block, starting a new block if it is full
+ */
+static const char *quark_store(const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *copy;
+
+	if (!blocks || blocks->size - blocks->used < len)
+	{
+		size_t size = MAX(QUARK_BLOCK_SIZE, len);
+		struct quark_block *b = mem_alloc(sizeof(*b) + size);
+
+		b->next = blocks;
+		b->size = size;
+		b->used = 0;
+		blocks = b;
+		block_bytes += size;
+	}
+
+	copy = (char *)(blocks + 1) + blocks->used;
+	memcpy(copy, str, len);
+	blocks->used += len;
+	string_bytes += len;
+
+	return copy;
+}
+
+/*
+ * Put a quark into the first free slot of its chain
+ */
+static void quark_index_insert(quark_t q)
+{
+	size_t i = quark_hashes[q] & (index_size - 1);
+
+	while (quark_index[i])
+		i = (i + 1) & (index_size - 1);
+
+	quark_index[i] = q;
+}
+
+/*
+ * Double the hash table, and put every quark back in
+ */
+static void quark_index_grow(void)
 {
 	quark_t q;
 
+	FREE(quark_index);
+	index_size *= 2;
+	quark_index = C_ZNEW(index_size, quark_t);
+
 	for (q = 1; q < nr_quarks; q++)
+		quark_index_insert(q);
+}
+
+quark_t quark_add(const char *str)
+{
+	u32b h = quark_hash(str);
+	size_t i = h & (index_size - 1);
+	quark_t q;
+
+	/* Look for the string along its chain */
+	while ((q = quark_index[i]) != 0)
 	{
-		if (!strcmp(quarks[q], str))
+		if (quark_hashes[q] == h && !strcmp(quarks[q], str))
 			return q;
+
+		i = (i + 1) & (index_size - 1);
 	}
 
 	if (nr_quarks == alloc_quarks)
 	{
 		alloc_quarks *= 2;
 		quarks = mem_realloc(quarks, alloc_quarks * sizeof(char *));
+		quark_hashes = mem_realloc(quark_hashes, alloc_quarks * sizeof(u32b));
 	}
 
 	q = nr_quarks++;
-	quarks[q] = string_make(str);
+	quarks[q] = quark_store(str);
+	quark_hashes[q] = h;
+
+	/* Keep the table at most half full */
+	if (2 * nr_quarks > index_size)
+		quark_index_grow();
+	else
+		quark_index[i] = q;
 
 	return q;
 }
@@ -53,21 +160,46 @@ const char *quark_str(quark_t q)
 	return (q >= nr_quarks ? NULL : quarks[q]);
 }
 
+void quarks_stats(struct quark_stats *stats)
+{
+	stats->count = nr_quarks - 1;
+	stats->string_bytes = string_bytes;
+	stats->block_bytes = block_bytes;
+	stats->index_size = index_size;
+	stats->load = index_size ? (double)(nr_quarks - 1) / index_size : 0.0;
+}
+
 errr quarks_init(void)
 {
 	alloc_quarks = QUARKS_INIT;
-	quarks = C_ZNEW(alloc_quarks, char *);
+	quarks = C_ZNEW(alloc_quarks, const char *);
+	quark_hashes = C_ZNEW(alloc_quarks, u32b);
+
+	index_size = QUARK_INDEX_INIT;
+	quark_index = C_ZNEW(index_size, quark_t);
 
 	return 0;
 }
 
 errr quarks_free(void)
 {
-	size_t i;
+	while (blocks)
+	{
+		struct quark_block *next = blocks->next;
 
-	for (i = 0; i < nr_quarks; i++)
-		string_free(quarks[i]);
+		mem_free(blocks);
+		blocks = next;
+	}
 
 	FREE(quarks);
+	FREE(quark_hashes);
+	FREE(quark_index);
+
+	nr_quarks = 1;
+	alloc_quarks = 0;
+	index_size = 0;
+	block_bytes = 0;
+	string_bytes = 0;
+
 	return 0;
 }
@@ -6,6 +6,15 @@
 /* Quark type */
 typedef size_t quark_t;
 
+/* Memory used by the quarks package */
+struct quark_stats {
+	size_t count;			/* Number of quarks */
+	size_t string_bytes;	/* Bytes of string data, including terminators */
+	size_t block_bytes;		/* Bytes allocated for string data */
+	size_t index_size;		/* Slots in the hash index */
+	double load;			/* Fraction of the hash index in use */
+};
+
 
 /* Return a quark for the string 'str' */
 quark_t quark_add(const char *str);
@@ -13,6 +22,9 @@ quark_t quark_add(const char *str);
 /* Return the string corresponding to the quark */
 const char *quark_str(quark_t q);
 
+/* Describe the memory used by the quarks package */
+void quarks_stats(struct quark_stats *stats);
+
 /* Initialise the quarks package */
 errr quarks_init(void);
 
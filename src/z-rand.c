@@ -122,6 +122,42 @@ void Rand_state_init(u32b seed) {
 }
 
 
+void Rand_state_save(struct rand_state *s) {
+	s->quick = Rand_quick;
+	s->value = Rand_value;
+	s->state_i = state_i;
+	memcpy(s->state, STATE, sizeof(STATE));
+	s->z0 = z0;
+	s->z1 = z1;
+	s->z2 = z2;
+}
+
+void Rand_state_load(const struct rand_state *s) {
+	Rand_quick = s->quick;
+	Rand_value = s->value;
+	state_i = s->state_i;
+	memcpy(STATE, s->state, sizeof(STATE));
+	z0 = s->z0;
+	z1 = s->z1;
+	z2 = s->z2;
+}
+
+/**
+ * Start a stream of the complex RNG from a seed, without disturbing the
+ * stream in use.  Unlike Rand_state_init(), the result depends only on the
+ * seed.
+ */
+void Rand_state_seed(struct rand_state *s, u32b seed) {
+	struct rand_state current;
+
+	Rand_state_save(&current);
+	state_i = 0;
+	Rand_state_init(seed);
+	Rand_quick = FALSE;
+	Rand_state_save(s);
+	Rand_state_load(&current);
+}
+
 /**
  * Extract a "random" number from 0 to m - 1, via division.
  *
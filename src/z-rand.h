@@ -85,6 +85,30 @@ extern u32b z2;
  */
 void Rand_state_init(u32b seed);
 
+/**
+ * The whole state of the RNG, so that separate streams of random numbers
+ * can be swapped in and out.
+ */
+struct rand_state {
+	bool quick;
+	u32b value;
+	u32b state_i;
+	u32b state[RAND_DEG];
+	u32b z0, z1, z2;
+};
+
+/**
+ * Save the state of the RNG, or restore a saved state.
+ */
+void Rand_state_save(struct rand_state *s);
+void Rand_state_load(const struct rand_state *s);
+
+/**
+ * Set up a state for a new stream from the given seed, leaving the RNG as
+ * it was.
+ */
+void Rand_state_seed(struct rand_state *s, u32b seed);
+
 /**
  * Generates a random unsigned long integer X where "0 <= X < M" holds.
  *
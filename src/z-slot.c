@@ -0,0 +1,120 @@
+/*
+ * File: z-slot.c
+ * Purpose: Free lists of array slots, with generation-tagged handles
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "z-virt.h"
+#include "z-slot.h"
+
+/*
+ * The free slots are chained through next[], most recently given back
+ * first.  A slot on the list has its own bit set in free[], so that giving
+ * back a slot twice can be caught.
+ */
+struct slot_list {
+	int size;
+	int head;
+	int count;
+	s16b *next;
+	u16b *gen;
+	byte *free;
+};
+
+struct slot_list *slots_new(int size)
+{
+	struct slot_list *s = mem_zalloc(sizeof(*s));
+
+	s->size = size;
+	s->next = C_ZNEW(size, s16b);
+	s->gen = C_ZNEW(size, u16b);
+	s->free = C_ZNEW(size, byte);
+
+	return s;
+}
+
+void slots_free(struct slot_list *s)
+{
+	if (!s) return;
+
+	FREE(s->next);
+	FREE(s->gen);
+	FREE(s->free);
+	mem_free(s);
+}
+
+void slots_reset(struct slot_list *s)
+{
+	while (s->head)
+	{
+		int i = s->head;
+
+		s->head = s->next[i];
+		s->free[i] = 0;
+	}
+
+	s->count = 0;
+}
+
+int slots_take(struct slot_list *s)
+{
+	int i = s->head;
+
+	if (!i) return 0;
+
+	s->head = s->next[i];
+	s->free[i] = 0;
+	s->count--;
+
+	return i;
+}
+
+void slots_give(struct slot_list *s, int i)
+{
+	assert(i > 0 && i < s->size);
+	assert(!s->free[i]);
+
+	s->gen[i]++;
+	s->next[i] = s->head;
+	s->free[i] = 1;
+	s->head = i;
+	s->count++;
+}
+
+void slots_retire(struct slot_list *s, int i)
+{
+	assert(i > 0 && i < s->size);
+
+	s->gen[i]++;
+}
+
+int slots_count(const struct slot_list *s)
+{
+	return s->count;
+}
+
+slot_handle slots_handle(const struct slot_list *s, int i)
+{
+	assert(i > 0 && i < s->size);
+
+	return ((u32b)s->gen[i] << 16) | (u32b)i;
+}
+
+int slots_lookup(const struct slot_list *s, slot_handle h)
+{
+	int i = h & 0xFFFF;
+
+	if (i <= 0 || i >= s->size) return 0;
+	if (s->free[i] || s->gen[i] != (h >> 16)) return 0;
+
+	return i;
+}
@@ -0,0 +1,49 @@
+#ifndef INCLUDED_Z_SLOT_H
+#define INCLUDED_Z_SLOT_H
+
+#include "h-basic.h"
+
+/*
+ * A free list over the slots of some array, so that slots given back can
+ * be handed out again at once, without looking for them.  Slot 0 is never
+ * handed out.  The slots above the array's high water mark are the
+ * caller's to hand out; only slots given back are kept here.
+ *
+ * Each slot also has a generation, which changes whenever the slot is
+ * given back.  A handle records a slot together with its generation, so
+ * a handle taken while a slot was in use no longer matches once the slot
+ * has been given back, even if it has since been reused.
+ */
+struct slot_list;
+
+/* A slot and its generation; 0 is never a valid handle */
+typedef u32b slot_handle;
+
+/* Make a free list for the slots 1 .. size - 1 */
+struct slot_list *slots_new(int size);
+
+/* Free a free list */
+void slots_free(struct slot_list *s);
+
+/* Forget every free slot, as when the array is emptied or compacted */
+void slots_reset(struct slot_list *s);
+
+/* Take the slot given back most recently, or 0 if there is none */
+int slots_take(struct slot_list *s);
+
+/* Give back a slot, so it can be taken again */
+void slots_give(struct slot_list *s, int i);
+
+/* Make any handles to a slot stale, as when its entry moves elsewhere */
+void slots_retire(struct slot_list *s, int i);
+
+/* The number of slots waiting to be taken */
+int slots_count(const struct slot_list *s);
+
+/* A handle for the entry in slot i */
+slot_handle slots_handle(const struct slot_list *s, int i);
+
+/* The slot a handle refers to, or 0 if the handle is stale */
+int slots_lookup(const struct slot_list *s, slot_handle h);
+
+#endif /* !INCLUDED_Z_SLOT_H */